@@ -0,0 +1,735 @@
+#include <gst/gst.h>
+#include <cairo.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Bench.h"
+#include "YuvConvert.h"
+#include "FrameCheck.h"
+#include "StreamSlot.h"
+#include "TestSender.h"
+#include "FileSource.h"
+#include "ProcStats.h"
+#include "DecoderScheduler.h"
+
+namespace Bench {
+
+// ===== convert: YuvConvert vs videoconvert + escalado de cairo =====
+
+static const int kSrcW = 1920, kSrcH = 1080;
+static const int kDstW = 640, kDstH = 540;
+
+// Milisegundos por frame de un pipeline "videotestsrc ! ... ! fakesink"
+static double pipeline_ms_per_frame(const std::string &desc, int frames) {
+    GError *error = nullptr;
+    GstElement *pipeline = gst_parse_launch(desc.c_str(), &error);
+    if (!pipeline) {
+        g_printerr("[Bench] Error creando pipeline: %s\n", error ? error->message : "?");
+        if (error) g_error_free(error);
+        return -1.0;
+    }
+
+    gint64 start = g_get_monotonic_time();
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus *bus = gst_element_get_bus(pipeline);
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+                                                 (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    gint64 elapsed = g_get_monotonic_time() - start;
+    bool ok = msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+
+    if (msg) gst_message_unref(msg);
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return ok ? elapsed / 1000.0 / frames : -1.0;
+}
+
+static int bench_convert(int frames) {
+    // Frame I420 sintético con gradientes (todas las ramas de saturación)
+    std::vector<uint8_t> y(kSrcW * kSrcH), u(kSrcW / 2 * kSrcH / 2), v(u.size());
+    for (int row = 0; row < kSrcH; ++row)
+        for (int x = 0; x < kSrcW; ++x) y[row * kSrcW + x] = (uint8_t)(x + row);
+    for (int row = 0; row < kSrcH / 2; ++row)
+        for (int x = 0; x < kSrcW / 2; ++x) {
+            u[row * kSrcW / 2 + x] = (uint8_t)(x * 3);
+            v[row * kSrcW / 2 + x] = (uint8_t)(row * 5);
+        }
+
+    YuvConvert::SourceFrame src;
+    src.format = YuvConvert::Format::I420;
+    src.width = kSrcW;
+    src.height = kSrcH;
+    src.y = y.data(); src.y_stride = kSrcW;
+    src.u = u.data(); src.u_stride = kSrcW / 2;
+    src.v = v.data(); src.v_stride = kSrcW / 2;
+
+    std::vector<uint8_t> dst((size_t)kDstW * 4 * kDstH);
+
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < frames; ++i)
+        YuvConvert::convert_scale_scalar(src, dst.data(), kDstW * 4, kDstW, kDstH);
+    double scalar_ms = (g_get_monotonic_time() - start) / 1000.0 / frames;
+
+    start = g_get_monotonic_time();
+    for (int i = 0; i < frames; ++i)
+        YuvConvert::convert_scale(src, dst.data(), kDstW * 4, kDstW, kDstH);
+    double simd_ms = (g_get_monotonic_time() - start) / 1000.0 / frames;
+
+    // Camino anterior: videoconvert a BGRx a resolución completa...
+    std::string caps = "video/x-raw,format=I420,width=" + std::to_string(kSrcW) +
+                       ",height=" + std::to_string(kSrcH) + ",framerate=0/1";
+    std::string source = "videotestsrc num-buffers=" + std::to_string(frames) + " pattern=ball ! " + caps;
+    double base_ms = pipeline_ms_per_frame(source + " ! fakesink sync=false", frames);
+    double convert_ms = pipeline_ms_per_frame(
+        source + " ! videoconvert ! video/x-raw,format=BGRx ! fakesink sync=false", frames);
+    double videoconvert_ms = (base_ms >= 0 && convert_ms >= 0) ? convert_ms - base_ms : -1.0;
+
+    // ...y el escalado que hace gtksink al dibujar en el tile
+    cairo_surface_t *frame = cairo_image_surface_create(CAIRO_FORMAT_RGB24, kSrcW, kSrcH);
+    cairo_surface_t *tile = cairo_image_surface_create(CAIRO_FORMAT_RGB24, kDstW, kDstH);
+    cairo_t *cr = cairo_create(tile);
+    cairo_scale(cr, (double)kDstW / kSrcW, (double)kDstH / kSrcH);
+    start = g_get_monotonic_time();
+    for (int i = 0; i < frames; ++i) {
+        cairo_surface_mark_dirty(frame);
+        cairo_set_source_surface(cr, frame, 0, 0);
+        cairo_paint(cr);
+        cairo_surface_flush(tile);
+    }
+    double cairo_ms = (g_get_monotonic_time() - start) / 1000.0 / frames;
+    cairo_destroy(cr);
+    cairo_surface_destroy(tile);
+    cairo_surface_destroy(frame);
+
+    g_print("[Bench] convert %dx%d I420 -> %dx%d BGRx, %d frames\n", kSrcW, kSrcH, kDstW, kDstH, frames);
+    g_print("[Bench]   YuvConvert escalar:        %7.3f ms/frame\n", scalar_ms);
+    g_print("[Bench]   YuvConvert %-6s:         %7.3f ms/frame\n", YuvConvert::active_kernel(), simd_ms);
+    if (videoconvert_ms >= 0)
+        g_print("[Bench]   videoconvert + cairo:      %7.3f ms/frame (%.3f + %.3f)\n",
+                videoconvert_ms + cairo_ms, videoconvert_ms, cairo_ms);
+    else
+        g_print("[Bench]   videoconvert: no disponible; escalado cairo %.3f ms/frame\n", cairo_ms);
+    return 0;
+}
+
+// ===== freeze: costo del análisis de contenido del watchdog =====
+
+// Luma 1080p con textura y ruido (lo que ve el watchdog en una escena normal)
+static void fill_scene(std::vector<uint8_t> &y, guint32 seed) {
+    for (int row = 0; row < kSrcH; ++row)
+        for (int x = 0; x < kSrcW; ++x) {
+            seed = seed * 1664525u + 1013904223u;
+            y[(size_t)row * kSrcW + x] = (uint8_t)(16 + ((x / 3 + row / 2) & 0x7F) + (seed >> 28));
+        }
+}
+
+static const char* classify(const FrameCheck::LumaStats &stats, const FrameCheck::LumaStats &previous) {
+    if (FrameCheck::is_black(stats)) return "negro";
+    if (FrameCheck::is_flat(stats)) return "color fijo";
+    if (FrameCheck::same_picture(stats, previous)) return "repetido";
+    return "normal";
+}
+
+static int bench_freeze(int frames) {
+    std::vector<uint8_t> y((size_t)kSrcW * kSrcH);
+    fill_scene(y, 1);
+
+    FrameCheck::LumaStats scalar, simd;
+    gint64 start = g_get_monotonic_time();
+    for (int i = 0; i < frames; ++i) FrameCheck::analyze_scalar(y.data(), kSrcW, kSrcW, kSrcH, &scalar);
+    double scalar_us = (double)(g_get_monotonic_time() - start) / frames;
+
+    start = g_get_monotonic_time();
+    for (int i = 0; i < frames; ++i) FrameCheck::analyze(y.data(), kSrcW, kSrcW, kSrcH, &simd);
+    double simd_us = (double)(g_get_monotonic_time() - start) / frames;
+
+    bool same = scalar.mean == simd.mean && scalar.variance == simd.variance &&
+                FrameCheck::same_picture(scalar, simd);
+
+    // Costo por stream: una muestra por intervalo; el peor caso sería analizar todo a 30 fps
+    const char *env = g_getenv("MOSAIC_CONTENT_INTERVAL_MS");
+    int interval_ms = (env && atoi(env) > 0) ? atoi(env) : 1000;
+    g_print("[Bench] freeze %dx%d luma (grilla %dx%d, 1 fila de cada %d), %d frames\n",
+            kSrcW, kSrcH, FrameCheck::kGrid, FrameCheck::kGrid, FrameCheck::kRowStep, frames);
+    g_print("[Bench]   escalar: %8.1f us/frame\n", scalar_us);
+    g_print("[Bench]   %-6s:  %8.1f us/frame (%.1fx)%s\n", FrameCheck::active_kernel(), simd_us,
+            simd_us > 0 ? scalar_us / simd_us : 0.0, same ? "" : "  RESULTADO DISTINTO AL ESCALAR");
+    g_print("[Bench]   CPU por stream: %.4f%% (1 frame cada %d ms); %.3f%% si se analizara cada frame a 30 fps\n",
+            100.0 * simd_us / (interval_ms * 1000.0), interval_ms, 100.0 * simd_us * 30 / 1e6);
+
+    // Clasificación de un frame contra el anterior
+    FrameCheck::LumaStats previous, stats;
+    FrameCheck::analyze(y.data(), kSrcW, kSrcW, kSrcH, &previous);
+    struct Case { const char *name; const char *expected; };
+    const Case cases[] = {
+        {"negro", "negro"}, {"gris con ruido", "color fijo"}, {"repetido", "repetido"}, {"escena nueva", "normal"},
+    };
+    bool ok = same;
+    for (int c = 0; c < 4; ++c) {
+        guint32 seed = 7;
+        switch (c) {
+            case 0: std::fill(y.begin(), y.end(), 16); break;
+            case 1:
+                for (uint8_t &px : y) { seed = seed * 1664525u + 1013904223u; px = (uint8_t)(127 + (seed >> 30)); }
+                break;
+            case 2: fill_scene(y, 1); FrameCheck::analyze(y.data(), kSrcW, kSrcW, kSrcH, &previous); break;
+            case 3: fill_scene(y, 2); break;
+        }
+        FrameCheck::analyze(y.data(), kSrcW, kSrcW, kSrcH, &stats);
+        const char *got = classify(stats, previous);
+        bool match = strcmp(got, cases[c].expected) == 0;
+        ok = ok && match;
+        g_print("[Bench]   %-15s media %6.1f  varianza %8.1f  -> %s%s\n", cases[c].name, stats.mean, stats.variance,
+                got, match ? "" : "  (esperado distinto)");
+    }
+    return ok ? 0 : 1;
+}
+
+// ===== latency: captura -> sink por modo, en loopback =====
+
+// Corre el main loop durante ms milisegundos (bus watches, watchdogs)
+static void run_main_loop(guint ms) {
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    g_timeout_add(ms, [](gpointer data) -> gboolean {
+        g_main_loop_quit(static_cast<GMainLoop *>(data));
+        return G_SOURCE_REMOVE;
+    }, loop);
+    g_main_loop_run(loop);
+    g_main_loop_unref(loop);
+}
+
+struct LatencyRun {
+    gint64 warmup_until_us = 0;
+    std::vector<double> samples_ms;   // solo lo escribe el hilo del sink
+    guint64 unstamped = 0;
+};
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static void measure_latency(StreamMode mode, int seconds) {
+    const int port = (mode == StreamMode::SRT_MOSAIC) ? 7001 : 5600;
+
+    TestSender::Options options;
+    options.pattern = "black";
+    options.stamp = true;
+    GstElement *sender = TestSender::start(mode, port, options);
+    if (!sender) return;
+
+    LatencyRun run;
+    run.warmup_until_us = g_get_monotonic_time() + 2 * G_USEC_PER_SEC;
+
+    auto slot = std::make_unique<StreamSlot>();
+    slot->set_headless([&run](GstBuffer *buffer, GstCaps *caps) {
+        guint32 stamp;
+        if (!TestSender::read_stamp(buffer, caps, &stamp)) {
+            run.unstamped++;
+            return;
+        }
+        gint64 now = g_get_monotonic_time();
+        if (now < run.warmup_until_us) return;
+        // Resta en 32 bits: válida aunque el contador dé la vuelta
+        run.samples_ms.push_back((guint32)((guint32)now - stamp) / 1000.0);
+    });
+
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC:
+            PipelineDesc::set_srt_server("127.0.0.1:" + std::to_string(port));
+            slot->init_with_streamid("latency");
+            break;
+        case StreamMode::UDP_SAFE:
+            slot->init_with_udp_port_safe(std::to_string(port));
+            break;
+        case StreamMode::UDP_FAST:
+            slot->init_with_udp_port_fast(std::to_string(port));
+            break;
+    }
+
+    run_main_loop((guint)(seconds + 2) * 1000);
+
+    // El destructor detiene el pipeline: desde aquí nadie escribe en run
+    slot.reset();
+    TestSender::stop(sender);
+
+    std::vector<double> &s = run.samples_ms;
+    std::sort(s.begin(), s.end());
+    if (s.empty()) {
+        g_print("[Bench] latency %-11s sin frames medidos (sin marca: %" G_GUINT64_FORMAT ")\n",
+                PipelineDesc::mode_name(mode), run.unstamped);
+        return;
+    }
+    g_print("[Bench] latency %-11s n=%5zu  p50 %6.1f  p90 %6.1f  p99 %6.1f  max %6.1f ms  (sin marca: %" G_GUINT64_FORMAT ")\n",
+            PipelineDesc::mode_name(mode), s.size(),
+            percentile(s, 50), percentile(s, 90), percentile(s, 99), s.back(), run.unstamped);
+}
+
+static int bench_latency(int seconds, const std::vector<StreamMode> &modes) {
+    g_print("[Bench] latency: captura -> sink en loopback, %d s por modo (640x360@30, x264 zerolatency)\n", seconds);
+    for (StreamMode mode : modes) measure_latency(mode, seconds);
+    return 0;
+}
+
+// ===== scale: N slots headless contra un emisor local =====
+
+static void measure_scale(StreamMode mode, int n, int seconds) {
+    const int port = (mode == StreamMode::SRT_MOSAIC) ? 7001 : 5600;
+
+    // Un solo encoder para todos los receptores: su costo se mide aparte y se descuenta
+    TestSender::Options options;
+    options.width = 1280;
+    options.height = 720;
+    options.bitrate_kbps = 4000;
+    GstElement *sender = TestSender::start(mode, port, options, n);
+    if (!sender) return;
+
+    run_main_loop(1000);
+    gint64 cpu0 = ProcStats::cpu_time_us(), wall0 = g_get_monotonic_time();
+    run_main_loop(2000);
+    double sender_pct = 100.0 * (ProcStats::cpu_time_us() - cpu0) / (double)(g_get_monotonic_time() - wall0);
+    guint64 rss_before = ProcStats::rss_bytes();
+
+    DecoderScheduler::instance().set_active_slots(n);
+    if (mode == StreamMode::SRT_MOSAIC)
+        PipelineDesc::set_srt_server("127.0.0.1:" + std::to_string(port));
+
+    std::unique_ptr<std::atomic<guint64>[]> rendered(new std::atomic<guint64>[n]);
+    std::vector<std::unique_ptr<StreamSlot>> slots;
+    for (int i = 0; i < n; ++i) {
+        rendered[i] = 0;
+        std::atomic<guint64> *counter = &rendered[i];
+
+        auto slot = std::make_unique<StreamSlot>();
+        slot->init(i);
+        slot->set_headless([counter](GstBuffer *, GstCaps *) { counter->fetch_add(1, std::memory_order_relaxed); });
+        switch (mode) {
+            case StreamMode::SRT_MOSAIC: slot->init_with_streamid("bench" + std::to_string(i)); break;
+            case StreamMode::UDP_SAFE:   slot->init_with_udp_port_safe(std::to_string(port + i)); break;
+            case StreamMode::UDP_FAST:   slot->init_with_udp_port_fast(std::to_string(port + i)); break;
+        }
+        slots.push_back(std::move(slot));
+    }
+
+    // Arranque y primer keyframe fuera de la medición
+    run_main_loop(3000);
+
+    std::vector<guint64> rendered_start(n), lost_start(n), dropped_start(n);
+    for (int i = 0; i < n; ++i) {
+        SlotMetrics::Snapshot m = slots[i]->sample_metrics();
+        rendered_start[i] = rendered[i].load();
+        lost_start[i] = m.rtp_lost;
+        dropped_start[i] = m.sink_dropped;
+    }
+    gint64 cpu1 = ProcStats::cpu_time_us(), wall1 = g_get_monotonic_time();
+
+    run_main_loop((guint)seconds * 1000);
+
+    gint64 cpu2 = ProcStats::cpu_time_us(), wall2 = g_get_monotonic_time();
+    guint64 frames = 0, lost = 0, dropped = 0;
+    int stalled = 0;
+    for (int i = 0; i < n; ++i) {
+        SlotMetrics::Snapshot m = slots[i]->sample_metrics();
+        guint64 f = rendered[i].load() - rendered_start[i];
+        if (f == 0) stalled++;
+        frames += f;
+        lost += m.rtp_lost - lost_start[i];
+        dropped += m.sink_dropped - dropped_start[i];
+    }
+    guint64 rss = ProcStats::rss_bytes();
+    int threads = ProcStats::thread_count();
+
+    slots.clear();
+    TestSender::stop(sender);
+
+    double elapsed = (wall2 - wall1) / 1e6;
+    double cpu_pct = 100.0 * (cpu2 - cpu1) / (double)(wall2 - wall1);
+    double fps = frames / elapsed / n;
+    double expected = (double)options.fps * elapsed * n;
+    double drop_pct = expected > 0 ? std::max(0.0, 100.0 * (1.0 - frames / expected)) : 0.0;
+
+    g_print("[Bench] %3d  %8.1f  %7.1f  %6.1f  %6.2f  %8" G_GUINT64_FORMAT "  %7" G_GUINT64_FORMAT "  %7.1f  %6.1f  %4d  %3d\n",
+            n, std::max(0.0, cpu_pct - sender_pct) / n, cpu_pct, fps, drop_pct, lost, dropped,
+            rss / 1048576.0, (rss > rss_before ? rss - rss_before : 0) / 1048576.0 / n,
+            threads, stalled);
+}
+
+static int bench_scale(int max_n, StreamMode mode, int seconds) {
+    g_print("[Bench] scale: %s, 1280x720@30 H.264, %d s por paso, %d núcleos\n",
+            PipelineDesc::mode_name(mode), seconds, ProcStats::cpu_count());
+    g_print("[Bench]   N  %%CPU/str  %%CPU tot    fps  drop%%   rtp perd  sink drop  RSS MB  MB/str  hilos  sin frames\n");
+
+    for (int n = 1; n <= max_n; n = (n * 2 > max_n && n < max_n) ? max_n : n * 2)
+        measure_scale(mode, n, seconds);
+    return 0;
+}
+
+// ===== file: N slots headless sobre el mismo archivo grabado =====
+
+static int bench_file(const std::string &path, int n, bool realtime, int seconds) {
+    if (FileSource::probe(path) == FileSource::Format::UNKNOWN) {
+        g_printerr("[Bench] %s: archivo ilegible o de formato desconocido\n", path.c_str());
+        return 1;
+    }
+    g_print("[Bench] file: %s (%s), %d slots, %s, %d s, %d núcleos\n", path.c_str(),
+            FileSource::format_name(FileSource::probe(path)), n, realtime ? "ritmo real" : "sin ritmo",
+            seconds, ProcStats::cpu_count());
+
+    guint64 rss_before = ProcStats::rss_bytes();
+    DecoderScheduler::instance().set_active_slots(n);
+
+    std::unique_ptr<std::atomic<guint64>[]> rendered(new std::atomic<guint64>[n]);
+    std::vector<std::unique_ptr<StreamSlot>> slots;
+    for (int i = 0; i < n; ++i) {
+        rendered[i] = 0;
+        std::atomic<guint64> *counter = &rendered[i];
+        auto slot = std::make_unique<StreamSlot>();
+        slot->init(i);
+        slot->set_headless([counter](GstBuffer *, GstCaps *) { counter->fetch_add(1, std::memory_order_relaxed); });
+        slot->init_with_file(path, realtime);
+        slots.push_back(std::move(slot));
+    }
+
+    // Índice, arranque y primer keyframe fuera de la medición
+    run_main_loop(3000);
+
+    std::vector<guint64> start_frames(n);
+    guint64 units_start = 0;
+    for (int i = 0; i < n; ++i) {
+        start_frames[i] = rendered[i].load();
+        units_start += slots[i]->sample_metrics().file_units;
+    }
+    gint64 cpu0 = ProcStats::cpu_time_us(), wall0 = g_get_monotonic_time();
+
+    run_main_loop((guint)seconds * 1000);
+
+    gint64 cpu1 = ProcStats::cpu_time_us(), wall1 = g_get_monotonic_time();
+    guint64 frames = 0, units = 0, min_frames = G_MAXUINT64;
+    guint loops = 0;
+    for (int i = 0; i < n; ++i) {
+        SlotMetrics::Snapshot m = slots[i]->sample_metrics();
+        guint64 f = rendered[i].load() - start_frames[i];
+        frames += f;
+        min_frames = std::min(min_frames, f);
+        units += m.file_units;
+        loops += m.file_loops;
+    }
+    units -= units_start;
+    guint64 rss = ProcStats::rss_bytes();
+    slots.clear();
+
+    double elapsed = (wall1 - wall0) / 1e6;
+    double cpu_pct = 100.0 * (cpu1 - cpu0) / (double)(wall1 - wall0);
+    g_print("[Bench]   fps total %.1f  por slot %.1f (mín %.1f)  buffers/s %.0f  vueltas %u\n",
+            frames / elapsed, frames / elapsed / n, min_frames / elapsed, units / elapsed, loops);
+    g_print("[Bench]   CPU %.1f%% (%.1f%% por slot, %.2f ms de CPU por frame)  RSS %.1f MB (+%.1f MB)\n",
+            cpu_pct, cpu_pct / n, frames ? (cpu1 - cpu0) / 1000.0 / frames : 0.0,
+            rss / 1048576.0, (rss > rss_before ? rss - rss_before : 0) / 1048576.0);
+    return frames > 0 ? 0 : 1;
+}
+
+// ===== soak: modos, layouts y reconexiones en ciclo, midiendo el crecimiento =====
+
+static const int kSoakUdpPort = 5600;
+static const int kSoakSrtPort = 7001;
+static const guint kSoakStepMs = 5000;
+
+struct SoakSample {
+    guint64 rss = 0;
+    int fds = -1;
+    int threads = -1;
+    int gst_objects = -1;   // -1: sin tracer "leaks"
+};
+
+// Elementos y pads vivos según el tracer "leaks" (main lo activa para el soak)
+static int live_gst_objects() {
+    int count = -1;
+#if GST_CHECK_VERSION(1, 18, 0)
+    GList *tracers = gst_tracing_get_active_tracers();
+    for (GList *l = tracers; l; l = l->next) {
+        if (strcmp(G_OBJECT_TYPE_NAME(l->data), "GstLeaksTracer") != 0) continue;
+        GstStructure *info = nullptr;
+        g_signal_emit_by_name(l->data, "get-live-objects", &info);
+        if (!info) continue;
+        const GValue *list = gst_structure_get_value(info, "live-objects-list");
+        if (list) count = (int)gst_value_list_get_size(list);
+        gst_structure_free(info);
+    }
+    g_list_free_full(tracers, gst_object_unref);
+#endif
+    return count;
+}
+
+static SoakSample soak_sample() {
+    SoakSample s;
+    s.rss = ProcStats::rss_bytes();
+    s.fds = ProcStats::open_fds();
+    s.threads = ProcStats::thread_count();
+    s.gst_objects = live_gst_objects();
+    return s;
+}
+
+static int env_int(const char *name, int fallback) {
+    const char *value = g_getenv(name);
+    return value ? atoi(value) : fallback;
+}
+
+struct SoakRig {
+    int n = 0;
+    StreamMode mode = StreamMode::UDP_SAFE;
+    bool standby = false;
+    GstElement *udp_sender = nullptr;
+    GstElement *srt_sender = nullptr;
+    std::vector<std::unique_ptr<StreamSlot>> slots;
+    std::unique_ptr<std::atomic<guint64>[]> rendered;
+
+    void start_senders() {
+        TestSender::Options options;
+        options.bitrate_kbps = 1000;
+        udp_sender = TestSender::start(StreamMode::UDP_SAFE, kSoakUdpPort, options, n);
+        srt_sender = TestSender::start(StreamMode::SRT_MOSAIC, kSoakSrtPort, options, n);
+    }
+
+    void stop_senders() {
+        if (udp_sender) TestSender::stop(udp_sender);
+        if (srt_sender) TestSender::stop(srt_sender);
+        udp_sender = srt_sender = nullptr;
+    }
+
+    void start_slot(int i) {
+        StreamSlot &slot = *slots[i];
+        std::string streamid = "soak" + std::to_string(i);
+        std::string port = std::to_string(kSoakUdpPort + i);
+        if (standby) {
+            slot.init_standby(streamid, port, mode, 6 * 1024 * 1024);
+            return;
+        }
+        switch (mode) {
+            case StreamMode::SRT_MOSAIC: slot.init_with_streamid(streamid); break;
+            case StreamMode::UDP_SAFE:   slot.init_with_udp_port_safe(port); break;
+            case StreamMode::UDP_FAST:   slot.init_with_udp_port_fast(port); break;
+        }
+    }
+
+    // Slot nuevo en la posición i (el anterior se destruye, como al salir del layout)
+    void create_slot(int i) {
+        std::atomic<guint64> *counter = &rendered[i];
+        auto slot = std::make_unique<StreamSlot>();
+        slot->init(i);
+        slot->set_headless([counter](GstBuffer *, GstCaps *) { counter->fetch_add(1, std::memory_order_relaxed); });
+        slots[i] = std::move(slot);
+        start_slot(i);
+    }
+
+    void restart_all(StreamMode new_mode, bool new_standby) {
+        mode = new_mode;
+        standby = new_standby;
+        for (int i = 0; i < n; ++i) start_slot(i);
+    }
+};
+
+// Un paso del ciclo: deja el rig en un estado nuevo y devuelve su nombre
+static const char* soak_step(SoakRig &rig, int step) {
+    switch (step) {
+        case 0:
+            PipelineDesc::set_udp_ingest(false);
+            rig.restart_all(StreamMode::UDP_SAFE, false);
+            return "UDP_SAFE";
+        case 1:
+            rig.restart_all(StreamMode::UDP_FAST, false);
+            return "UDP_FAST";
+        case 2:
+            rig.restart_all(StreamMode::SRT_MOSAIC, false);
+            return "SRT";
+        case 3:
+            // Standby: el cambio de rama no reconstruye el pipeline
+            rig.restart_all(StreamMode::UDP_SAFE, true);
+            run_main_loop(kSoakStepMs / 2);
+            for (auto &slot : rig.slots) slot->select_mode(StreamMode::SRT_MOSAIC);
+            return "standby";
+        case 4:
+            PipelineDesc::set_udp_ingest(true);
+            rig.restart_all(StreamMode::UDP_SAFE, false);
+            return "ingesta UDP";
+        case 5:
+            // Cambio de layout: la mitad de los slots se destruye y se crea de nuevo
+            PipelineDesc::set_udp_ingest(false);
+            rig.mode = StreamMode::UDP_FAST;
+            rig.standby = false;
+            for (int i = 0; i < rig.n; ++i) {
+                if (i % 2 == 0) rig.create_slot(i);
+                else rig.start_slot(i);
+            }
+            return "layout";
+        default:
+            // Caída de los emisores: reconexión SRT y retención en UDP
+            rig.restart_all(StreamMode::SRT_MOSAIC, false);
+            run_main_loop(kSoakStepMs / 2);
+            rig.stop_senders();
+            run_main_loop(4000);
+            rig.start_senders();
+            return "reconexión";
+    }
+}
+
+static const int kSoakSteps = 7;
+
+static int bench_soak(int minutes, int n) {
+    const double max_rss_mb = env_int("MOSAIC_SOAK_RSS_MB", 64);
+    const int max_fds = env_int("MOSAIC_SOAK_FDS", 8);
+    const int max_threads = env_int("MOSAIC_SOAK_THREADS", 8);
+    const int max_objects = env_int("MOSAIC_SOAK_OBJECTS", 200);
+
+    g_print("[Bench] soak: %d slots, %d min, %d pasos de %u ms por vuelta\n", n, minutes, kSoakSteps, kSoakStepMs);
+    g_print("[Bench]   límites de crecimiento: RSS %.0f MB, fds %d, hilos %d, objetos gst %d\n",
+            max_rss_mb, max_fds, max_threads, max_objects);
+
+    SoakRig rig;
+    rig.n = n;
+    rig.rendered.reset(new std::atomic<guint64>[n]);
+    rig.slots.resize(n);
+    for (int i = 0; i < n; ++i) rig.rendered[i] = 0;
+
+    DecoderScheduler::instance().set_active_slots(n);
+    PipelineDesc::set_srt_server("127.0.0.1:" + std::to_string(kSoakSrtPort));
+    rig.start_senders();
+    if (!rig.udp_sender || !rig.srt_sender) {
+        rig.stop_senders();
+        return 1;
+    }
+    for (int i = 0; i < n; ++i) rig.create_slot(i);
+
+    // Línea base al final de la primera vuelta: pools, cachés e hilos ya creados
+    SoakSample base, last;
+    bool have_base = false;
+    gint64 end_us = g_get_monotonic_time() + (gint64)minutes * 60 * G_USEC_PER_SEC;
+    int round = 0;
+    while (!have_base || g_get_monotonic_time() < end_us) {
+        std::vector<guint64> rendered_before(n);
+        const char *name = "";
+        for (int step = 0; step < kSoakSteps; ++step) {
+            for (int i = 0; i < n; ++i) rendered_before[i] = rig.rendered[i].load();
+            name = soak_step(rig, step);
+            run_main_loop(kSoakStepMs);
+        }
+
+        // Tiles que no se recuperaron después del último paso (reconexión)
+        int stalled = 0;
+        for (int i = 0; i < n; ++i)
+            if (rig.rendered[i].load() == rendered_before[i]) stalled++;
+
+        last = soak_sample();
+        if (!have_base) {
+            base = last;
+            have_base = true;
+        }
+        round++;
+        g_print("[Bench] vuelta %3d  RSS %7.1f MB (%+6.1f)  fds %4d (%+d)  hilos %4d (%+d)  objetos gst %5d (%+d)  sin frames tras %s: %d\n",
+                round, last.rss / 1048576.0, ((double)last.rss - (double)base.rss) / 1048576.0,
+                last.fds, last.fds - base.fds, last.threads, last.threads - base.threads,
+                last.gst_objects, last.gst_objects - base.gst_objects, name, stalled);
+    }
+
+    rig.slots.clear();
+    rig.stop_senders();
+
+    // Crecimiento de la última vuelta respecto de la línea base
+    double rss_growth = ((double)last.rss - (double)base.rss) / 1048576.0;
+    bool ok = true;
+    if (rss_growth > max_rss_mb) {
+        g_print("[Bench] FALLA: RSS creció %.1f MB (límite %.0f)\n", rss_growth, max_rss_mb);
+        ok = false;
+    }
+    if (base.fds >= 0 && last.fds - base.fds > max_fds) {
+        g_print("[Bench] FALLA: %d descriptores más (límite %d)\n", last.fds - base.fds, max_fds);
+        ok = false;
+    }
+    if (base.threads >= 0 && last.threads - base.threads > max_threads) {
+        g_print("[Bench] FALLA: %d hilos más (límite %d)\n", last.threads - base.threads, max_threads);
+        ok = false;
+    }
+    if (base.gst_objects >= 0 && last.gst_objects - base.gst_objects > max_objects) {
+        g_print("[Bench] FALLA: %d objetos de GStreamer más (límite %d)\n",
+                last.gst_objects - base.gst_objects, max_objects);
+        ok = false;
+    }
+    if (base.gst_objects < 0)
+        g_print("[Bench] Sin tracer \"leaks\": no se cuentan objetos de GStreamer\n");
+    g_print("[Bench] soak %s tras %d vueltas\n", ok ? "OK" : "FALLIDO", round);
+    return ok ? 0 : 1;
+}
+
+// ===== Entrada =====
+
+static void usage() {
+    g_printerr("Uso: multistream_mosaic --bench <nombre> [opciones]\n"
+               "  convert [frames]   conversión+escala YUV->BGRx vs videoconvert\n"
+               "  freeze [frames]    análisis de contenido del watchdog: escalar vs SIMD, CPU por stream\n"
+               "  latency [segundos] [safe|fast|srt ...]\n"
+               "                     latencia captura->sink por modo (percentiles)\n"
+               "  scale [max_n] [safe|fast|srt] [segundos]\n"
+               "                     N slots headless (1, 2, 4 ... max_n): CPU, fps, drops, memoria\n"
+               "  file <ruta> [n] [realtime|fast] [segundos]\n"
+               "                     n slots headless sobre un archivo grabado (mapeo compartido):\n"
+               "                     fps de decode, CPU y memoria, sin red\n"
+               "  soak [minutos] [n] ciclos de modo/layout/reconexión con n slots; falla si crecen\n"
+               "                     RSS, fds, hilos u objetos de GStreamer (MOSAIC_SOAK_*)\n");
+}
+
+int run(int argc, char **argv) {
+    if (argc < 1) {
+        usage();
+        return 1;
+    }
+
+    std::string name = argv[0];
+    if (name == "convert") {
+        int frames = argc > 1 ? std::max(1, atoi(argv[1])) : 200;
+        return bench_convert(frames);
+    }
+    if (name == "freeze") {
+        int frames = argc > 1 ? std::max(1, atoi(argv[1])) : 500;
+        return bench_freeze(frames);
+    }
+    if (name == "latency") {
+        int seconds = argc > 1 ? std::max(1, atoi(argv[1])) : 10;
+        std::vector<StreamMode> modes;
+        for (int i = 2; i < argc; ++i) {
+            std::string m = argv[i];
+            if (m == "safe") modes.push_back(StreamMode::UDP_SAFE);
+            else if (m == "fast") modes.push_back(StreamMode::UDP_FAST);
+            else if (m == "srt") modes.push_back(StreamMode::SRT_MOSAIC);
+        }
+        if (modes.empty()) modes = {StreamMode::UDP_SAFE, StreamMode::UDP_FAST, StreamMode::SRT_MOSAIC};
+        return bench_latency(seconds, modes);
+    }
+    if (name == "scale") {
+        int max_n = argc > 1 ? std::max(1, std::min(64, atoi(argv[1]))) : 64;
+        StreamMode mode = StreamMode::UDP_SAFE;
+        if (argc > 2 && g_strcmp0(argv[2], "fast") == 0) mode = StreamMode::UDP_FAST;
+        if (argc > 2 && g_strcmp0(argv[2], "srt") == 0) mode = StreamMode::SRT_MOSAIC;
+        int seconds = argc > 3 ? std::max(1, atoi(argv[3])) : 10;
+        return bench_scale(max_n, mode, seconds);
+    }
+    if (name == "file" && argc > 1) {
+        int n = argc > 2 ? std::max(1, std::min(64, atoi(argv[2]))) : 1;
+        bool realtime = !(argc > 3 && g_strcmp0(argv[3], "fast") == 0);
+        int seconds = argc > 4 ? std::max(1, atoi(argv[4])) : 10;
+        return bench_file(argv[1], n, realtime, seconds);
+    }
+    if (name == "soak") {
+        int minutes = argc > 1 ? std::max(1, atoi(argv[1])) : 10;
+        int n = argc > 2 ? std::max(1, std::min(64, atoi(argv[2]))) : 4;
+        return bench_soak(minutes, n);
+    }
+
+    usage();
+    return 1;
+}
+
+} // namespace Bench
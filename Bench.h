@@ -0,0 +1,11 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Benchmarks sin interfaz gráfica (multistream_mosaic --bench <nombre>)
+namespace Bench {
+
+    // argv[0] es el nombre del benchmark. Devuelve el código de salida.
+    int run(int argc, char **argv);
+}
+
+#endif // BENCH_H
@@ -0,0 +1,195 @@
+#include <cstring>
+#include <vector>
+#include "CodecCache.h"
+
+CodecCache::CodecCache() {
+    g_mutex_init(&lock);
+}
+
+CodecCache::~CodecCache() {
+    detach();
+    if (headers) gst_buffer_unref(headers);
+    if (keyframe) gst_buffer_unref(keyframe);
+    g_mutex_clear(&lock);
+}
+
+void CodecCache::set_source(const std::string &key) {
+    if (key == source_key) return;
+    source_key = key;
+
+    g_mutex_lock(&lock);
+    GstBuffer *old_headers = headers;
+    GstBuffer *old_keyframe = keyframe;
+    headers = keyframe = nullptr;
+    g_mutex_unlock(&lock);
+
+    if (old_headers) gst_buffer_unref(old_headers);
+    if (old_keyframe) gst_buffer_unref(old_keyframe);
+}
+
+bool CodecCache::has_headers() {
+    g_mutex_lock(&lock);
+    bool has = headers != nullptr;
+    g_mutex_unlock(&lock);
+    return has;
+}
+
+// ===== H.264 byte-stream =====
+
+static gsize next_start_code(const guint8 *data, gsize size, gsize from) {
+    for (gsize i = from; i + 3 <= size; ++i)
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) return i;
+    return size;
+}
+
+// Recorre los NAL del access unit hasta el primer slice (no se escanea el
+// frame en sí). Copia los SPS/PPS a out (si no es nullptr) con start code de
+// 4 bytes y devuelve true si el AU trae SPS.
+static bool scan_parameter_sets(const guint8 *data, gsize size, std::vector<guint8> *out) {
+    static const guint8 start_code[4] = {0, 0, 0, 1};
+    bool has_sps = false;
+
+    gsize sc = next_start_code(data, size, 0);
+    while (sc < size) {
+        gsize start = sc + 3;
+        if (start >= size) break;
+
+        int type = data[start] & 0x1f;
+        if (type == 1 || type == 5) break;
+
+        gsize next = next_start_code(data, size, start);
+        gsize end = next;
+        while (end > start && data[end - 1] == 0) --end;  // cero inicial del próximo start code
+
+        if (type == 7 || type == 8) {
+            if (type == 7) has_sps = true;
+            if (out) {
+                out->insert(out->end(), start_code, start_code + 4);
+                out->insert(out->end(), data + start, data + end);
+            }
+        }
+        sc = next;
+    }
+    return has_sps;
+}
+
+static bool buffer_has_sps(GstBuffer *buffer) {
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return false;
+    bool has = scan_parameter_sets(map.data, map.size, nullptr);
+    gst_buffer_unmap(buffer, &map);
+    return has;
+}
+
+// ===== Probe (hilo de streaming) =====
+
+void CodecCache::attach(GstElement *pipeline) {
+    detach();
+    GstElement *decq = gst_bin_get_by_name(GST_BIN(pipeline), "decq");
+    if (!decq) return;
+    probe_pad = gst_element_get_static_pad(decq, "sink");
+    if (probe_pad) {
+        probe_id = gst_pad_add_probe(probe_pad,
+                                     (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                                     &CodecCache::input_probe_cb, this, NULL);
+    }
+    gst_object_unref(decq);
+}
+
+void CodecCache::detach() {
+    if (probe_pad) {
+        gst_pad_remove_probe(probe_pad, probe_id);
+        gst_object_unref(probe_pad);
+    }
+    probe_pad = nullptr;
+    probe_id = 0;
+}
+
+GstPadProbeReturn CodecCache::input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    CodecCache *self = static_cast<CodecCache *>(user_data);
+
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        self->on_input(GST_PAD_PROBE_INFO_BUFFER(info));
+        return GST_PAD_PROBE_OK;
+    }
+
+    // Solo H.264 en byte-stream trae los parámetros en banda (avc los lleva en las caps)
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+        GstCaps *caps;
+        gst_event_parse_caps(event, &caps);
+        const GstStructure *s = gst_caps_get_structure(caps, 0);
+        const gchar *format = gst_structure_get_string(s, "stream-format");
+        self->byte_stream = gst_structure_has_name(s, "video/x-h264") && format &&
+                            strcmp(format, "byte-stream") == 0;
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void CodecCache::on_input(GstBuffer *buffer) {
+    if (!byte_stream.load(std::memory_order_relaxed)) return;
+
+    bool key = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    if (!key && !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_HEADER)) return;
+
+    std::vector<guint8> sets;
+    GstMapInfo map;
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) return;
+    scan_parameter_sets(map.data, map.size, &sets);
+    gst_buffer_unmap(buffer, &map);
+
+    GstBuffer *new_headers = nullptr;
+    if (!sets.empty()) {
+        new_headers = gst_buffer_new_allocate(NULL, sets.size(), NULL);
+        gst_buffer_fill(new_headers, 0, sets.data(), sets.size());
+    }
+
+    g_mutex_lock(&lock);
+    GstBuffer *old_headers = nullptr;
+    GstBuffer *old_keyframe = nullptr;
+    if (new_headers) {
+        old_headers = headers;
+        headers = new_headers;
+    }
+    if (key) {
+        old_keyframe = keyframe;
+        keyframe = gst_buffer_ref(buffer);
+    }
+    g_mutex_unlock(&lock);
+
+    if (old_headers) gst_buffer_unref(old_headers);
+    if (old_keyframe) gst_buffer_unref(old_keyframe);
+}
+
+// ===== Arranque del decoder (hilo de streaming del pipeline nuevo) =====
+
+GstBuffer* CodecCache::complete_keyframe(GstBuffer *buffer) {
+    if (!byte_stream.load(std::memory_order_relaxed) || buffer_has_sps(buffer)) return buffer;
+
+    g_mutex_lock(&lock);
+    GstBuffer *sets = headers ? gst_buffer_ref(headers) : nullptr;
+    g_mutex_unlock(&lock);
+    if (!sets) return buffer;
+
+    // Copia liviana: comparte la memoria del keyframe, solo se antepone la de los parámetros
+    GstBuffer *out = gst_buffer_copy(buffer);
+    gst_buffer_prepend_memory(out, gst_buffer_get_all_memory(sets));
+    gst_buffer_unref(sets);
+    gst_buffer_unref(buffer);
+    return out;
+}
+
+GstBuffer* CodecCache::warmup_buffer() {
+    g_mutex_lock(&lock);
+    GstBuffer *last = keyframe ? gst_buffer_ref(keyframe) : nullptr;
+    g_mutex_unlock(&lock);
+    if (!last) return nullptr;
+
+    // El decoder lo procesa pero no entrega el frame: no se muestra una imagen vieja
+    GstBuffer *out = gst_buffer_make_writable(complete_keyframe(last));
+    GST_BUFFER_PTS(out) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DTS(out) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_FLAG_SET(out, GST_BUFFER_FLAG_DECODE_ONLY);
+    GST_BUFFER_FLAG_SET(out, GST_BUFFER_FLAG_DISCONT);
+    return out;
+}
@@ -0,0 +1,47 @@
+#ifndef CODECCACHE_H
+#define CODECCACHE_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <string>
+
+// Parámetros de codec (SPS/PPS) y último keyframe H.264 de la fuente de un
+// slot, tomados a la entrada de "decq". Sobreviven a los reinicios del
+// pipeline: el decoder nuevo recibe los parámetros aunque el emisor no los
+// repita en banda, y se calienta con el último keyframe antes del stream vivo.
+class CodecCache {
+public:
+    CodecCache();
+    ~CodecCache();
+
+    // Fuente del slot (modo + streamid/puerto). Si cambia, se descarta todo.
+    void set_source(const std::string &key);
+
+    // Probe en la entrada de "decq" del pipeline. Deja el del pipeline
+    // anterior: uno que sigue vivo (cambio de variante) no mezcla su fuente.
+    void attach(GstElement *pipeline);
+    void detach();
+
+    // Keyframe sin SPS/PPS en banda: devuelve uno con los cacheados delante.
+    // Toma la referencia de keyframe.
+    GstBuffer* complete_keyframe(GstBuffer *keyframe);
+    // Copia del último keyframe (con SPS/PPS) marcada DECODE_ONLY, o nullptr
+    GstBuffer* warmup_buffer();
+
+    bool has_headers();
+
+private:
+    GMutex lock;
+    GstBuffer *headers = nullptr;    // SPS/PPS con start codes (protegido por lock)
+    GstBuffer *keyframe = nullptr;   // protegido por lock
+    std::string source_key;          // solo hilo principal
+    std::atomic<bool> byte_stream{false};
+    GstPad *probe_pad = nullptr;     // solo hilo principal
+    gulong probe_id = 0;
+
+    void on_input(GstBuffer *buffer);
+
+    static GstPadProbeReturn input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+};
+
+#endif // CODECCACHE_H
@@ -0,0 +1,169 @@
+#include <cstdlib>
+#include <cstring>
+#include <glib/gstdio.h>
+#include "ControlServer.h"
+
+#ifdef G_OS_UNIX
+#include <gio/gunixsocketaddress.h>
+#endif
+
+// Una línea de comando no necesita más; lo demás es basura o un cliente roto.
+// Es también el tamaño del buffer de entrada: no se lee más sin un fin de línea.
+static const gsize kMaxLine = 4096;
+
+// Hay una línea completa en el buffer (leerla no espera al socket)
+static bool has_line(GBufferedInputStream *input) {
+    gsize available = 0;
+    const void *data = g_buffered_input_stream_peek_buffer(input, &available);
+    return available && memchr(data, '\n', available);
+}
+
+ControlServer::ControlServer(Handler h) : handler(std::move(h)) {}
+
+ControlServer::~ControlServer() {
+    stop();
+}
+
+bool ControlServer::start() {
+    if (service) return true;
+
+    GSocketAddress *address = nullptr;
+#ifdef G_OS_UNIX
+    const char *env = g_getenv("MOSAIC_CONTROL_SOCKET");
+    if (env && !*env) return false;
+    if (env) {
+        path = env;
+    } else {
+        gchar *file = g_build_filename(g_get_user_runtime_dir(), "multistream_mosaic.sock", NULL);
+        path = file;
+        g_free(file);
+    }
+    // Un socket que quedó de una ejecución anterior impide el bind
+    g_unlink(path.c_str());
+    address = g_unix_socket_address_new(path.c_str());
+#else
+    const char *env = g_getenv("MOSAIC_CONTROL_PORT");
+    int port = env ? atoi(env) : 7900;
+    if (port <= 0) return false;
+    path = "127.0.0.1:" + std::to_string(port);
+    GInetAddress *loopback = g_inet_address_new_loopback(G_SOCKET_FAMILY_IPV4);
+    address = g_inet_socket_address_new(loopback, (guint16)port);
+    g_object_unref(loopback);
+#endif
+
+    service = g_socket_service_new();
+    GError *error = nullptr;
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(service), address, G_SOCKET_TYPE_STREAM,
+                                       G_SOCKET_PROTOCOL_DEFAULT, NULL, NULL, &error)) {
+        g_printerr("[Control] No se pudo escuchar en %s: %s\n", path.c_str(), error->message);
+        g_error_free(error);
+        g_object_unref(address);
+        g_object_unref(service);
+        service = nullptr;
+        return false;
+    }
+    g_object_unref(address);
+#ifdef G_OS_UNIX
+    // Solo el usuario que corre el mosaico puede controlarlo
+    g_chmod(path.c_str(), 0600);
+#endif
+
+    cancellable = g_cancellable_new();
+    g_signal_connect(service, "incoming", G_CALLBACK(&ControlServer::on_incoming), this);
+    g_socket_service_start(service);
+    g_print("[Control] Escuchando en %s\n", path.c_str());
+    return true;
+}
+
+void ControlServer::stop() {
+    if (!service) return;
+    // Los clientes abiertos terminan su lectura pendiente con error y se liberan solos
+    g_cancellable_cancel(cancellable);
+    g_object_unref(cancellable);
+    cancellable = nullptr;
+
+    g_socket_service_stop(service);
+    g_socket_listener_close(G_SOCKET_LISTENER(service));
+    g_object_unref(service);
+    service = nullptr;
+#ifdef G_OS_UNIX
+    g_unlink(path.c_str());
+#endif
+}
+
+gboolean ControlServer::on_incoming(GSocketService *service, GSocketConnection *connection,
+                                    GObject *source, gpointer data) {
+    ControlServer *self = static_cast<ControlServer *>(data);
+
+    Client *client = new Client;
+    client->connection = G_SOCKET_CONNECTION(g_object_ref(connection));
+    client->input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    // Solo '\n' termina la línea (un '\r' final se recorta con el resto de espacios)
+    g_data_input_stream_set_newline_type(client->input, G_DATA_STREAM_NEWLINE_TYPE_LF);
+    g_buffered_input_stream_set_buffer_size(G_BUFFERED_INPUT_STREAM(client->input), kMaxLine);
+    client->cancellable = G_CANCELLABLE(g_object_ref(self->cancellable));
+    client->server = self;
+
+    self->read_next(client);
+    return TRUE;
+}
+
+void ControlServer::read_next(Client *client) {
+    GBufferedInputStream *buffered = G_BUFFERED_INPUT_STREAM(client->input);
+
+    while (has_line(buffered)) {
+        gchar *line = g_data_input_stream_read_line(client->input, NULL, NULL, NULL);
+        std::vector<std::string> args;
+        gchar **words = g_strsplit_set(g_strstrip(line), " \t", -1);
+        for (gchar **w = words; *w; ++w)
+            if (**w) args.push_back(*w);
+        g_strfreev(words);
+        g_free(line);
+        if (args.empty()) continue;
+
+        // Sin bloquear el hilo de GTK aunque el cliente no lea: la próxima
+        // línea se atiende cuando la respuesta terminó de salir
+        client->reply = handler(args) + "\n";
+        GOutputStream *output = g_io_stream_get_output_stream(G_IO_STREAM(client->connection));
+        g_output_stream_write_all_async(output, client->reply.data(), client->reply.size(), G_PRIORITY_DEFAULT,
+                                        client->cancellable, &ControlServer::on_written, client);
+        return;
+    }
+
+    // Buffer lleno sin fin de línea: línea absurda
+    if (g_buffered_input_stream_get_available(buffered) >= kMaxLine) {
+        close_client(client);
+        return;
+    }
+    g_buffered_input_stream_fill_async(buffered, -1, G_PRIORITY_DEFAULT, client->cancellable,
+                                       &ControlServer::on_filled, client);
+}
+
+void ControlServer::close_client(Client *client) {
+    g_io_stream_close(G_IO_STREAM(client->connection), NULL, NULL);
+    g_object_unref(client->input);
+    g_object_unref(client->connection);
+    g_object_unref(client->cancellable);
+    delete client;
+}
+
+void ControlServer::on_filled(GObject *source, GAsyncResult *result, gpointer data) {
+    Client *client = static_cast<Client *>(data);
+    gssize filled = g_buffered_input_stream_fill_finish(G_BUFFERED_INPUT_STREAM(source), result, NULL);
+
+    // Cliente cerrado o servidor detenido (cancelado)
+    if (filled <= 0) {
+        close_client(client);
+        return;
+    }
+    client->server->read_next(client);
+}
+
+void ControlServer::on_written(GObject *source, GAsyncResult *result, gpointer data) {
+    Client *client = static_cast<Client *>(data);
+    if (!g_output_stream_write_all_finish(G_OUTPUT_STREAM(source), result, NULL, NULL)) {
+        close_client(client);
+        return;
+    }
+    client->server->read_next(client);
+}
@@ -0,0 +1,51 @@
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <gio/gio.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Canal de control local para automatización: un socket Unix
+// (MOSAIC_CONTROL_SOCKET, por defecto <runtime dir>/multistream_mosaic.sock;
+// vacío lo desactiva) con un protocolo de líneas. Cada línea es un comando
+// separado por espacios y recibe una línea de respuesta: "ok", "ok <json>" o
+// "error <motivo>". En Windows escucha en 127.0.0.1:MOSAIC_CONTROL_PORT
+// (por defecto 7900). Todo corre en el hilo de GTK, sin hilos propios.
+class ControlServer {
+public:
+    // Comando ya separado en palabras -> respuesta sin salto de línea
+    using Handler = std::function<std::string(const std::vector<std::string> &args)>;
+
+    explicit ControlServer(Handler handler);
+    ~ControlServer();
+
+    bool start();
+    void stop();
+    const std::string& address() const { return path; }
+
+private:
+    struct Client {
+        GSocketConnection *connection;
+        GDataInputStream *input;
+        GCancellable *cancellable;
+        ControlServer *server;
+        std::string reply;   // vivo hasta que termine la escritura
+    };
+
+    Handler handler;
+    GSocketService* service = nullptr;
+    GCancellable* cancellable = nullptr;   // compartido por los clientes abiertos
+    std::string path;
+
+    // Atiende la próxima línea ya recibida o espera más datos
+    void read_next(Client *client);
+    static void close_client(Client *client);
+
+    static gboolean on_incoming(GSocketService *service, GSocketConnection *connection,
+                                GObject *source, gpointer data);
+    static void on_filled(GObject *source, GAsyncResult *result, gpointer data);
+    static void on_written(GObject *source, GAsyncResult *result, gpointer data);
+};
+
+#endif // CONTROLSERVER_H
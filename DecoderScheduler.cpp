@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdlib>
+#include "DecoderScheduler.h"
+#include "ProcStats.h"
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static int env_int(const char *name, int fallback) {
+    const char *value = g_getenv(name);
+    return value ? atoi(value) : fallback;
+}
+
+DecoderScheduler& DecoderScheduler::instance() {
+    static DecoderScheduler scheduler;
+    return scheduler;
+}
+
+DecoderScheduler::DecoderScheduler() {
+    cpu_count = std::max(1, ProcStats::cpu_count());
+    budget = env_int("MOSAIC_CPU_BUDGET", cpu_count - 1);
+    budget = std::max(1, std::min(budget, std::max(1, cpu_count - 1)));
+    pin_threads = env_int("MOSAIC_PIN_THREADS", 0) != 0;
+    stream_nice = env_int("MOSAIC_STREAM_NICE", 0);
+}
+
+void DecoderScheduler::set_active_slots(int active_slots) {
+    active_slots = std::max(1, active_slots);
+    if (active_slots == active) return;
+    active = active_slots;
+
+    SlotPlan plan = plan_for(0, StreamMode::SRT_MOSAIC);
+    g_print("[DecoderScheduler] %d slots activos, presupuesto %d de %d núcleos -> %d hilo(s) por decoder%s\n",
+            active, budget, cpu_count, plan.threads, pin_threads ? ", afinidad fija" : "");
+}
+
+DecoderScheduler::SlotPlan DecoderScheduler::plan_for(int slot_index, StreamMode mode) const {
+    SlotPlan plan;
+    plan.threads = std::max(1, budget / active);
+    // Frame threading agrega un frame de latencia por hilo: en FAST, slices
+    plan.slice_threading = (mode == StreamMode::UDP_FAST);
+
+    // Núcleos 1..budget para decodificar; el 0 es del hilo de GTK
+    plan.core_count = std::min(plan.threads, budget);
+    plan.first_core = 1 + (std::max(0, slot_index) * plan.core_count) % budget;
+    return plan;
+}
+
+void DecoderScheduler::configure_decoder(GstElement *decoder, const SlotPlan &plan) const {
+    GObjectClass *klass = G_OBJECT_GET_CLASS(decoder);
+
+    if (g_object_class_find_property(klass, "max-threads"))
+        g_object_set(decoder, "max-threads", plan.threads, NULL);
+
+    // avdec_*: flags 0x1 = frame, 0x2 = slice
+    if (plan.threads > 1 && g_object_class_find_property(klass, "thread-type"))
+        g_object_set(decoder, "thread-type", plan.slice_threading ? 0x2 : 0x1, NULL);
+}
+
+void DecoderScheduler::apply_to_current_thread(const SlotPlan &plan) const {
+    // Rotar dentro de 1..budget sin caer en el núcleo 0 de GTK (con un solo
+    // núcleo no hay otro que usar)
+    auto decode_core = [&](int i) { return (1 + (plan.first_core - 1 + i) % budget) % cpu_count; };
+
+    if (pin_threads) {
+#ifdef G_OS_WIN32
+        DWORD_PTR mask = 0;
+        for (int i = 0; i < plan.core_count; ++i)
+            mask |= (DWORD_PTR)1 << decode_core(i);
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int i = 0; i < plan.core_count; ++i)
+            CPU_SET(decode_core(i), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+
+    if (stream_nice != 0) {
+#ifdef G_OS_WIN32
+        SetThreadPriority(GetCurrentThread(),
+                          stream_nice > 0 ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_ABOVE_NORMAL);
+#elif defined(__linux__)
+        // En Linux el nice es por hilo (tid)
+        setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), stream_nice);
+#endif
+    }
+}
+
+void DecoderScheduler::pin_ui_thread() const {
+    if (!pin_threads) return;
+#ifdef G_OS_WIN32
+    SetThreadAffinityMask(GetCurrentThread(), 1);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(0, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    g_print("[DecoderScheduler] Hilo de GTK fijado al núcleo 0\n");
+}
+
+void DecoderScheduler::release_current_thread() const {
+    if (!pin_threads || cpu_count < 2) return;
+#ifdef G_OS_WIN32
+    DWORD_PTR mask = 0;
+    for (int i = 1; i < cpu_count && i < (int)(8 * sizeof(DWORD_PTR)); ++i)
+        mask |= (DWORD_PTR)1 << i;
+    SetThreadAffinityMask(GetCurrentThread(), mask);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 1; i < cpu_count; ++i)
+        CPU_SET(i, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+void DecoderScheduler::release_streaming_threads(GstElement *pipeline) const {
+    if (!pin_threads || cpu_count < 2) return;
+    GstBus *bus = gst_element_get_bus(pipeline);
+    gst_bus_set_sync_handler(bus, &DecoderScheduler::release_sync_cb, NULL, NULL);
+    gst_object_unref(bus);
+}
+
+// En el hilo que entra (GST_STREAM_STATUS_TYPE_ENTER), como el de los slots
+GstBusSyncReply DecoderScheduler::release_sync_cb(GstBus *bus, GstMessage *msg, gpointer data) {
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+        GstStreamStatusType type;
+        GstElement *owner;
+        gst_message_parse_stream_status(msg, &type, &owner);
+        if (type == GST_STREAM_STATUS_TYPE_ENTER) instance().release_current_thread();
+    }
+    return GST_BUS_PASS;
+}
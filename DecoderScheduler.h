@@ -0,0 +1,60 @@
+#ifndef DECODERSCHEDULER_H
+#define DECODERSCHEDULER_H
+
+#include <gst/gst.h>
+#include "PipelineDesc.h"
+
+// Reparte un presupuesto de núcleos entre los slots activos: hilos por
+// decoder, tipo de threading (slice/frame) y, opcionalmente, afinidad y
+// prioridad de los hilos de streaming de cada slot. El núcleo 0 queda
+// reservado para el hilo de GTK.
+//
+// Configuración por variables de entorno:
+//   MOSAIC_CPU_BUDGET   núcleos para decodificar (por defecto: todos menos 1)
+//   MOSAIC_PIN_THREADS  1 = fijar afinidad de hilos de streaming y de GTK
+//   MOSAIC_STREAM_NICE  nice de los hilos de streaming (Linux, por defecto 0)
+class DecoderScheduler {
+public:
+    struct SlotPlan {
+        int threads;          // max-threads del decoder
+        bool slice_threading; // slice (baja latencia) o frame (más throughput)
+        int first_core;       // primer núcleo asignado al slot
+        int core_count;       // núcleos asignados al slot
+    };
+
+    static DecoderScheduler& instance();
+
+    void set_active_slots(int active_slots);
+    SlotPlan plan_for(int slot_index, StreamMode mode) const;
+
+    // Aplica threads/threading a un decoder (antes de abrirlo)
+    void configure_decoder(GstElement *decoder, const SlotPlan &plan) const;
+
+    // Se llama desde el propio hilo de streaming (GST_STREAM_STATUS_TYPE_ENTER)
+    void apply_to_current_thread(const SlotPlan &plan) const;
+
+    // Fija el hilo de GTK a su núcleo reservado
+    void pin_ui_thread() const;
+
+    // Hilos auxiliares (cola de trabajos de los slots): todos los núcleos
+    // menos el de GTK, para que lo que creen no herede la afinidad del UI
+    void release_current_thread() const;
+
+    // Lo mismo para los hilos de streaming de un pipeline que no es de un
+    // slot (compositor, salida codificada, repetición) y que pasa a PLAYING
+    // desde el hilo de GTK
+    void release_streaming_threads(GstElement *pipeline) const;
+
+private:
+    DecoderScheduler();
+
+    static GstBusSyncReply release_sync_cb(GstBus *bus, GstMessage *msg, gpointer data);
+
+    int cpu_count = 1;
+    int budget = 1;
+    int active = 1;
+    bool pin_threads = false;
+    int stream_nice = 0;
+};
+
+#endif // DECODERSCHEDULER_H
@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+#include "FileSource.h"
+#include "DecoderScheduler.h"
+
+// Cola máxima del appsrc: más allá se espera (no se descarta, la prueba tiene que ser repetible)
+static const guint64 kMaxQueueBytes = 4 * 1024 * 1024;
+// MPEG-TS: paquetes por buffer, lo mismo que lleva un datagrama SRT/UDP
+static const gsize kTsPacket = 188;
+static const gsize kTsPerBuffer = 7;
+// Si la entrega se atrasa más que esto (pipeline frenado), se retoma desde ahora
+static const gint64 kMaxLagUs = G_USEC_PER_SEC;
+
+// Trozo del archivo que se entrega como un buffer, con su hora desde el comienzo
+struct Unit {
+    gsize offset;
+    guint size;
+    gint64 time_us;
+};
+
+struct FileSource::Capture {
+    std::string path;
+    GMappedFile *file = nullptr;
+    Format format = Format::UNKNOWN;
+    std::vector<Unit> units;
+    gint64 duration_us = 0;     // una vuelta, hasta repetir la primera unidad
+
+    ~Capture() {
+        if (file) g_mapped_file_unref(file);
+    }
+};
+
+// ===== Formato =====
+
+static guint16 be16(const uint8_t *p) {
+    return (guint16)((p[0] << 8) | p[1]);
+}
+
+static guint32 read32(const uint8_t *p, bool swap) {
+    guint32 v = (guint32)p[0] | ((guint32)p[1] << 8) | ((guint32)p[2] << 16) | ((guint32)p[3] << 24);
+    return swap ? GUINT32_SWAP_LE_BE(v) : v;
+}
+
+static bool is_pcap(const uint8_t *data, gsize size) {
+    if (size < 24) return false;
+    guint32 magic = read32(data, false);
+    return magic == 0xa1b2c3d4 || magic == 0xd4c3b2a1 || magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+}
+
+// Primer byte de sync con otros dos a 188 y 376 bytes; -1 si no es MPEG-TS
+static gssize ts_start(const uint8_t *data, gsize size) {
+    for (gsize off = 0; off < kTsPacket && off + 3 * kTsPacket <= size; ++off)
+        if (data[off] == 0x47 && data[off + kTsPacket] == 0x47 && data[off + 2 * kTsPacket] == 0x47)
+            return (gssize)off;
+    return -1;
+}
+
+static FileSource::Format detect_format(const uint8_t *data, gsize size) {
+    if (!data) return FileSource::Format::UNKNOWN;
+    if (is_pcap(data, size)) return FileSource::Format::RTP;
+    if (ts_start(data, size) >= 0) return FileSource::Format::MPEGTS;
+    if (size >= 4 && data[0] == 0 && data[1] == 0 && (data[2] == 1 || (data[2] == 0 && data[3] == 1)))
+        return FileSource::Format::H264;
+    return FileSource::Format::UNKNOWN;
+}
+
+// ===== Índices =====
+
+// MPEG-TS: buffers de 7 paquetes, con la hora interpolada entre PCR de la primera PID que lo lleva
+static void index_ts(FileSource::Capture &c, const uint8_t *data, gsize size) {
+    gsize start = (gsize)ts_start(data, size);
+    gsize count = (size - start) / kTsPacket;
+
+    std::vector<std::pair<gsize, gint64>> pcrs;   // paquete, µs desde el primer PCR
+    int pcr_pid = -1;
+    gint64 last_pcr = -1, clock_us = 0;
+    for (gsize i = 0; i < count; ++i) {
+        const uint8_t *p = data + start + i * kTsPacket;
+        if (p[0] != 0x47 || !(p[3] & 0x20) || p[4] < 7 || !(p[5] & 0x10)) continue;
+        int pid = ((p[1] & 0x1F) << 8) | p[2];
+        if (pcr_pid < 0) pcr_pid = pid;
+        if (pid != pcr_pid) continue;
+
+        gint64 base = ((gint64)p[6] << 25) | (p[7] << 17) | (p[8] << 9) | (p[9] << 1) | (p[10] >> 7);
+        gint64 pcr_us = (base * 300 + (((p[10] & 1) << 8) | p[11])) / 27;
+        // Vuelta del reloj o empalme: el tiempo sigue sin saltar
+        if (last_pcr >= 0 && pcr_us > last_pcr && pcr_us - last_pcr < G_USEC_PER_SEC)
+            clock_us += pcr_us - last_pcr;
+        last_pcr = pcr_us;
+        pcrs.push_back({i, clock_us});
+    }
+
+    // Sin PCR utilizables se asume 4 Mbps
+    double us_per_packet = kTsPacket * 8.0 / 4.0;
+    if (pcrs.size() >= 2 && pcrs.back().first > pcrs.front().first && pcrs.back().second > 0)
+        us_per_packet = (double)pcrs.back().second / (pcrs.back().first - pcrs.front().first);
+    else
+        g_print("[FileSource] %s: sin PCR, se reproduce a 4 Mbps\n", c.path.c_str());
+
+    size_t k = 0;
+    for (gsize i = 0; i < count; i += kTsPerBuffer) {
+        while (k + 1 < pcrs.size() && pcrs[k + 1].first <= i) ++k;
+        gint64 t;
+        if (pcrs.size() < 2 || i <= pcrs.front().first) {
+            t = pcrs.size() < 2 ? (gint64)(i * us_per_packet) : 0;
+        } else if (k + 1 < pcrs.size()) {
+            const auto &a = pcrs[k], &b = pcrs[k + 1];
+            t = a.second + (b.second - a.second) * (gint64)(i - a.first) / (gint64)(b.first - a.first);
+        } else {
+            t = pcrs.back().second + (gint64)((i - pcrs.back().first) * us_per_packet);
+        }
+        gsize n = std::min(kTsPerBuffer, count - i);
+        c.units.push_back({start + i * kTsPacket, (guint)(n * kTsPacket), t});
+    }
+}
+
+// Capa de enlace -> IP -> UDP. Devuelve el payload UDP y su puerto de destino.
+static bool udp_payload(guint32 linktype, const uint8_t *p, gsize len, gsize *payload, gsize *payload_len, int *port) {
+    gsize ip = 0;
+    int ethertype = -1;   // -1: se deduce de la versión IP
+    switch (linktype) {
+        case 1: {         // Ethernet (con VLAN)
+            if (len < 14) return false;
+            gsize o = 12;
+            ethertype = be16(p + o);
+            while ((ethertype == 0x8100 || ethertype == 0x88A8) && o + 6 <= len) {
+                o += 4;
+                ethertype = be16(p + o);
+            }
+            ip = o + 2;
+            break;
+        }
+        case 113:         // Linux "cooked" (tcpdump -i any)
+            if (len < 16) return false;
+            ethertype = be16(p + 14);
+            ip = 16;
+            break;
+        case 276:         // Linux "cooked" v2
+            if (len < 20) return false;
+            ethertype = be16(p);
+            ip = 20;
+            break;
+        case 0:           // loopback BSD: familia en el orden de la máquina que capturó
+            ip = 4;
+            break;
+        case 12: case 101: case 228: case 229:   // IP sin enlace
+            break;
+        default:
+            return false;
+    }
+    if (ip >= len) return false;
+    int version = p[ip] >> 4;
+    if (ethertype == 0x0800) version = 4;
+    else if (ethertype == 0x86DD) version = 6;
+    else if (ethertype != -1) return false;
+
+    gsize udp, end = len;
+    if (version == 4) {
+        if (ip + 20 > len || p[ip + 9] != 17) return false;
+        if (be16(p + ip + 6) & 0x3FFF) return false;   // fragmentos
+        end = std::min(len, ip + be16(p + ip + 2));     // sin el relleno de Ethernet
+        udp = ip + (p[ip] & 0x0F) * 4;
+    } else if (version == 6) {
+        if (ip + 40 > len || p[ip + 6] != 17) return false;
+        end = std::min(len, ip + 40 + be16(p + ip + 4));
+        udp = ip + 40;
+    } else {
+        return false;
+    }
+    if (udp + 8 > end) return false;
+
+    guint16 udp_len = be16(p + udp + 4);
+    if (udp_len >= 8) end = std::min(end, udp + udp_len);
+    *port = be16(p + udp + 2);
+    *payload = udp + 8;
+    *payload_len = end - *payload;
+    return true;
+}
+
+// pcap: los paquetes RTP del primer puerto de destino, con su hora de captura
+static void index_pcap(FileSource::Capture &c, const uint8_t *data, gsize size) {
+    guint32 magic = read32(data, false);
+    bool swap = (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1);
+    bool nanos = (magic == 0xa1b23c4d || magic == 0x4d3cb2a1);
+    guint32 linktype = read32(data + 20, swap) & 0x0FFFFFFF;
+
+    int port = -1;
+    gint64 first = -1, last = 0;
+    gsize pos = 24;
+    while (pos + 16 <= size) {
+        gint64 t = (gint64)read32(data + pos, swap) * G_USEC_PER_SEC +
+                   (nanos ? read32(data + pos + 4, swap) / 1000 : read32(data + pos + 4, swap));
+        guint32 incl = read32(data + pos + 8, swap);
+        pos += 16;
+        if (incl > size - pos) break;   // captura cortada
+        const uint8_t *packet = data + pos;
+        pos += incl;
+
+        gsize offset, len;
+        int dst_port;
+        if (!udp_payload(linktype, packet, incl, &offset, &len, &dst_port)) continue;
+        const uint8_t *rtp = packet + offset;
+        if (len < 12 || (rtp[0] >> 6) != 2) continue;
+        int pt = rtp[1] & 0x7F;
+        if (pt >= 72 && pt <= 76) continue;   // RTCP
+        if (port < 0) port = dst_port;
+        if (dst_port != port) continue;
+
+        if (first < 0) first = t;
+        last = std::max(last, t - first);      // la hora de captura puede retroceder un poco
+        c.units.push_back({(gsize)(rtp - data), (guint)len, last});
+    }
+
+    if (port < 0) g_printerr("[FileSource] %s: sin paquetes RTP/UDP (enlace %u)\n", c.path.c_str(), linktype);
+    else g_print("[FileSource] %s: RTP al puerto %d\n", c.path.c_str(), port);
+}
+
+// H.264 Annex B: un buffer por frame (access unit), a MOSAIC_FILE_FPS
+static void index_h264(FileSource::Capture &c, const uint8_t *data, gsize size) {
+    const char *env = g_getenv("MOSAIC_FILE_FPS");
+    double fps = (env && atof(env) > 0) ? atof(env) : 30.0;
+
+    // Un frame empieza en un AUD, SPS, PPS o SEI, o en un slice con
+    // first_mb_in_slice = 0, siempre que el anterior ya tenga un slice
+    std::vector<gsize> starts{0};
+    bool has_slice = false;
+    gsize i = 2;
+    while (i < size) {
+        const uint8_t *one = static_cast<const uint8_t *>(memchr(data + i, 1, size - i));
+        if (!one) break;
+        i = (gsize)(one - data);
+        if (data[i - 1] != 0 || data[i - 2] != 0 || i + 1 >= size) {
+            ++i;
+            continue;
+        }
+        gsize code = (i >= 3 && data[i - 3] == 0) ? i - 3 : i - 2;
+        const uint8_t *nal = data + i + 1;
+        int type = nal[0] & 0x1F;
+        bool slice = (type == 1 || type == 5);
+        bool first_slice = slice && i + 2 < size && (nal[1] & 0x80);
+        if (has_slice && (first_slice || type == 6 || type == 7 || type == 8 || type == 9)) {
+            starts.push_back(code);
+            has_slice = false;
+        }
+        if (slice) has_slice = true;
+        i += 2;
+    }
+
+    for (size_t k = 0; k < starts.size(); ++k) {
+        gsize end = k + 1 < starts.size() ? starts[k + 1] : size;
+        c.units.push_back({starts[k], (guint)(end - starts[k]), (gint64)(k * 1e6 / fps)});
+    }
+}
+
+// ===== Archivos compartidos =====
+
+static std::shared_ptr<FileSource::Capture> load_capture(const std::string &path) {
+    GError *error = nullptr;
+    GMappedFile *file = g_mapped_file_new(path.c_str(), FALSE, &error);
+    if (!file) {
+        g_printerr("[FileSource] No se pudo abrir %s: %s\n", path.c_str(), error->message);
+        g_error_free(error);
+        return nullptr;
+    }
+
+    auto capture = std::make_shared<FileSource::Capture>();
+    capture->path = path;
+    capture->file = file;
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(g_mapped_file_get_contents(file));
+    gsize size = g_mapped_file_get_length(file);
+
+    gint64 start = g_get_monotonic_time();
+    capture->format = detect_format(data, size);
+    switch (capture->format) {
+        case FileSource::Format::MPEGTS: index_ts(*capture, data, size); break;
+        case FileSource::Format::RTP:    index_pcap(*capture, data, size); break;
+        case FileSource::Format::H264:   index_h264(*capture, data, size); break;
+        default: break;
+    }
+    if (capture->units.empty()) {
+        g_printerr("[FileSource] %s: formato no reconocido o sin contenido\n", path.c_str());
+        return nullptr;
+    }
+
+    // Entre la última unidad y la repetición de la primera, el paso promedio
+    const std::vector<Unit> &units = capture->units;
+    gint64 span = units.back().time_us - units.front().time_us;
+    capture->duration_us = units.back().time_us + (units.size() > 1 ? span / (gint64)(units.size() - 1) : 0);
+
+    g_print("[FileSource] %s: %s, %zu buffers, %.1f s por vuelta, %.1f MB mapeados (índice en %.0f ms)\n",
+            path.c_str(), FileSource::format_name(capture->format), units.size(),
+            capture->duration_us / 1e6, size / 1048576.0, (g_get_monotonic_time() - start) / 1000.0);
+    return capture;
+}
+
+// Un mapeo por ruta mientras algún slot lo use
+static std::shared_ptr<FileSource::Capture> open_capture(const std::string &path) {
+    static GMutex lock;
+    static std::map<std::string, std::weak_ptr<FileSource::Capture>> open;
+
+    g_mutex_lock(&lock);
+    for (auto it = open.begin(); it != open.end();)
+        it = it->second.expired() ? open.erase(it) : std::next(it);
+    std::shared_ptr<FileSource::Capture> capture = open.count(path) ? open[path].lock() : nullptr;
+    if (!capture) {
+        capture = load_capture(path);
+        if (capture) open[path] = capture;
+    }
+    g_mutex_unlock(&lock);
+    return capture;
+}
+
+// ===== FileSource =====
+
+FileSource::FileSource() {
+    g_mutex_init(&lock);
+    g_cond_init(&wake);
+}
+
+FileSource::~FileSource() {
+    stop();
+    g_cond_clear(&wake);
+    g_mutex_clear(&lock);
+}
+
+FileSource::Format FileSource::probe(const std::string &path) {
+    GMappedFile *file = g_mapped_file_new(path.c_str(), FALSE, NULL);
+    if (!file) return Format::UNKNOWN;
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(g_mapped_file_get_contents(file));
+    gsize size = g_mapped_file_get_length(file);
+    Format format = detect_format(data, size);
+    if (format == Format::UNKNOWN && size >= 4 && read32(data, false) == 0x0A0D0D0A)
+        g_printerr("[FileSource] %s es pcapng: convertir a pcap (editcap -F pcap)\n", path.c_str());
+    g_mapped_file_unref(file);
+    return format;
+}
+
+const char* FileSource::format_name(Format format) {
+    switch (format) {
+        case Format::MPEGTS: return "MPEG-TS";
+        case Format::RTP:    return "RTP (pcap)";
+        case Format::H264:   return "H.264";
+        default:             return "desconocido";
+    }
+}
+
+FileSource* FileSource::attach(GstElement *pipeline, const std::string &name, const std::string &path, bool realtime) {
+    if (!pipeline || path.empty()) return nullptr;
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name.c_str());
+    if (!element) return nullptr;
+
+    FileSource *source = nullptr;
+    if (strcmp(G_OBJECT_TYPE_NAME(element), "GstAppSrc") == 0) {
+        source = new FileSource();
+        if (!source->start(element, path, realtime)) {
+            delete source;
+            source = nullptr;
+        }
+    }
+    gst_object_unref(element);
+    return source;
+}
+
+bool FileSource::start(GstElement *src, const std::string &file_path, bool pace_realtime) {
+    stop();
+    path = file_path;
+    realtime = pace_realtime;
+    appsrc = GST_ELEMENT(gst_object_ref(src));
+    stopping = false;
+    // Mapear e indexar puede tardar con archivos grandes: lo hace el hilo
+    thread = g_thread_new("file-source", &FileSource::thread_func, this);
+    return true;
+}
+
+void FileSource::stop() {
+    if (thread) {
+        g_mutex_lock(&lock);
+        stopping = true;
+        g_cond_signal(&wake);
+        g_mutex_unlock(&lock);
+        g_thread_join(thread);
+        thread = nullptr;
+    }
+    if (appsrc) gst_object_unref(appsrc);
+    appsrc = nullptr;
+}
+
+FileSource::Stats FileSource::stats() const {
+    Stats s;
+    s.units = units.load(std::memory_order_relaxed);
+    s.bytes = bytes.load(std::memory_order_relaxed);
+    s.loops = loops.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool FileSource::wait_until(gint64 deadline_us) {
+    g_mutex_lock(&lock);
+    while (!stopping && g_get_monotonic_time() < deadline_us) {
+        if (!g_cond_wait_until(&wake, &lock, deadline_us)) break;
+    }
+    bool running = !stopping;
+    g_mutex_unlock(&lock);
+    return running;
+}
+
+gpointer FileSource::thread_func(gpointer data) {
+    static_cast<FileSource *>(data)->run();
+    return NULL;
+}
+
+void FileSource::run() {
+    // Hilo creado desde GTK: no heredar su núcleo fijo
+    DecoderScheduler::instance().release_current_thread();
+
+    std::shared_ptr<Capture> capture = open_capture(path);
+    if (!capture) return;
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(g_mapped_file_get_contents(capture->file));
+    const std::vector<Unit> &list = capture->units;
+
+    gint64 base = g_get_monotonic_time();
+    size_t i = 0;
+    bool discont = false;
+    while (true) {
+        if (i == list.size()) {
+            i = 0;
+            base += capture->duration_us;
+            loops.fetch_add(1, std::memory_order_relaxed);
+            discont = true;
+        }
+        const Unit &unit = list[i];
+
+        // A ritmo real se espera la hora de la unidad; sin ritmo solo se mira stop()
+        gint64 due = realtime ? base + unit.time_us : 0;
+        if (realtime && g_get_monotonic_time() - due > kMaxLagUs) {
+            base = g_get_monotonic_time() - unit.time_us;
+            due = base + unit.time_us;
+        }
+        if (!wait_until(due)) break;
+
+        guint64 level = 0;
+        g_object_get(appsrc, "current-level-bytes", &level, NULL);
+        if (level > kMaxQueueBytes) {
+            if (!wait_until(g_get_monotonic_time() + 2000)) break;
+            continue;
+        }
+
+        // El buffer apunta al mapeo y lo mantiene vivo mientras esté en el pipeline
+        GstBuffer *buffer = gst_buffer_new_wrapped_full(GST_MEMORY_FLAG_READONLY,
+                                                        const_cast<uint8_t *>(data + unit.offset), unit.size,
+                                                        0, unit.size, g_mapped_file_ref(capture->file),
+                                                        (GDestroyNotify)g_mapped_file_unref);
+        if (discont) {
+            GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+            discont = false;
+        }
+        GstFlowReturn ret;
+        g_signal_emit_by_name(appsrc, "push-buffer", buffer, &ret);
+        gst_buffer_unref(buffer);
+
+        units.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(unit.size, std::memory_order_relaxed);
+        ++i;
+    }
+}
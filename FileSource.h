@@ -0,0 +1,67 @@
+#ifndef FILESOURCE_H
+#define FILESOURCE_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <string>
+
+// Fuente de un slot desde un archivo grabado, para pruebas repetibles sin
+// red: MPEG-TS, captura RTP (pcap) o H.264 crudo (Annex B), en bucle, hacia
+// el appsrc "filesrc" del pipeline. A ritmo real sigue los tiempos del
+// archivo (PCR, hora de captura o MOSAIC_FILE_FPS); sin ritmo entrega tan
+// rápido como el pipeline acepta. El archivo se mapea e indexa una sola vez
+// y todos los slots que lo reproducen comparten el mapeo: los buffers
+// apuntan a él, sin copias.
+class FileSource {
+public:
+    enum class Format { UNKNOWN, MPEGTS, RTP, H264 };
+
+    struct Stats {
+        guint64 units = 0;      // paquetes TS/RTP o frames H.264 entregados
+        guint64 bytes = 0;
+        guint loops = 0;        // vueltas completas al archivo
+    };
+
+    // Archivo mapeado e indexado (compartido entre slots)
+    struct Capture;
+
+    FileSource();
+    ~FileSource();
+
+    // Formato según el contenido (sync 0x47, cabecera pcap, start code)
+    static Format probe(const std::string &path);
+    static const char* format_name(Format format);
+
+    // Si el elemento name del pipeline es un appsrc, abre (o reutiliza) el
+    // archivo y arranca la entrega. Si no, o si el archivo no sirve, nullptr.
+    static FileSource* attach(GstElement *pipeline, const std::string &name, const std::string &path, bool realtime);
+
+    bool start(GstElement *appsrc, const std::string &path, bool realtime);
+    // Despierta al hilo (también si espera lugar en el appsrc) y lo espera
+    void stop();
+
+    // Hilo principal
+    Stats stats() const;
+
+private:
+    std::string path;
+    GstElement* appsrc = nullptr;
+    GThread* thread = nullptr;
+    bool realtime = true;
+
+    GMutex lock;
+    GCond wake;
+    bool stopping = false;   // protegido por lock
+
+    std::atomic<guint64> units{0};
+    std::atomic<guint64> bytes{0};
+    std::atomic<guint> loops{0};
+
+    // Espera hasta deadline_us (reloj monótono); false si se pidió stop()
+    bool wait_until(gint64 deadline_us);
+    void run();
+
+    static gpointer thread_func(gpointer data);
+};
+
+#endif // FILESOURCE_H
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstring>
+#include "FrameCheck.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAMECHECK_X86 1
+#include <immintrin.h>
+#endif
+
+namespace FrameCheck {
+
+// Rango limitado: negro es 16. El ruido de compresión de una imagen lisa
+// deja la desviación en 1-2 niveles; una escena real pasa de 20.
+static const double kBlackMean = 24.0;
+static const double kBlackVariance = 16.0;   // desviación < 4
+static const double kFlatVariance = 9.0;     // desviación < 3
+
+// Suma y suma de cuadrados de n bytes (se acumulan en sum y sq)
+using SumFn = void (*)(const uint8_t *p, int n, uint64_t *sum, uint64_t *sq);
+
+static void sums_scalar(const uint8_t *p, int n, uint64_t *sum, uint64_t *sq) {
+    uint32_t s = 0;
+    uint64_t q = 0;
+    for (int x = 0; x < n; ++x) {
+        s += p[x];
+        q += (uint32_t)p[x] * p[x];
+    }
+    *sum += s;
+    *sq += q;
+}
+
+#ifdef FRAMECHECK_X86
+// 16 bytes por iteración: psadbw para la suma, pmaddwd para los cuadrados
+static void sums_sse2(const uint8_t *p, int n, uint64_t *sum, uint64_t *sq) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i s = zero;
+
+    int x = 0;
+    while (x + 16 <= n) {
+        // Los carriles de 32 bits se vuelcan antes de poder desbordar
+        int end = x + std::min((n - x) & ~15, 16 * 8192);
+        __m128i q = zero;
+        for (; x < end; x += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + x));
+            s = _mm_add_epi64(s, _mm_sad_epu8(v, zero));
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            q = _mm_add_epi32(q, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, q);
+        *sq += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+
+    uint64_t halves[2];
+    _mm_storeu_si128((__m128i *)halves, s);
+    *sum += halves[0] + halves[1];
+    sums_scalar(p + x, n - x, sum, sq);
+}
+
+// 32 bytes por iteración
+__attribute__((target("avx2")))
+static void sums_avx2(const uint8_t *p, int n, uint64_t *sum, uint64_t *sq) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i s = zero;
+
+    int x = 0;
+    while (x + 32 <= n) {
+        int end = x + std::min((n - x) & ~31, 32 * 8192);
+        __m256i q = zero;
+        for (; x < end; x += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(p + x));
+            s = _mm256_add_epi64(s, _mm256_sad_epu8(v, zero));
+            __m256i lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v));
+            __m256i hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1));
+            q = _mm256_add_epi32(q, _mm256_add_epi32(_mm256_madd_epi16(lo, lo), _mm256_madd_epi16(hi, hi)));
+        }
+        uint32_t lanes[8];
+        _mm256_storeu_si256((__m256i *)lanes, q);
+        for (uint32_t lane : lanes) *sq += lane;
+    }
+
+    uint64_t quarters[4];
+    _mm256_storeu_si256((__m256i *)quarters, s);
+    *sum += quarters[0] + quarters[1] + quarters[2] + quarters[3];
+
+    // El resto aquí mismo (VEX): saltar a código SSE sin vzeroupper cuesta más que el bucle
+    if (x + 16 <= n) {
+        const __m128i zero128 = _mm_setzero_si128();
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + x));
+        __m128i lo = _mm_unpacklo_epi8(v, zero128);
+        __m128i hi = _mm_unpackhi_epi8(v, zero128);
+        __m128i q = _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi));
+        uint64_t halves[2];
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i *)halves, _mm_sad_epu8(v, zero128));
+        _mm_storeu_si128((__m128i *)lanes, q);
+        *sum += halves[0] + halves[1];
+        *sq += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        x += 16;
+    }
+    for (; x < n; ++x) {
+        *sum += p[x];
+        *sq += (uint32_t)p[x] * p[x];
+    }
+}
+#endif
+
+static SumFn select_sum_fn() {
+#ifdef FRAMECHECK_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return sums_avx2;
+    if (__builtin_cpu_supports("sse2")) return sums_sse2;
+#endif
+    return sums_scalar;
+}
+
+static SumFn best_sum_fn() {
+    static const SumFn fn = select_sum_fn();
+    return fn;
+}
+
+// Una fila de cada kRowStep, cortada en los kGrid bloques de su franja
+static void analyze_with(SumFn fn, const uint8_t *y, int stride, int width, int height, LumaStats *out) {
+    *out = LumaStats();
+    if (!y || width < kGrid || height < kGrid) return;
+
+    int bx[kGrid + 1];
+    for (int i = 0; i <= kGrid; ++i) bx[i] = (int)((int64_t)width * i / kGrid);
+
+    uint64_t total = 0, total_sq = 0, count = 0;
+    for (int row = 0; row < height; row += kRowStep) {
+        const uint8_t *line = y + (size_t)row * stride;
+        uint32_t *blocks = out->blocks + (int)((int64_t)row * kGrid / height) * kGrid;
+        for (int c = 0; c < kGrid; ++c) {
+            uint64_t sum = 0;
+            fn(line + bx[c], bx[c + 1] - bx[c], &sum, &total_sq);
+            blocks[c] += (uint32_t)sum;
+            total += sum;
+        }
+        count += width;
+    }
+
+    out->mean = (double)total / count;
+    out->variance = std::max(0.0, (double)total_sq / count - out->mean * out->mean);
+}
+
+void analyze(const uint8_t *y, int stride, int width, int height, LumaStats *out) {
+    analyze_with(best_sum_fn(), y, stride, width, height, out);
+}
+
+void analyze_scalar(const uint8_t *y, int stride, int width, int height, LumaStats *out) {
+    analyze_with(sums_scalar, y, stride, width, height, out);
+}
+
+bool is_black(const LumaStats &stats) {
+    return stats.mean < kBlackMean && stats.variance < kBlackVariance;
+}
+
+bool is_flat(const LumaStats &stats) {
+    return stats.variance < kFlatVariance;
+}
+
+bool same_picture(const LumaStats &a, const LumaStats &b) {
+    return memcmp(a.blocks, b.blocks, sizeof(a.blocks)) == 0;
+}
+
+const char* active_kernel() {
+    SumFn fn = best_sum_fn();
+#ifdef FRAMECHECK_X86
+    if (fn == sums_avx2) return "avx2";
+    if (fn == sums_sse2) return "sse2";
+#endif
+    return fn == sums_scalar ? "scalar" : "?";
+}
+
+} // namespace FrameCheck
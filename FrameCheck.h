@@ -0,0 +1,38 @@
+#ifndef FRAMECHECK_H
+#define FRAMECHECK_H
+
+#include <cstdint>
+
+// Firma del contenido de un frame a partir de su plano de luma: suma exacta
+// por bloque en una grilla de 8x8 (una fila de cada 4) más media y varianza.
+// Barata (SSE2/AVX2, ~0.5 Mpíxel por frame 1080p) para que el watchdog
+// distinga una imagen congelada, negra o de un color fijo aunque sigan
+// llegando buffers.
+namespace FrameCheck {
+
+    enum { kGrid = 8, kBlocks = kGrid * kGrid, kRowStep = 4 };
+
+    struct LumaStats {
+        double mean = 0.0;
+        double variance = 0.0;
+        uint32_t blocks[kBlocks] = {};   // suma de luma muestreada por bloque
+    };
+
+    // Plano de luma de 8 bits (width x height, stride en bytes)
+    void analyze(const uint8_t *y, int stride, int width, int height, LumaStats *out);
+    // Igual, forzando la versión escalar (referencia y benchmark)
+    void analyze_scalar(const uint8_t *y, int stride, int width, int height, LumaStats *out);
+
+    // Negro (luma de rango limitado cerca de 16, sin detalle)
+    bool is_black(const LumaStats &stats);
+    // Un solo color: sin detalle, con cualquier brillo
+    bool is_flat(const LumaStats &stats);
+    // Mismo frame: un decoder que repite la imagen da sumas idénticas; el
+    // ruido de una cámara real las cambia aunque la escena esté quieta
+    bool same_picture(const LumaStats &a, const LumaStats &b);
+
+    // "avx2", "sse2" o "scalar"
+    const char* active_kernel();
+}
+
+#endif // FRAMECHECK_H
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include "HealthMonitor.h"
+#include "Watchdog.h"
+
+HealthMonitor& HealthMonitor::instance() {
+    static HealthMonitor monitor;
+    return monitor;
+}
+
+void HealthMonitor::add(Watchdog *wd) {
+    if (std::find(watchdogs.begin(), watchdogs.end(), wd) == watchdogs.end())
+        watchdogs.push_back(wd);
+    ensure_timer();
+}
+
+void HealthMonitor::remove(Watchdog *wd) {
+    watchdogs.erase(std::remove(watchdogs.begin(), watchdogs.end(), wd), watchdogs.end());
+
+    // Sin slots que vigilar no hace falta despertar el main loop
+    if (watchdogs.empty() && source_id) {
+        g_source_remove(source_id);
+        source_id = 0;
+    }
+}
+
+void HealthMonitor::set_tick_interval(guint ms) {
+    tick_ms = std::max(10u, ms);
+    if (source_id) {
+        g_source_remove(source_id);
+        source_id = 0;
+    }
+    ensure_timer();
+}
+
+void HealthMonitor::ensure_timer() {
+    if (source_id || watchdogs.empty()) return;
+    source_id = g_timeout_add(tick_ms, &HealthMonitor::on_tick, this);
+}
+
+gboolean HealthMonitor::on_tick(gpointer data) {
+    static_cast<HealthMonitor *>(data)->tick();
+    return G_SOURCE_CONTINUE;
+}
+
+void HealthMonitor::tick() {
+    gint64 now = g_get_monotonic_time();
+
+    // Primero revisar todos, luego notificar en bloque
+    std::vector<Watchdog*> changed;
+    std::vector<Watchdog*> content_changed;
+    for (Watchdog *wd : watchdogs) {
+        if (wd->check(now)) changed.push_back(wd);
+        if (wd->check_content()) content_changed.push_back(wd);
+    }
+
+    for (Watchdog *wd : changed) {
+        // Un callback previo pudo haber detenido este watchdog
+        if (std::find(watchdogs.begin(), watchdogs.end(), wd) == watchdogs.end()) continue;
+        if (wd->callback) wd->callback(wd->stalled);
+    }
+    for (Watchdog *wd : content_changed) {
+        if (std::find(watchdogs.begin(), watchdogs.end(), wd) == watchdogs.end()) continue;
+        if (wd->content_callback) wd->content_callback(wd->content_state);
+    }
+}
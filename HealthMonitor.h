@@ -0,0 +1,34 @@
+#ifndef HEALTHMONITOR_H
+#define HEALTHMONITOR_H
+
+#include <glib.h>
+#include <vector>
+
+class Watchdog;
+
+// Monitor único para todos los slots: un GSource de timeout en el main
+// context reemplaza a los hilos por slot. Las notificaciones se agrupan por
+// tick y siempre corren en el hilo de GTK.
+class HealthMonitor {
+public:
+    static HealthMonitor& instance();
+
+    void add(Watchdog *wd);
+    void remove(Watchdog *wd);
+
+    // Periodo de revisión (permite detección por debajo del segundo)
+    void set_tick_interval(guint ms);
+
+private:
+    HealthMonitor() = default;
+
+    static gboolean on_tick(gpointer data);
+    void tick();
+    void ensure_timer();
+
+    std::vector<Watchdog*> watchdogs;
+    guint tick_ms = 100;
+    guint source_id = 0;
+};
+
+#endif // HEALTHMONITOR_H
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cstdlib>
+#include "JitterController.h"
+
+// Latencia necesaria según el jitter: varias veces el promedio más un margen
+static const double kJitterFactor = 4.0;
+static const double kMarginMs = 5.0;
+// Segundos sin paquetes tarde antes de empezar a bajar la latencia
+static const int kQuietTicks = 10;
+
+static double env_double(const char *name, double fallback) {
+    const char *value = g_getenv(name);
+    return value ? atof(value) : fallback;
+}
+
+static guint min_latency_ms() {
+    static guint ms = (guint)std::max(1.0, env_double("MOSAIC_JITTER_MIN_MS", 10));
+    return ms;
+}
+
+static guint max_latency_ms() {
+    static guint ms = (guint)std::max((double)min_latency_ms(), env_double("MOSAIC_JITTER_MAX_MS", 1000));
+    return ms;
+}
+
+static double target_late_pct() {
+    static double pct = env_double("MOSAIC_JITTER_TARGET_LATE", 0.1);
+    return pct;
+}
+
+static guint clamp_latency(double ms) {
+    return (guint)std::min<double>(max_latency_ms(), std::max<double>(min_latency_ms(), ms));
+}
+
+JitterController::JitterController() {}
+
+JitterController::~JitterController() {
+    detach();
+}
+
+void JitterController::attach(GstElement *pipeline, const std::string &name) {
+    detach();
+    jbuf = pipeline && !name.empty() ? gst_bin_get_by_name(GST_BIN(pipeline), name.c_str()) : nullptr;
+    if (!jbuf) return;
+
+    // Arranca con la latencia del pipeline (la de cada modo), dentro de los límites
+    guint initial = 0;
+    g_object_get(jbuf, "latency", &initial, NULL);
+    latency_ms = 0;
+    floor_ms = 0.0;
+    jitter_ms = late_pct = 0.0;
+    quiet_ticks = 0;
+    last_pushed = last_late = last_lost = 0;
+    apply(clamp_latency(initial));
+    target_ms = latency_ms;
+
+    timer_id = g_timeout_add_seconds(1, &JitterController::on_timeout, this);
+}
+
+void JitterController::detach() {
+    if (timer_id) g_source_remove(timer_id);
+    timer_id = 0;
+    if (jbuf) gst_object_unref(jbuf);
+    jbuf = nullptr;
+}
+
+JitterController::Status JitterController::status() const {
+    Status s;
+    s.active = jbuf != nullptr;
+    s.latency_ms = latency_ms;
+    s.target_ms = target_ms;
+    s.jitter_ms = jitter_ms;
+    s.late_pct = late_pct;
+    return s;
+}
+
+gboolean JitterController::on_timeout(gpointer data) {
+    static_cast<JitterController *>(data)->tick();
+    return G_SOURCE_CONTINUE;
+}
+
+void JitterController::apply(guint ms) {
+    if (ms == latency_ms) return;
+    latency_ms = ms;
+    g_object_set(jbuf, "latency", ms, NULL);
+}
+
+void JitterController::tick() {
+    GstStructure *stats = nullptr;
+    g_object_get(jbuf, "stats", &stats, NULL);
+    if (!stats) return;
+
+    guint64 pushed = 0, late = 0, lost = 0, avg_jitter_ns = 0;
+    gst_structure_get_uint64(stats, "num-pushed", &pushed);
+    gst_structure_get_uint64(stats, "num-late", &late);
+    gst_structure_get_uint64(stats, "num-lost", &lost);
+    bool has_jitter = gst_structure_get_uint64(stats, "avg-jitter", &avg_jitter_ns);
+    gst_structure_free(stats);
+
+    guint64 d_pushed = pushed - last_pushed;
+    guint64 d_late = late - last_late;
+    guint64 d_lost = lost - last_lost;
+    last_pushed = pushed;
+    last_late = late;
+    last_lost = lost;
+    // Sin tráfico no hay nada que medir
+    if (d_pushed == 0) return;
+
+    if (has_jitter) jitter_ms = avg_jitter_ns / 1e6;
+    late_pct = 100.0 * (d_late + d_lost) / (double)(d_pushed + d_lost);
+
+    // Solo los paquetes tarde se arreglan con más latencia; los perdidos en la
+    // red no llegan nunca y subirla solo agregaría demora
+    double late_only_pct = 100.0 * d_late / (double)d_pushed;
+    if (late_only_pct > target_late_pct()) {
+        floor_ms = std::min<double>(max_latency_ms(), std::max(floor_ms, latency_ms * 1.5 + kMarginMs));
+        quiet_ticks = 0;
+    } else if (++quiet_ticks > kQuietTicks) {
+        floor_ms *= 0.95;
+    }
+
+    target_ms = clamp_latency(std::max(kJitterFactor * jitter_ms + kMarginMs, floor_ms));
+
+    if (target_ms > latency_ms) {
+        // Subir de una vez: cada segundo con la latencia corta son frames rotos
+        g_print("[Jitter] %s: latencia %u -> %u ms (jitter %.1f ms, tarde %.2f%%)\n",
+                label.c_str(), latency_ms, target_ms, jitter_ms, late_only_pct);
+        apply(target_ms);
+    } else if (target_ms + 2 < latency_ms && quiet_ticks > kQuietTicks) {
+        // Bajar de a poco: el jitterbuffer entrega de golpe lo que retenía de más
+        guint step = std::max(2u, latency_ms / 10);
+        apply(std::max(target_ms, latency_ms - step));
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef JITTERCONTROLLER_H
+#define JITTERCONTROLLER_H
+
+#include <gst/gst.h>
+#include <string>
+
+// Latencia adaptativa del rtpjitterbuffer ("jbuf") de un slot UDP (hilo
+// principal). Cada segundo lee las estadísticas del jitterbuffer y busca la
+// latencia más baja que mantiene los paquetes tarde por debajo del objetivo:
+// sube enseguida ante paquetes tarde o más jitter, y baja de a poco después
+// de un rato sin problemas. Siempre dentro de los límites configurados:
+//
+//   MOSAIC_JITTER_MIN_MS      latencia mínima (por defecto 10)
+//   MOSAIC_JITTER_MAX_MS      latencia máxima (por defecto 1000)
+//   MOSAIC_JITTER_TARGET_LATE paquetes tarde tolerados, en % (por defecto 0.1)
+class JitterController {
+public:
+    struct Status {
+        bool active = false;
+        guint latency_ms = 0;       // aplicada al jitterbuffer
+        guint target_ms = 0;        // a la que se está yendo
+        double jitter_ms = 0.0;     // jitter promedio según el jitterbuffer
+        double late_pct = 0.0;      // tarde + perdidos del último intervalo
+    };
+
+    JitterController();
+    ~JitterController();
+
+    void set_label(const std::string &text) { label = text; }
+
+    // Pipeline nuevo: toma su jitterbuffer (si tiene) y arranca el timer.
+    // En standby, name es el de la rama activa.
+    void attach(GstElement *pipeline, const std::string &name = "jbuf");
+    void detach();
+
+    Status status() const;
+
+private:
+    std::string label;
+    GstElement* jbuf = nullptr;
+    guint timer_id = 0;
+
+    guint latency_ms = 0;
+    guint target_ms = 0;
+    double floor_ms = 0.0;      // exigido por los últimos paquetes tarde
+    double jitter_ms = 0.0;
+    double late_pct = 0.0;
+    int quiet_ticks = 0;        // segundos seguidos sin paquetes tarde
+
+    guint64 last_pushed = 0;
+    guint64 last_late = 0;
+    guint64 last_lost = 0;
+
+    void tick();
+    void apply(guint ms);
+
+    static gboolean on_timeout(gpointer data);
+};
+
+#endif // JITTERCONTROLLER_H
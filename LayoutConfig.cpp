@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "LayoutConfig.h"
+
+// Límite de slots simultáneos (tiles del MosaicRenderer)
+static const int kMaxTiles = 64;
+
+// Filas/columnas del layout = caja que contiene a todas sus celdas
+static void fit_grid(Layout &layout) {
+    for (const LayoutTile &t : layout.tiles) {
+        layout.cols = std::max(layout.cols, t.col + t.width);
+        layout.rows = std::max(layout.rows, t.row + t.height);
+    }
+}
+
+LayoutConfig LayoutConfig::builtin() {
+    LayoutConfig config;
+    for (int i = 0; i < 6; ++i) {
+        std::string n = std::to_string(i + 1);
+        config.sources.push_back({"stream" + n, "live.sls.com/live/stream" + n, std::to_string(5000 + i)});
+    }
+
+    // Mismas posiciones que el grid original: (columna, fila)
+    const int posiciones[6][2] = {{0, 0}, {0, 1}, {1, 0}, {1, 1}, {2, 0}, {2, 1}};
+    for (int count = 1; count <= 6; ++count) {
+        Layout layout;
+        layout.name = std::to_string(count);
+        for (int i = 0; i < count; ++i) {
+            LayoutTile tile;
+            tile.col = posiciones[i][0];
+            tile.row = posiciones[i][1];
+            tile.source = config.sources[i].name;
+            layout.tiles.push_back(tile);
+        }
+        fit_grid(layout);
+        config.layouts.push_back(layout);
+    }
+    return config;
+}
+
+LayoutConfig LayoutConfig::load_default() {
+    const char *env = g_getenv("MOSAIC_LAYOUT_FILE");
+    std::string path = (env && *env) ? env : "mosaic_layouts.ini";
+    if (!g_file_test(path.c_str(), G_FILE_TEST_EXISTS)) {
+        if (env && *env) g_printerr("[LayoutConfig] No existe %s, uso los layouts por defecto\n", path.c_str());
+        return builtin();
+    }
+
+    LayoutConfig config;
+    GError *error = nullptr;
+    if (!config.load_file(path, &error)) {
+        g_printerr("[LayoutConfig] Error en %s: %s. Uso los layouts por defecto\n",
+                   path.c_str(), error ? error->message : "?");
+        if (error) g_error_free(error);
+        return builtin();
+    }
+
+    g_print("[LayoutConfig] %s: %zu fuentes, %zu layouts\n",
+            path.c_str(), config.sources.size(), config.layouts.size());
+    return config;
+}
+
+// "col,fila" o "col,fila,ancho,alto"
+static bool parse_tile(const char *spec, LayoutTile &tile) {
+    int c, r, w = 1, h = 1;
+    int n = sscanf(spec, " %d , %d , %d , %d", &c, &r, &w, &h);
+    if (n != 2 && n != 4) return false;
+    if (c < 0 || r < 0 || w < 1 || h < 1) return false;
+    tile.col = c;
+    tile.row = r;
+    tile.width = w;
+    tile.height = h;
+    return true;
+}
+
+bool LayoutConfig::load_file(const std::string &path, GError **error) {
+    GKeyFile *file = g_key_file_new();
+    if (!g_key_file_load_from_file(file, path.c_str(), G_KEY_FILE_NONE, error)) {
+        g_key_file_free(file);
+        return false;
+    }
+
+    sources.clear();
+    layouts.clear();
+    bool ok = true;
+
+    // [sources] nombre=streamid;puerto[;ssrc=N|pt=N], nombre=file:ruta y nombre@alto=streamid;puerto
+    gchar **keys = g_key_file_get_keys(file, "sources", NULL, NULL);
+    for (gchar **k = keys; k && *k; ++k) {
+        gsize len = 0;
+        gchar **values = g_key_file_get_string_list(file, "sources", *k, &len, NULL);
+        if (strchr(*k, '@')) {
+            g_strfreev(values);
+            continue;
+        }
+        SourceDesc source;
+        source.name = *k;
+        if (len > 0) source.streamid = g_strstrip(values[0]);
+        if (len > 1) source.port = g_strstrip(values[1]);
+        if (len > 2) source.rtp = g_strstrip(values[2]);
+        take_file_source(source);
+        sources.push_back(source);
+        g_strfreev(values);
+    }
+
+    // Variantes: después, porque la fuente puede aparecer más abajo en el archivo
+    for (gchar **k = keys; k && *k; ++k) {
+        const char *at = strchr(*k, '@');
+        if (!at) continue;
+        std::string base(*k, at - *k);
+        SourceVariant variant;
+        variant.height = atoi(at + 1);
+
+        SourceDesc *source = nullptr;
+        for (SourceDesc &s : sources)
+            if (s.name == base) source = &s;
+        if (!source || variant.height <= 0) {
+            g_printerr("[LayoutConfig] Variante inválida: %s\n", *k);
+            continue;
+        }
+
+        gsize len = 0;
+        gchar **values = g_key_file_get_string_list(file, "sources", *k, &len, NULL);
+        if (len > 0) variant.streamid = g_strstrip(values[0]);
+        if (len > 1) variant.port = g_strstrip(values[1]);
+        g_strfreev(values);
+        source->variants.push_back(variant);
+    }
+    g_strfreev(keys);
+    for (SourceDesc &s : sources) {
+        std::sort(s.variants.begin(), s.variants.end(),
+                  [](const SourceVariant &a, const SourceVariant &b) { return a.height < b.height; });
+    }
+
+    // [layout NOMBRE] en el orden del archivo
+    gchar **groups = g_key_file_get_groups(file, NULL);
+    for (gchar **g = groups; ok && g && *g; ++g) {
+        if (!g_str_has_prefix(*g, "layout ")) continue;
+
+        Layout layout;
+        gchar *name = g_strstrip(g_strdup(*g + strlen("layout ")));
+        layout.name = name;
+        g_free(name);
+
+        gchar *grid = g_key_file_get_string(file, *g, "grid", NULL);
+        gchar **tiles = g_key_file_get_string_list(file, *g, "tiles", NULL, NULL);
+        if (grid) {
+            int cols = 0, rows = 0;
+            if (sscanf(grid, "%dx%d", &cols, &rows) != 2 || cols < 1 || rows < 1) {
+                g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                            "[%s] grid inválido: %s", *g, grid);
+                ok = false;
+            }
+            for (int r = 0; ok && r < rows; ++r)
+                for (int c = 0; c < cols; ++c) {
+                    LayoutTile tile;
+                    tile.col = c;
+                    tile.row = r;
+                    layout.tiles.push_back(tile);
+                }
+        } else if (tiles) {
+            for (gchar **t = tiles; ok && *t; ++t) {
+                LayoutTile tile;
+                if (!parse_tile(*t, tile)) {
+                    g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_INVALID_VALUE,
+                                "[%s] celda inválida: %s", *g, *t);
+                    ok = false;
+                }
+                layout.tiles.push_back(tile);
+            }
+        }
+        g_free(grid);
+        g_strfreev(tiles);
+        if (!ok) break;
+
+        layout.cols = g_key_file_get_integer(file, *g, "cols", NULL);
+        layout.rows = g_key_file_get_integer(file, *g, "rows", NULL);
+        fit_grid(layout);
+
+        // Fuentes de cada celda: explícitas o en el orden de [sources]
+        gsize n_names = 0;
+        gchar **names = g_key_file_get_string_list(file, *g, "sources", &n_names, NULL);
+        for (size_t i = 0; i < layout.tiles.size(); ++i) {
+            if (names) {
+                if (i < n_names) layout.tiles[i].source = g_strstrip(names[i]);
+            } else if (i < sources.size()) {
+                layout.tiles[i].source = sources[i].name;
+            }
+        }
+        g_strfreev(names);
+
+        // Celdas sin fuente conocida: se descartan con aviso
+        std::vector<LayoutTile> valid;
+        for (const LayoutTile &t : layout.tiles) {
+            if (find_source(t.source)) valid.push_back(t);
+            else g_printerr("[LayoutConfig] [%s] celda %d,%d sin fuente válida ('%s')\n",
+                            *g, t.col, t.row, t.source.c_str());
+        }
+        layout.tiles = valid;
+
+        if ((int)layout.tiles.size() > kMaxTiles) {
+            g_printerr("[LayoutConfig] [%s] más de %d celdas, se recorta\n", *g, kMaxTiles);
+            layout.tiles.resize(kMaxTiles);
+        }
+        if (!layout.tiles.empty()) layouts.push_back(layout);
+    }
+    g_strfreev(groups);
+
+    if (ok && layouts.empty()) {
+        g_set_error(error, G_KEY_FILE_ERROR, G_KEY_FILE_ERROR_GROUP_NOT_FOUND,
+                    "no hay ningún [layout ...] válido");
+        ok = false;
+    }
+
+    if (ok) {
+        gchar *def = g_key_file_get_string(file, "general", "default_layout", NULL);
+        default_layout = def ? std::max(0, find_layout(def)) : 0;
+        g_free(def);
+        if (g_key_file_has_key(file, "general", "parked_slots", NULL))
+            parked_slots = std::max(0, g_key_file_get_integer(file, "general", "parked_slots", NULL));
+    }
+
+    g_key_file_free(file);
+    return ok;
+}
+
+const SourceDesc* LayoutConfig::find_source(const std::string &name) const {
+    for (const SourceDesc &s : sources)
+        if (s.name == name) return &s;
+    return nullptr;
+}
+
+int LayoutConfig::find_layout(const std::string &name) const {
+    for (size_t i = 0; i < layouts.size(); ++i)
+        if (layouts[i].name == name) return (int)i;
+    return -1;
+}
+
+int LayoutConfig::largest_layout() const {
+    int best = 0;
+    for (size_t i = 1; i < layouts.size(); ++i)
+        if (layouts[i].tiles.size() > layouts[best].tiles.size()) best = (int)i;
+    return best;
+}
+
+int pick_variant(const std::vector<SourceVariant> &variants, int height, bool srt) {
+    if (height <= 0) return -1;
+    for (size_t i = 0; i < variants.size(); ++i) {
+        const SourceVariant &v = variants[i];
+        if (v.height >= height && !(srt ? v.streamid : v.port).empty()) return (int)i;
+    }
+    return -1;
+}
+
+void take_file_source(SourceDesc &source) {
+    if (source.streamid.compare(0, 5, "file:") != 0) return;
+    source.file = source.streamid.substr(5);
+    source.streamid.clear();
+}
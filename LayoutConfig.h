@@ -0,0 +1,104 @@
+#ifndef LAYOUTCONFIG_H
+#define LAYOUTCONFIG_H
+
+#include <glib.h>
+#include <string>
+#include <vector>
+
+// Otra resolución de la misma fuente (un proxy): streamid y/o puerto propios,
+// para tiles de hasta height píxeles de alto
+struct SourceVariant {
+    int height = 0;
+    std::string streamid;
+    std::string port;
+};
+
+// Fuente de video: streamid para SRT y puerto para UDP. Con demux RTP el
+// puerto solo identifica la fuente y rtp la asocia a un emisor
+// ("ssrc=0x1234" o "pt=97"); vacío: primer SSRC nuevo que llegue.
+// variants va de menor a mayor altura; la fuente en sí es el escalón más alto.
+// file: archivo grabado que reemplaza a la red (FileSource), en cualquier modo.
+struct SourceDesc {
+    std::string name;
+    std::string streamid;
+    std::string port;
+    std::string rtp;
+    std::vector<SourceVariant> variants;
+    std::string file;
+};
+
+// "file:RUTA" en el lugar del streamid: pasa la ruta a file
+void take_file_source(SourceDesc &source);
+
+// Variante más chica que cubre un tile de height píxeles de alto (ya con la
+// escala del monitor) y que tiene destino para el modo (streamid en SRT,
+// puerto en UDP). -1: la fuente principal, también si el tamaño no se conoce.
+int pick_variant(const std::vector<SourceVariant> &variants, int height, bool srt);
+
+// Celda de un layout en unidades de la grilla (columna, fila, ancho, alto)
+struct LayoutTile {
+    int col = 0;
+    int row = 0;
+    int width = 1;
+    int height = 1;
+    std::string source;
+};
+
+struct Layout {
+    std::string name;
+    int cols = 1;
+    int rows = 1;
+    std::vector<LayoutTile> tiles;
+};
+
+// Layouts y fuentes del mosaico, cargados de un archivo .ini (GKeyFile):
+//
+//   [general]
+//   default_layout=2x2
+//   # slots fuera del layout que siguen calientes
+//   parked_slots=6
+//
+//   [sources]
+//   cam1=live.sls.com/live/stream1;5000
+//   # demux RTP (opcional)
+//   cam2=live.sls.com/live/stream2;5001;ssrc=0x1234
+//   cam3=live.sls.com/live/stream3;5002
+//   cam4=live.sls.com/live/stream4;5003
+//   # variante para tiles de hasta 360 px
+//   cam1@360=live.sls.com/live/stream1_360p;5100
+//   # archivo en bucle (.ts, .pcap, .h264)
+//   grabada=file:/capturas/estadio.ts
+//
+//   [layout 2x2]
+//   # fila por fila
+//   grid=2x2
+//   sources=cam1;cam2;cam3;cam4
+//
+//   [layout 1+5]
+//   cols=3
+//   rows=3
+//   # col,fila[,ancho,alto]
+//   tiles=0,0,2,2;2,0;2,1;0,2;1,2;2,2
+//
+// Sin "sources" en un layout, las celdas toman las fuentes en orden.
+class LayoutConfig {
+public:
+    std::vector<SourceDesc> sources;
+    std::vector<Layout> layouts;
+    int default_layout = 0;
+    int parked_slots = 6;
+
+    // Los 6 streams y el grid 3x2 de siempre, con layouts "1".."6"
+    static LayoutConfig builtin();
+
+    // MOSAIC_LAYOUT_FILE, o mosaic_layouts.ini en el directorio actual, o builtin()
+    static LayoutConfig load_default();
+    bool load_file(const std::string &path, GError **error);
+
+    const SourceDesc* find_source(const std::string &name) const;
+    int find_layout(const std::string &name) const;
+    // Primer layout con más celdas (el "mostrar todo")
+    int largest_layout() const;
+};
+
+#endif // LAYOUTCONFIG_H
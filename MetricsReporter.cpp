@@ -0,0 +1,241 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "MetricsReporter.h"
+
+MetricsReporter::MetricsReporter(Provider provider) : provider(provider) {
+    const char *env = g_getenv("MOSAIC_METRICS_FILE");
+    if (env && *env) {
+        path = env;
+    } else {
+        gchar *file = g_build_filename(g_get_tmp_dir(), "multistream_mosaic-metrics.json", NULL);
+        path = file;
+        g_free(file);
+    }
+}
+
+MetricsReporter::~MetricsReporter() {
+    if (timer_id) g_source_remove(timer_id);
+    timer_id = 0;
+}
+
+GtkWidget* MetricsReporter::get_hud_widget() {
+    if (!hud) {
+        hud = gtk_label_new(NULL);
+        gtk_widget_set_halign(hud, GTK_ALIGN_START);
+        gtk_widget_set_valign(hud, GTK_ALIGN_START);
+        gtk_widget_set_margin_start(hud, 8);
+        gtk_widget_set_margin_top(hud, 8);
+        gtk_widget_set_no_show_all(hud, TRUE);
+    }
+    return hud;
+}
+
+void MetricsReporter::set_hud_visible(bool visible) {
+    hud_on = visible;
+    if (!hud) return;
+    if (visible) {
+        tick();
+        gtk_widget_show(hud);
+    } else {
+        gtk_widget_hide(hud);
+    }
+}
+
+void MetricsReporter::start(guint interval_ms) {
+    if (timer_id) g_source_remove(timer_id);
+    timer_id = g_timeout_add(interval_ms, &MetricsReporter::on_timeout, this);
+    g_print("[Metrics] Publicando métricas en %s\n", path.c_str());
+}
+
+gboolean MetricsReporter::on_timeout(gpointer data) {
+    static_cast<MetricsReporter *>(data)->tick();
+    return G_SOURCE_CONTINUE;
+}
+
+MetricsReporter::Rates MetricsReporter::rates_for(const SlotSample &sample, gint64 now_us) {
+    Previous &prev = previous[sample.index];
+    Rates rates;
+
+    // Contadores reiniciados (pipeline nuevo): se toma cero como base
+    if (sample.metrics.bytes_in < prev.bytes_in || sample.metrics.frames_decoded < prev.frames_decoded)
+        prev.bytes_in = prev.frames_decoded = 0;
+
+    if (prev.time_us > 0 && now_us > prev.time_us) {
+        double seconds = (now_us - prev.time_us) / 1e6;
+        rates.kbps = (sample.metrics.bytes_in - prev.bytes_in) * 8.0 / 1000.0 / seconds;
+        rates.fps = (sample.metrics.frames_decoded - prev.frames_decoded) / seconds;
+    }
+
+    prev.bytes_in = sample.metrics.bytes_in;
+    prev.frames_decoded = sample.metrics.frames_decoded;
+    prev.time_us = now_us;
+    return rates;
+}
+
+void MetricsReporter::tick() {
+    std::vector<SlotSample> samples = provider();
+    gint64 now = g_get_monotonic_time();
+
+    std::vector<Rates> rates;
+    for (const SlotSample &sample : samples) rates.push_back(rates_for(sample, now));
+
+    if (hud_on && hud) {
+        std::string text = hud_text(samples, rates);
+        gchar *escaped = g_markup_escape_text(text.c_str(), -1);
+        gchar *markup = g_strdup_printf("<span font_family=\"monospace\" size=\"small\">%s</span>", escaped);
+        gtk_label_set_markup(GTK_LABEL(hud), markup);
+        g_free(markup);
+        g_free(escaped);
+    }
+
+    // Escritura atómica (archivo temporal + rename): el lector nunca ve un JSON a medias
+    std::string json = json_text(samples, rates);
+    GError *error = nullptr;
+    if (!g_file_set_contents(path.c_str(), json.c_str(), (gssize)json.size(), &error)) {
+        g_printerr("[Metrics] No se pudo escribir %s: %s\n", path.c_str(), error->message);
+        g_error_free(error);
+    }
+}
+
+std::string MetricsReporter::hud_text(const std::vector<SlotSample> &samples, const std::vector<Rates> &rates) const {
+    std::string text = "slot fuente       modo          kbps   fps  dec ms(max)  cola       perd/reord  jit ms  jb ms(obj)  kern  drop  rec\n";
+    char line[256];
+    char kern[24];
+    char jb[24];
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const SlotMetrics::Snapshot &m = samples[i].metrics;
+        // Solo se marca el estado del enlace cuando no está en vivo
+        std::string link;
+        if (*m.link_state && strcmp(m.link_state, "en vivo") != 0) link = std::string("  [") + m.link_state + "]";
+        if (m.has_demux && !m.demux_assigned) link += "  [sin emisor]";
+        if (*m.content && strcmp(m.content, "normal") != 0) link += std::string("  [") + m.content + "]";
+        // Descartes del kernel: solo con la ingesta propia (socket conocido)
+        if (m.has_kernel) snprintf(kern, sizeof(kern), "%5" G_GUINT64_FORMAT, m.kernel_drops);
+        else snprintf(kern, sizeof(kern), "%5s", "-");
+        // Latencia del jitterbuffer aplicada y la que busca el controlador
+        if (m.has_jitter_control) snprintf(jb, sizeof(jb), "%5u(%4u)", m.jb_latency_ms, m.jb_target_ms);
+        else snprintf(jb, sizeof(jb), "%11s", "-");
+        snprintf(line, sizeof(line),
+                 "%-4d %-12.12s %-11s %7.0f %5.1f %5.1f(%5.1f) %3u/%5.0fms %5" G_GUINT64_FORMAT "/%-5" G_GUINT64_FORMAT " %6.2f %s %s %5" G_GUINT64_FORMAT " %4u%s%s\n",
+                 samples[i].index, samples[i].source.c_str(), samples[i].mode,
+                 rates[i].kbps, rates[i].fps,
+                 m.decode_latency_avg_ms, m.decode_latency_max_ms,
+                 m.queue_buffers, m.queue_time_ns / 1e6,
+                 m.rtp_lost, m.rtp_reordered, m.jitter_ms,
+                 jb, kern, m.sink_dropped, m.reconnects,
+                 samples[i].visible ? "" : "  (oculto)",
+                 link.c_str());
+        text += line;
+    }
+    return text;
+}
+
+// Decimal con punto sea cual sea el locale; NaN/infinito no existen en JSON
+static std::string json_number(double value, int decimals) {
+    if (!std::isfinite(value)) return "null";
+    char format[8], text[G_ASCII_DTOSTR_BUF_SIZE];
+    snprintf(format, sizeof(format), "%%.%df", decimals);
+    return g_ascii_formatd(text, sizeof(text), format, value);
+}
+
+std::string MetricsReporter::json_escape(const std::string &text) {
+    std::string out;
+    out.reserve(text.size());
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    out += code;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string MetricsReporter::json_text(const std::vector<SlotSample> &samples, const std::vector<Rates> &rates) const {
+    // GString: ninguna entrada se trunca, por larga que sea la fuente.
+    // Los decimales van con json_number: GTK deja el locale del usuario (es_*: coma)
+    GString *json = g_string_new(NULL);
+    g_string_append_printf(json, "{\n  \"timestamp_us\": %" G_GINT64_FORMAT ",\n  \"slots\": [", g_get_real_time());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const SlotSample &s = samples[i];
+        const SlotMetrics::Snapshot &m = s.metrics;
+        g_string_append_printf(json,
+                 "%s\n    {\"slot\": %d, \"source\": \"%s\", \"mode\": \"%s\", \"visible\": %s, "
+                 "\"bitrate_kbps\": %s, \"fps\": %s, "
+                 "\"bytes_in\": %" G_GUINT64_FORMAT ", \"frames_decoded\": %" G_GUINT64_FORMAT ", "
+                 "\"decode_latency_ms\": %s, \"decode_latency_max_ms\": %s, "
+                 "\"queue_buffers\": %u, \"queue_bytes\": %u, \"queue_ms\": %s, "
+                 "\"sink_rendered\": %" G_GUINT64_FORMAT ", \"sink_dropped\": %" G_GUINT64_FORMAT ", "
+                 "\"rtp_packets\": %" G_GUINT64_FORMAT ", \"rtp_lost\": %" G_GUINT64_FORMAT ", "
+                 "\"rtp_reordered\": %" G_GUINT64_FORMAT ", \"jitter_ms\": %s, "
+                 "\"link_state\": \"%s\", \"reconnects\": %u, \"last_recovery_ms\": %s, \"content\": \"%s\"",
+                 i ? "," : "",
+                 s.index, json_escape(s.source).c_str(), json_escape(s.mode).c_str(), s.visible ? "true" : "false",
+                 json_number(rates[i].kbps, 1).c_str(), json_number(rates[i].fps, 2).c_str(),
+                 m.bytes_in, m.frames_decoded,
+                 json_number(m.decode_latency_avg_ms, 2).c_str(), json_number(m.decode_latency_max_ms, 2).c_str(),
+                 m.queue_buffers, m.queue_bytes, json_number(m.queue_time_ns / 1e6, 1).c_str(),
+                 m.sink_rendered, m.sink_dropped,
+                 m.rtp_packets, m.rtp_lost, m.rtp_reordered, json_number(m.jitter_ms, 3).c_str(),
+                 json_escape(m.link_state).c_str(), m.reconnects, json_number(m.last_recovery_ms, 1).c_str(), json_escape(m.content).c_str());
+
+        if (m.has_jitterbuffer) {
+            g_string_append_printf(json,
+                     ", \"jitterbuffer\": {\"lost\": %" G_GUINT64_FORMAT ", \"late\": %" G_GUINT64_FORMAT
+                     ", \"duplicates\": %" G_GUINT64_FORMAT,
+                     m.jb_lost, m.jb_late, m.jb_duplicates);
+            if (m.has_jitter_control) {
+                g_string_append_printf(json, ", \"latency_ms\": %u, \"target_ms\": %u, \"late_pct\": %s",
+                         m.jb_latency_ms, m.jb_target_ms, json_number(m.jb_late_pct, 3).c_str());
+            }
+            g_string_append(json, "}");
+        }
+        if (m.has_ingest) {
+            g_string_append_printf(json,
+                     ", \"ingest\": {\"datagrams\": %" G_GUINT64_FORMAT ", \"batch_avg\": %s"
+                     ", \"app_dropped\": %" G_GUINT64_FORMAT,
+                     m.ingest_datagrams, json_number(m.ingest_batch_avg, 1).c_str(), m.ingest_dropped);
+            if (m.has_kernel) {
+                g_string_append_printf(json,
+                         ", \"kernel_drops\": %" G_GUINT64_FORMAT ", \"kernel_queue_bytes\": %" G_GUINT64_FORMAT,
+                         m.kernel_drops, m.kernel_queue_bytes);
+            }
+            if (m.has_demux) {
+                g_string_append_printf(json, ", \"ssrc\": %s, \"unrouted\": %" G_GUINT64_FORMAT,
+                         m.demux_assigned ? std::to_string(m.demux_ssrc).c_str() : "null", m.demux_unrouted);
+            }
+            g_string_append(json, "}");
+        }
+        if (m.has_presentation) {
+            g_string_append_printf(json,
+                     ", \"presentation\": {\"presented\": %" G_GUINT64_FORMAT ", \"coalesced\": %" G_GUINT64_FORMAT "}",
+                     m.frames_presented, m.frames_coalesced);
+        }
+        if (m.replay_bytes > 0 || m.replaying) {
+            g_string_append_printf(json,
+                     ", \"replay\": {\"buffered_s\": %s, \"bytes\": %" G_GUINT64_FORMAT ", \"playing\": %s}",
+                     json_number(m.replay_seconds, 1).c_str(), m.replay_bytes, m.replaying ? "true" : "false");
+        }
+        if (m.has_file) {
+            g_string_append_printf(json, ", \"file\": {\"units\": %" G_GUINT64_FORMAT ", \"loops\": %u}",
+                     m.file_units, m.file_loops);
+        }
+        g_string_append(json, "}");
+    }
+    g_string_append(json, "\n  ]\n}\n");
+
+    std::string text(json->str, json->len);
+    g_string_free(json, TRUE);
+    return text;
+}
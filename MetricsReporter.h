@@ -0,0 +1,65 @@
+#ifndef METRICSREPORTER_H
+#define METRICSREPORTER_H
+
+#include <gtk/gtk.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "SlotMetrics.h"
+
+// Publica las métricas de los slots una vez por intervalo (hilo principal):
+// en un HUD sobre el mosaico (tecla H) y en un archivo JSON que el monitoreo
+// puede leer (MOSAIC_METRICS_FILE, por defecto <tmp>/multistream_mosaic-metrics.json).
+class MetricsReporter {
+public:
+    struct SlotSample {
+        int index;              // id del slot
+        std::string source;
+        const char *mode;
+        bool visible;
+        SlotMetrics::Snapshot metrics;
+    };
+    using Provider = std::function<std::vector<SlotSample>()>;
+
+    explicit MetricsReporter(Provider provider);
+    ~MetricsReporter();
+
+    GtkWidget* get_hud_widget();
+    void set_hud_visible(bool visible);
+    bool hud_visible() const { return hud_on; }
+
+    void start(guint interval_ms = 1000);
+    const std::string& json_path() const { return path; }
+
+    // Texto como contenido de un string JSON (sin las comillas)
+    static std::string json_escape(const std::string &text);
+
+private:
+    // Valores anteriores para calcular tasas por slot
+    struct Previous {
+        guint64 bytes_in = 0;
+        guint64 frames_decoded = 0;
+        gint64 time_us = 0;
+    };
+    struct Rates {
+        double kbps = 0.0;
+        double fps = 0.0;
+    };
+
+    Provider provider;
+    GtkWidget* hud = nullptr;
+    bool hud_on = false;
+    guint timer_id = 0;
+    std::string path;
+    std::map<int, Previous> previous;
+
+    void tick();
+    Rates rates_for(const SlotSample &sample, gint64 now_us);
+    std::string hud_text(const std::vector<SlotSample> &samples, const std::vector<Rates> &rates) const;
+    std::string json_text(const std::vector<SlotSample> &samples, const std::vector<Rates> &rates) const;
+
+    static gboolean on_timeout(gpointer data);
+};
+
+#endif // METRICSREPORTER_H
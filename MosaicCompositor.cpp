@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cstdlib>
+#include "MosaicCompositor.h"
+#include "UdpIngest.h"
+#include "RtpDemux.h"
+#include "FileSource.h"
+#include "MosaicOutput.h"
+#include "DecoderScheduler.h"
+
+struct CompositorJob {
+    GstElement *old_pipeline;   // referencia propia (puede ser nullptr)
+    GstElement *new_pipeline;   // referencia propia (puede ser nullptr)
+};
+
+// Callback del bus: solo informa errores y EOS del pipeline compuesto
+static gboolean compositor_bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
+    switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR: {
+            GError *err;
+            gchar *debug;
+            gst_message_parse_error(msg, &err, &debug);
+            g_printerr("[MosaicCompositor] Error en %s: %s\n",
+                       GST_OBJECT_NAME(GST_MESSAGE_SRC(msg)), err->message);
+            g_error_free(err);
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+            g_print("[MosaicCompositor] End of stream\n");
+            break;
+        default:
+            break;
+    }
+    return TRUE;
+}
+
+MosaicCompositor::~MosaicCompositor() {
+    stop();
+    // Esperar a que el pipeline termine de apagarse
+    if (jobs) g_thread_pool_free(jobs, FALSE, TRUE);
+    jobs = nullptr;
+    if (container) {
+        GtkWidget *parent = gtk_widget_get_parent(container);
+        if (parent && GTK_IS_CONTAINER(parent))
+            gtk_container_remove(GTK_CONTAINER(parent), container);
+        container = nullptr;
+    }
+}
+
+void MosaicCompositor::set_output_size(int width, int height) {
+    // Dimensiones pares para no romper formatos 4:2:0
+    out_width = std::max(2, width & ~1);
+    out_height = std::max(2, height & ~1);
+}
+
+// Geometría de celdas: la grilla del layout repartida sobre el lienzo;
+// una celda que abarca varias columnas/filas suma sus tamaños.
+std::vector<MosaicCompositor::CellRect> MosaicCompositor::compute_cells(const Layout &cells_layout) const {
+    int cell_w = std::max(2, (out_width / cells_layout.cols) & ~1);
+    int cell_h = std::max(2, (out_height / cells_layout.rows) & ~1);
+
+    std::vector<CellRect> cells;
+    for (const LayoutTile &t : cells_layout.tiles) {
+        cells.push_back({t.col * cell_w, t.row * cell_h, t.width * cell_w, t.height * cell_h});
+    }
+    return cells;
+}
+
+// Variante de la entrada para el alto de su celda en el lienzo (-1: la principal)
+int MosaicCompositor::cell_variant(StreamMode mode, const SourceDesc &input, const CellRect &cell) const {
+    bool srt = (mode == StreamMode::SRT_MOSAIC);
+    if (!srt && PipelineDesc::rtp_demux()) return -1;
+    return pick_variant(input.variants, cell.h, srt);
+}
+
+std::vector<std::string> MosaicCompositor::keys_for(StreamMode mode, const Layout &cells_layout,
+                                                    const std::vector<SourceDesc> &inputs) const {
+    std::vector<CellRect> cells = compute_cells(cells_layout);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < std::min(cells.size(), inputs.size()); ++i) {
+        int v = cell_variant(mode, inputs[i], cells[i]);
+        keys.push_back(v < 0 ? inputs[i].name : inputs[i].name + "@" + std::to_string(inputs[i].variants[v].height));
+    }
+    return keys;
+}
+
+void MosaicCompositor::build(StreamMode mode, const Layout &new_layout, const std::vector<SourceDesc> &inputs) {
+    stop();
+
+    layout = new_layout;
+    layout.tiles.resize(std::min(layout.tiles.size(), inputs.size()));
+    input_keys = keys_for(mode, layout, inputs);
+    built_mode = mode;
+    if (layout.tiles.empty()) return;
+
+    std::vector<CellRect> cells = compute_cells(layout);
+    bool fast = (mode == StreamMode::UDP_FAST);
+
+    // Una sola conversión y un solo sink para todo el mosaico
+    std::string pipeline_str =
+        "compositor name=comp background=black ! "
+        "video/x-raw,width=" + std::to_string(out_width) +
+        ",height=" + std::to_string(out_height) +
+        " ! videoconvert ! gtksink name=videosink" +
+        (fast ? " sync=false max-lateness=0 qos=false" : "");
+
+    // Cada entrada se escala a su celda antes de llegar al compositor, desde
+    // la variante más chica que la cubre
+    std::vector<std::string> ports;
+    for (size_t i = 0; i < layout.tiles.size(); ++i) {
+        std::string idx = std::to_string(i);
+        int v = cell_variant(mode, inputs[i], cells[i]);
+        const std::string &streamid = v < 0 ? inputs[i].streamid : inputs[i].variants[v].streamid;
+        ports.push_back(v < 0 ? inputs[i].port : inputs[i].variants[v].port);
+        // Un archivo ilegible deja la celda sin entrada, como una fuente caída
+        std::string branch = inputs[i].file.empty() ? PipelineDesc::decode_branch(mode, streamid, ports[i], idx)
+                                                    : PipelineDesc::file_decode_branch(inputs[i].file, true, idx);
+        if (branch.empty()) continue;
+        pipeline_str += " " + branch +
+            " ! videoscale ! capsfilter name=cellcaps" + idx +
+            " caps=\"video/x-raw,width=" + std::to_string(cells[i].w) +
+            ",height=" + std::to_string(cells[i].h) + ",pixel-aspect-ratio=1/1\"" +
+            " ! queue ! comp.sink_" + idx;
+    }
+
+    GError *error = nullptr;
+    pipeline = gst_parse_launch(pipeline_str.c_str(), &error);
+    if (error) {
+        g_printerr("[MosaicCompositor] Error creando pipeline: %s\n", error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        pipeline = nullptr;
+        return;
+    }
+
+    GstBus *bus = gst_element_get_bus(pipeline);
+    bus_watch_id = gst_bus_add_watch(bus, compositor_bus_call, this);
+    gst_object_unref(bus);
+    // Decoders y compositor fuera del núcleo de GTK
+    DecoderScheduler::instance().release_streaming_threads(pipeline);
+
+    // El mosaico ya compuesto también va a la salida codificada, sin copia
+    if (output) output->tap(pipeline, "comp");
+
+    GtkWidget *box = get_widget();
+    GstElement *videosink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+    if (videosink) {
+        g_object_get(G_OBJECT(videosink), "widget", &video_widget, NULL);
+        gst_object_unref(videosink);
+    }
+
+    if (video_widget && GTK_IS_WIDGET(video_widget)) {
+        gtk_widget_set_hexpand(video_widget, TRUE);
+        gtk_widget_set_vexpand(video_widget, TRUE);
+        gtk_container_add(GTK_CONTAINER(box), video_widget);
+        // g_object_get devolvió una referencia propia; el container ya tiene la suya
+        g_object_unref(video_widget);
+    } else {
+        g_printerr("[MosaicCompositor] No se pudo obtener el widget de video\n");
+        video_widget = nullptr;
+    }
+
+    // Entradas grabadas: cada "filesrcN" es un appsrc
+    for (size_t i = 0; i < layout.tiles.size(); ++i) {
+        FileSource *file = FileSource::attach(pipeline, "filesrc" + std::to_string(i), inputs[i].file, true);
+        if (file) files.push_back(file);
+    }
+
+    // Ingesta UDP propia o demux por SSRC: cada "rtpsrcN" es un appsrc
+    if (mode != StreamMode::SRT_MOSAIC) {
+        for (size_t i = 0; i < layout.tiles.size(); ++i) {
+            if (!inputs[i].file.empty()) continue;
+            std::string name = "rtpsrc" + std::to_string(i);
+            if (PipelineDesc::rtp_demux()) {
+                int id = RtpDemux::instance().attach(pipeline, name, ports[i]);
+                if (id) demux_ids.push_back(id);
+                continue;
+            }
+            UdpIngest *ingest = UdpIngest::attach(pipeline, name, atoi(ports[i].c_str()));
+            if (ingest) ingests.push_back(ingest);
+        }
+    }
+
+    apply_layout();
+    queue_job(nullptr, pipeline);
+
+    g_print("[MosaicCompositor] Pipeline único con %zu entradas, layout %s (%dx%d, modo %s)\n",
+            layout.tiles.size(), layout.name.c_str(), out_width, out_height, PipelineDesc::mode_name(mode));
+
+    gtk_widget_show_all(box);
+}
+
+void MosaicCompositor::stop() {
+    for (UdpIngest *ingest : ingests) delete ingest;
+    ingests.clear();
+    for (int id : demux_ids) RtpDemux::instance().detach(id);
+    demux_ids.clear();
+    for (FileSource *file : files) delete file;
+    files.clear();
+
+    if (bus_watch_id) {
+        g_source_remove(bus_watch_id);
+        bus_watch_id = 0;
+    }
+    // Cerrar todas las fuentes SRT/UDP a la vez lleva su tiempo: en el pool,
+    // antes que el PLAYING de un pipeline nuevo
+    if (pipeline) {
+        queue_job(pipeline, nullptr);
+        gst_object_unref(pipeline);
+        pipeline = nullptr;
+    }
+    if (video_widget && GTK_IS_WIDGET(video_widget) && container) {
+        gtk_container_remove(GTK_CONTAINER(container), video_widget);
+    }
+    video_widget = nullptr;
+}
+
+void MosaicCompositor::queue_job(GstElement *old_pipeline, GstElement *new_pipeline) {
+    if (!jobs) jobs = g_thread_pool_new(&MosaicCompositor::run_job, this, 1, FALSE, NULL);
+    CompositorJob *job = new CompositorJob{
+        old_pipeline ? GST_ELEMENT(gst_object_ref(old_pipeline)) : nullptr,
+        new_pipeline ? GST_ELEMENT(gst_object_ref(new_pipeline)) : nullptr};
+    g_thread_pool_push(jobs, job, NULL);
+}
+
+// Se ejecuta en el hilo del pool (nunca en el hilo de GTK)
+void MosaicCompositor::run_job(gpointer data, gpointer user_data) {
+    CompositorJob *job = static_cast<CompositorJob *>(data);
+    DecoderScheduler::instance().release_current_thread();
+
+    if (job->old_pipeline) {
+        gst_element_set_state(job->old_pipeline, GST_STATE_NULL);
+        gst_object_unref(job->old_pipeline);
+    }
+    if (job->new_pipeline) {
+        if (gst_element_set_state(job->new_pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+            g_printerr("[MosaicCompositor] No se pudo pasar el pipeline a PLAYING\n");
+        gst_object_unref(job->new_pipeline);
+    }
+    delete job;
+}
+
+void MosaicCompositor::set_layout(StreamMode mode, const Layout &new_layout, const std::vector<SourceDesc> &inputs) {
+    std::vector<std::string> keys = keys_for(mode, new_layout, inputs);
+
+    if (!pipeline || mode != built_mode || keys != input_keys) {
+        build(mode, new_layout, inputs);
+        return;
+    }
+
+    layout = new_layout;
+    layout.tiles.resize(keys.size());
+    apply_layout();
+}
+
+// Aplica posición a los pads del compositor y tamaño a cada capsfilter
+void MosaicCompositor::apply_layout() {
+    if (!pipeline) return;
+
+    GstElement *comp = gst_bin_get_by_name(GST_BIN(pipeline), "comp");
+    if (!comp) return;
+
+    std::vector<CellRect> cells = compute_cells(layout);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        std::string idx = std::to_string(i);
+
+        GstPad *pad = gst_element_get_static_pad(comp, ("sink_" + idx).c_str());
+        if (pad) {
+            g_object_set(pad, "xpos", cells[i].x, "ypos", cells[i].y, NULL);
+            gst_object_unref(pad);
+        }
+
+        GstElement *capsfilter = gst_bin_get_by_name(GST_BIN(pipeline), ("cellcaps" + idx).c_str());
+        if (capsfilter) {
+            GstCaps *caps = gst_caps_new_simple("video/x-raw",
+                                                "width", G_TYPE_INT, cells[i].w,
+                                                "height", G_TYPE_INT, cells[i].h,
+                                                "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1,
+                                                NULL);
+            g_object_set(capsfilter, "caps", caps, NULL);
+            gst_caps_unref(caps);
+            gst_object_unref(capsfilter);
+        }
+    }
+    gst_object_unref(comp);
+}
+
+GtkWidget* MosaicCompositor::get_widget() {
+    if (!container) {
+        container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+        gtk_widget_set_hexpand(container, TRUE);
+        gtk_widget_set_vexpand(container, TRUE);
+    }
+    return container;
+}
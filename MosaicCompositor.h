@@ -0,0 +1,70 @@
+#ifndef MOSAICCOMPOSITOR_H
+#define MOSAICCOMPOSITOR_H
+
+#include <gtk/gtk.h>
+#include <gst/gst.h>
+#include <string>
+#include <vector>
+#include "PipelineDesc.h"
+#include "LayoutConfig.h"
+
+class UdpIngest;
+class FileSource;
+class MosaicOutput;
+
+// Modo mosaico en un único pipeline: todas las entradas se escalan a su celda
+// y entran a un "compositor", con una sola conversión y un solo gtksink.
+class MosaicCompositor {
+public:
+    MosaicCompositor() = default;
+    ~MosaicCompositor();
+
+    // Tamaño del lienzo compuesto (antes de build)
+    void set_output_size(int width, int height);
+    // Salida codificada del mosaico: toma los frames del compositor (antes de build)
+    void set_output(MosaicOutput *o) { output = o; }
+
+    // inputs: fuente de cada celda del layout, en el mismo orden
+    void build(StreamMode mode, const Layout &layout, const std::vector<SourceDesc> &inputs);
+    void stop();
+
+    // Con las mismas fuentes (y variantes para el tamaño de cada celda) solo
+    // reubica las celdas; si cambian, reconstruye
+    void set_layout(StreamMode mode, const Layout &layout, const std::vector<SourceDesc> &inputs);
+
+    GtkWidget* get_widget();
+    bool is_running() const { return pipeline != nullptr; }
+
+private:
+    struct CellRect { int x, y, w, h; };
+
+    Layout layout;
+    std::vector<std::string> input_keys;   // fuente@variante de cada celda
+    StreamMode built_mode = StreamMode::SRT_MOSAIC;
+    int out_width = 1920;
+    int out_height = 1080;
+
+    GtkWidget* container = nullptr;
+    GtkWidget* video_widget = nullptr;
+    GstElement* pipeline = nullptr;
+    guint bus_watch_id = 0;
+    // Cambios de estado fuera del hilo de GTK, en orden (un solo hilo)
+    GThreadPool* jobs = nullptr;
+    MosaicOutput* output = nullptr;
+    std::vector<UdpIngest*> ingests;   // una por entrada UDP con ingesta propia
+    std::vector<int> demux_ids;        // salidas registradas en RtpDemux
+    std::vector<FileSource*> files;    // entradas grabadas (siempre a ritmo real)
+
+    std::vector<CellRect> compute_cells(const Layout &cells_layout) const;
+    int cell_variant(StreamMode mode, const SourceDesc &input, const CellRect &cell) const;
+    std::vector<std::string> keys_for(StreamMode mode, const Layout &cells_layout,
+                                      const std::vector<SourceDesc> &inputs) const;
+    void apply_layout();
+
+    // Toma una referencia de cada pipeline: el viejo pasa a NULL y se libera,
+    // el nuevo pasa a PLAYING
+    void queue_job(GstElement *old_pipeline, GstElement *new_pipeline);
+    static void run_job(gpointer data, gpointer user_data);
+};
+
+#endif // MOSAICCOMPOSITOR_H
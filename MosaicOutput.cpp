@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "MosaicOutput.h"
+#include "DecoderScheduler.h"
+
+static int env_int(const char *name, int fallback) {
+    const char *value = g_getenv(name);
+    return value ? atoi(value) : fallback;
+}
+
+MosaicOutput::MosaicOutput() {
+    g_mutex_init(&lock);
+}
+
+MosaicOutput::~MosaicOutput() {
+    stop();
+    g_mutex_clear(&lock);
+}
+
+// x264enc si está (plugins-ugly); si no, openh264enc
+std::string MosaicOutput::encoder_desc(int kbps, int fps) {
+    std::string gop = std::to_string(2 * fps);
+    GstElementFactory *factory = gst_element_factory_find("x264enc");
+    if (factory || !(factory = gst_element_factory_find("openh264enc"))) {
+        if (factory) gst_object_unref(factory);
+        return "x264enc tune=zerolatency speed-preset=ultrafast bframes=0 bitrate=" + std::to_string(kbps) +
+               " key-int-max=" + gop;
+    }
+    gst_object_unref(factory);
+    return "openh264enc complexity=low bitrate=" + std::to_string(kbps * 1000) + " gop-size=" + gop;
+}
+
+// Rama de un destino, después del tee. Cada una con su cola que descarta:
+// un consumidor trabado no frena a los demás ni al codificador.
+std::string MosaicOutput::target_branch(const std::string &target) {
+    std::string queue = "queue leaky=downstream max-size-buffers=0 max-size-bytes=0 max-size-time=500000000 ! ";
+
+    if (g_str_has_prefix(target.c_str(), "udp://")) {
+        std::string address = target.substr(strlen("udp://"));
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos || colon == 0) return "";
+        return queue + "rtph264pay config-interval=-1 pt=96 ! udpsink host=" + address.substr(0, colon) +
+               " port=" + address.substr(colon + 1) + " sync=false async=false";
+    }
+    if (g_str_has_prefix(target.c_str(), "srt://")) {
+        std::string uri = target.find('?') == std::string::npos ? target + "?mode=listener" : target;
+        return queue + "mpegtsmux alignment=7 ! srtsink uri=\"" + uri +
+               "\" wait-for-connection=false sync=false async=false";
+    }
+    if (g_str_has_prefix(target.c_str(), "shm:")) {
+        std::string path = target.substr(strlen("shm:"));
+        if (path.empty()) return "";
+        return queue + "shmsink socket-path=\"" + path +
+               "\" shm-size=16000000 wait-for-connection=false sync=false async=false";
+    }
+    return "";
+}
+
+bool MosaicOutput::start() {
+    if (pipeline) return true;
+    const char *env = g_getenv("MOSAIC_OUTPUT");
+    if (!env || !*env) return false;
+
+    int width = 1280, height = 720;
+    const char *size = g_getenv("MOSAIC_OUTPUT_SIZE");
+    if (size && (sscanf(size, "%dx%d", &width, &height) != 2 || width < 16 || height < 16)) {
+        g_printerr("[Output] MOSAIC_OUTPUT_SIZE inválido (%s), uso 1280x720\n", size);
+        width = 1280;
+        height = 720;
+    }
+    int fps = std::max(1, env_int("MOSAIC_OUTPUT_FPS", 25));
+    int kbps = std::max(100, env_int("MOSAIC_OUTPUT_KBPS", 4000));
+    interval_us = G_USEC_PER_SEC / fps;
+
+    // appsrc -> cola que descarta (el codificador en su propio hilo) -> un solo encode -> tee
+    std::string desc =
+        "appsrc name=outsrc format=time is-live=true do-timestamp=true max-bytes=0 ! "
+        "queue leaky=downstream max-size-buffers=2 max-size-bytes=0 max-size-time=0 ! "
+        "videoconvert ! videoscale ! videorate ! "
+        "video/x-raw,format=I420,width=" + std::to_string(width) + ",height=" + std::to_string(height) +
+        ",pixel-aspect-ratio=1/1,framerate=" + std::to_string(fps) + "/1 ! " +
+        encoder_desc(kbps, fps) + " ! h264parse config-interval=-1 ! tee name=outtee allow-not-linked=true";
+
+    int branches = 0;
+    gchar **targets = g_strsplit(env, ",", -1);
+    for (gchar **t = targets; *t; ++t) {
+        std::string target = g_strstrip(*t);
+        if (target.empty()) continue;
+        std::string branch = target_branch(target);
+        if (branch.empty()) {
+            g_printerr("[Output] Destino inválido: %s\n", target.c_str());
+            continue;
+        }
+        desc += " outtee. ! " + branch;
+        g_print("[Output] Destino: %s\n", target.c_str());
+        branches++;
+    }
+    g_strfreev(targets);
+    if (branches == 0) return false;
+
+    GError *error = nullptr;
+    pipeline = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        g_printerr("[Output] Error creando pipeline: %s\n", error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        pipeline = nullptr;
+        return false;
+    }
+
+    GstBus *bus = gst_element_get_bus(pipeline);
+    bus_watch_id = gst_bus_add_watch(bus, &MosaicOutput::bus_call, this);
+    gst_object_unref(bus);
+    // El encoder no comparte el núcleo de GTK
+    DecoderScheduler::instance().release_streaming_threads(pipeline);
+
+    g_mutex_lock(&lock);
+    appsrc = gst_bin_get_by_name(GST_BIN(pipeline), "outsrc");
+    pushed = dropped = 0;
+    g_mutex_unlock(&lock);
+
+    if (gst_element_set_state(pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        g_printerr("[Output] No se pudo pasar el pipeline a PLAYING\n");
+        stop();
+        return false;
+    }
+    next_due_us = 0;
+    running = true;
+    g_print("[Output] Mosaico codificado %dx%d a %d fps, %d kbps\n", width, height, fps, kbps);
+    return true;
+}
+
+void MosaicOutput::stop() {
+    running = false;
+
+    g_mutex_lock(&lock);
+    GstElement *src = appsrc;
+    appsrc = nullptr;
+    guint64 total = pushed, lost = dropped;
+    g_mutex_unlock(&lock);
+    if (src) gst_object_unref(src);
+
+    if (bus_watch_id) g_source_remove(bus_watch_id);
+    bus_watch_id = 0;
+    if (pipeline) {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+        pipeline = nullptr;
+        g_print("[Output] Detenida: %" G_GUINT64_FORMAT " frames entregados, %" G_GUINT64_FORMAT " descartados\n",
+                total, lost);
+    }
+}
+
+bool MosaicOutput::wants_frame() {
+    if (!running.load()) return false;
+    gint64 now = g_get_monotonic_time();
+    gint64 due = next_due_us.load();
+    if (now < due) return false;
+    // Atrasado más de un intervalo: se retoma desde ahora en vez de recuperar
+    gint64 next = (now - due > interval_us) ? now + interval_us : due + interval_us;
+    return next_due_us.compare_exchange_strong(due, next);
+}
+
+void MosaicOutput::push(GstSample *sample) {
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    gsize size = buffer ? gst_buffer_get_size(buffer) : 0;
+
+    g_mutex_lock(&lock);
+    if (appsrc && buffer) {
+        // La cola de atrás nunca bloquea; si igual se acumula, el frame sobra
+        guint64 level = 0;
+        g_object_get(appsrc, "current-level-bytes", &level, NULL);
+        if (level > 2 * size) {
+            dropped++;
+        } else {
+            GstFlowReturn ret;
+            g_signal_emit_by_name(appsrc, "push-sample", sample, &ret);
+            pushed++;
+        }
+    }
+    g_mutex_unlock(&lock);
+    gst_sample_unref(sample);
+}
+
+// ===== Compositor (hilo de streaming) =====
+
+void MosaicOutput::tap(GstElement *pipeline, const char *name) {
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!element) return;
+    GstPad *pad = gst_element_get_static_pad(element, "src");
+    if (pad) {
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &MosaicOutput::tap_probe_cb, this, NULL);
+        gst_object_unref(pad);
+    }
+    gst_object_unref(element);
+}
+
+GstPadProbeReturn MosaicOutput::tap_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    MosaicOutput *self = static_cast<MosaicOutput *>(user_data);
+    if (!self->wants_frame()) return GST_PAD_PROBE_OK;
+
+    // Sin copia: el mismo buffer que va al gtksink, con una referencia más
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    self->push(gst_sample_new(GST_PAD_PROBE_INFO_BUFFER(info), caps, NULL, NULL));
+    if (caps) gst_caps_unref(caps);
+    return GST_PAD_PROBE_OK;
+}
+
+gboolean MosaicOutput::bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+        GError *err;
+        gst_message_parse_error(msg, &err, NULL);
+        g_printerr("[Output] Error en %s: %s\n", GST_OBJECT_NAME(GST_MESSAGE_SRC(msg)), err->message);
+        g_error_free(err);
+    }
+    return G_SOURCE_CONTINUE;
+}
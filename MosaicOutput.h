@@ -0,0 +1,58 @@
+#ifndef MOSAICOUTPUT_H
+#define MOSAICOUTPUT_H
+
+#include <gst/gst.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+// Salida del mosaico compuesto: se codifica una sola vez (H.264 por
+// software) y se sirve a cualquier cantidad de consumidores, en vez de que
+// cada sala vuelva a recibir y decodificar todas las fuentes. Destinos en
+// MOSAIC_OUTPUT, separados por coma:
+//
+//   udp://host:puerto    RTP/H.264 (unicast o multicast)
+//   srt://:puerto        MPEG-TS en un listener SRT local
+//   shm:/ruta/socket     H.264 byte-stream por memoria compartida (shmsrc)
+//
+// MOSAIC_OUTPUT_SIZE (1280x720), MOSAIC_OUTPUT_FPS (25) y
+// MOSAIC_OUTPUT_KBPS (4000) fijan el formato. El codificador corre en su
+// propio hilo detrás de una cola que descarta: nunca frena la presentación.
+class MosaicOutput {
+public:
+    MosaicOutput();
+    ~MosaicOutput();
+
+    // Arranca con la configuración del entorno; false si no hay destinos
+    bool start();
+    void stop();
+    bool is_running() const { return running.load(); }
+    // Periodo entre frames de salida (para quien entrega con un timer)
+    guint interval_ms() const { return (guint)std::max<gint64>(1, interval_us / 1000); }
+
+    // ¿Toca entregar un frame? Limita las copias al fps de salida (cualquier hilo)
+    bool wants_frame();
+    // Frame compuesto; toma la referencia de sample (cualquier hilo)
+    void push(GstSample *sample);
+    // Toma los frames del elemento name del pipeline (el "comp" del compositor)
+    void tap(GstElement *pipeline, const char *name);
+
+private:
+    GMutex lock;
+    GstElement* pipeline = nullptr;
+    GstElement* appsrc = nullptr;      // protegido por lock
+    std::atomic<bool> running{false};
+    std::atomic<gint64> next_due_us{0};
+    gint64 interval_us = 40000;
+    guint bus_watch_id = 0;
+    guint64 pushed = 0;                // protegido por lock
+    guint64 dropped = 0;               // protegido por lock
+
+    static std::string target_branch(const std::string &target);
+    static std::string encoder_desc(int kbps, int fps);
+
+    static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data);
+    static GstPadProbeReturn tap_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+};
+
+#endif // MOSAICOUTPUT_H
@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <gst/video/video.h>
+#include "MosaicRenderer.h"
+#include "YuvConvert.h"
+
+// Cantidad fija de tiles: los hilos de streaming nunca ven crecer el vector
+static const int kMaxTiles = 64;
+
+MosaicRenderer::MosaicRenderer() {
+    for (int i = 0; i < kMaxTiles; ++i) tiles.push_back(new Tile());
+    g_print("[MosaicRenderer] Conversión YUV->RGB: %s\n", YuvConvert::active_kernel());
+}
+
+MosaicRenderer::~MosaicRenderer() {
+    if (area && tick_id) gtk_widget_remove_tick_callback(area, tick_id);
+    tick_id = 0;
+
+    for (Tile *t : tiles) {
+        free_frame(t->pending.exchange(nullptr));
+        if (t->shown) gst_sample_unref(t->shown);
+        delete t;
+    }
+    tiles.clear();
+
+    if (canvas) cairo_surface_destroy(canvas);
+    canvas = nullptr;
+}
+
+GtkWidget* MosaicRenderer::get_widget() {
+    if (!area) {
+        area = gtk_drawing_area_new();
+        gtk_widget_set_hexpand(area, TRUE);
+        gtk_widget_set_vexpand(area, TRUE);
+        g_signal_connect(area, "draw", G_CALLBACK(&MosaicRenderer::on_draw), this);
+        g_signal_connect(area, "size-allocate", G_CALLBACK(&MosaicRenderer::on_size_allocate), this);
+        tick_id = gtk_widget_add_tick_callback(area, &MosaicRenderer::on_tick, this, NULL);
+    }
+    return area;
+}
+
+MosaicRenderer::Tile* MosaicRenderer::tile(int slot) {
+    if (slot < 0 || slot >= (int)tiles.size()) return nullptr;
+    return tiles[slot];
+}
+
+void MosaicRenderer::set_layout(const Layout &new_layout, const std::vector<int> &slot_ids) {
+    layout = new_layout;
+    cell_slots = slot_ids;
+    cell_slots.resize(std::min(cell_slots.size(), layout.tiles.size()));
+    canvas_stale = true;
+    if (area) gtk_widget_queue_draw(area);
+    report_cell_sizes();
+}
+
+void MosaicRenderer::report_cell_sizes() {
+    if (!area || !cell_size_callback) return;
+    int scale = gtk_widget_get_scale_factor(area);
+    int width = gtk_widget_get_allocated_width(area) * scale;
+    int height = gtk_widget_get_allocated_height(area) * scale;
+    // Todavía sin asignar: GTK informa 1x1
+    if (width <= scale || height <= scale) return;
+    for (size_t i = 0; i < cell_slots.size(); ++i) {
+        GdkRectangle rect = cell_rect((int)i, width, height);
+        cell_size_callback(cell_slots[i], rect.width, rect.height);
+    }
+}
+
+void MosaicRenderer::on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer data) {
+    static_cast<MosaicRenderer *>(data)->report_cell_sizes();
+}
+
+// ===== Entrada de frames (hilos de streaming) =====
+
+void MosaicRenderer::free_frame(Frame *frame) {
+    if (!frame) return;
+    if (frame->sample) gst_sample_unref(frame->sample);
+    delete frame;
+}
+
+void MosaicRenderer::publish(int slot, GstSample *sample, bool replay) {
+    Tile *t = tile(slot);
+    guint epoch = t ? t->epoch.load(std::memory_order_acquire) : 0;
+    if (!t || (bool)(epoch & 1) != replay) {
+        gst_sample_unref(sample);
+        return;
+    }
+
+    // Si el anterior sigue en el buzón, GTK todavía no lo tomó: nunca se va a
+    // ver. Solo cuenta si es de esta época (lo de otra se descarta igual).
+    Frame *old = t->pending.exchange(new Frame{sample, epoch}, std::memory_order_acq_rel);
+    if (old) {
+        if (old->epoch == epoch && t->epoch.load(std::memory_order_acquire) == epoch)
+            t->coalesced.fetch_add(1, std::memory_order_relaxed);
+        free_frame(old);
+    }
+}
+
+void MosaicRenderer::advance_epoch(Tile *t, bool replay) {
+    guint next = (((t->epoch.load(std::memory_order_relaxed) >> 1) + 1) << 1) | (replay ? 1u : 0u);
+    t->epoch.store(next, std::memory_order_release);
+    free_frame(t->pending.exchange(nullptr, std::memory_order_acq_rel));
+}
+
+void MosaicRenderer::clear(int slot) {
+    Tile *t = tile(slot);
+    if (!t) return;
+
+    advance_epoch(t, t->replaying());
+    if (t->shown) gst_sample_unref(t->shown);
+    t->shown = nullptr;
+    t->presented = 0;
+    t->coalesced = 0;
+    t->held = false;
+    canvas_stale = true;
+}
+
+MosaicRenderer::TileStats MosaicRenderer::stats(int slot) {
+    TileStats s;
+    Tile *t = tile(slot);
+    if (!t) return s;
+    s.presented = t->presented.load(std::memory_order_relaxed);
+    s.coalesced = t->coalesced.load(std::memory_order_relaxed);
+    return s;
+}
+
+void MosaicRenderer::set_held(int slot, bool held) {
+    Tile *t = tile(slot);
+    if (!t || t->held == held) return;
+    t->held = held;
+    if (held) t->stamp = clock_stamp();
+    // El velo se pinta encima del lienzo: al soltarlo hay que repintar la celda
+    canvas_stale = true;
+    if (area) gtk_widget_queue_draw(area);
+}
+
+GstSample* MosaicRenderer::snapshot() {
+    if (!canvas) return nullptr;
+    cairo_surface_flush(canvas);
+    int width = cairo_image_surface_get_width(canvas);
+    int height = cairo_image_surface_get_height(canvas);
+    int stride = cairo_image_surface_get_stride(canvas);
+
+    // RGB24 de cairo: un uint32 xRGB por píxel, en el orden de bytes de la máquina
+    GstVideoInfo info;
+    gst_video_info_set_format(&info, G_BYTE_ORDER == G_LITTLE_ENDIAN ? GST_VIDEO_FORMAT_BGRx : GST_VIDEO_FORMAT_xRGB,
+                              width, height);
+    gsize size = (gsize)stride * height;
+    GstBuffer *buffer = gst_buffer_new_allocate(NULL, size, NULL);
+    gst_buffer_fill(buffer, 0, cairo_image_surface_get_data(canvas), size);
+    if (stride != GST_VIDEO_INFO_PLANE_STRIDE(&info, 0)) {
+        gsize offset[GST_VIDEO_MAX_PLANES] = {0};
+        gint strides[GST_VIDEO_MAX_PLANES] = {stride};
+        gst_buffer_add_video_meta_full(buffer, GST_VIDEO_FRAME_FLAG_NONE, GST_VIDEO_INFO_FORMAT(&info),
+                                       width, height, 1, offset, strides);
+    }
+
+    GstCaps *caps = gst_video_info_to_caps(&info);
+    GstSample *sample = gst_sample_new(buffer, caps, NULL, NULL);
+    gst_caps_unref(caps);
+    gst_buffer_unref(buffer);
+    return sample;
+}
+
+void MosaicRenderer::set_replay(int slot, bool replay) {
+    Tile *t = tile(slot);
+    if (!t || t->replaying() == replay) return;
+    advance_epoch(t, replay);
+}
+
+int MosaicRenderer::slot_at(int x, int y) const {
+    if (!area) return -1;
+    int width = gtk_widget_get_allocated_width(area);
+    int height = gtk_widget_get_allocated_height(area);
+    for (size_t i = 0; i < cell_slots.size(); ++i) {
+        GdkRectangle rect = cell_rect((int)i, width, height);
+        if (x >= rect.x && x < rect.x + rect.width && y >= rect.y && y < rect.y + rect.height)
+            return cell_slots[i];
+    }
+    return -1;
+}
+
+GstFlowReturn MosaicRenderer::on_new_sample(GstElement *appsink, gpointer data) {
+    AttachData *attach = static_cast<AttachData *>(data);
+    GstSample *sample = nullptr;
+    g_signal_emit_by_name(appsink, "pull-sample", &sample);
+    if (!sample) return GST_FLOW_EOS;
+
+    attach->renderer->publish(attach->slot, sample, attach->replay);
+    return GST_FLOW_OK;
+}
+
+std::string MosaicRenderer::sink_tail(bool fast) {
+    // videoconvert queda en passthrough cuando el decoder ya entrega I420/NV12
+    return std::string("videoconvert name=videoconvert ! capsfilter caps=\"video/x-raw,format={I420,NV12}\" ! "
+                       "appsink name=videosink emit-signals=true max-buffers=1 drop=true") +
+           (fast ? " sync=false" : "");
+}
+
+void MosaicRenderer::attach(GstElement *pipeline, int slot, bool replay) {
+    GstElement *appsink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+    if (!appsink) return;
+
+    AttachData *attach = new AttachData{this, slot, replay};
+    g_signal_connect_data(appsink, "new-sample", G_CALLBACK(&MosaicRenderer::on_new_sample), attach,
+                          [](gpointer data, GClosure *) { delete static_cast<AttachData *>(data); },
+                          (GConnectFlags)0);
+    gst_object_unref(appsink);
+}
+
+// ===== Presentación (hilo de GTK) =====
+
+// Un solo redibujado por tick del frame clock, y solo si algún tile cambió
+gboolean MosaicRenderer::on_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    MosaicRenderer *self = static_cast<MosaicRenderer *>(data);
+
+    bool needs_draw = self->canvas_stale;
+    for (size_t i = 0; i < self->cell_slots.size() && !needs_draw; ++i) {
+        Tile *t = self->tile(self->cell_slots[i]);
+        if (!t) continue;
+        needs_draw = t->pending.load(std::memory_order_acquire) != nullptr;
+    }
+
+    if (needs_draw) gtk_widget_queue_draw(widget);
+    return G_SOURCE_CONTINUE;
+}
+
+// Celdas como en el GtkGrid: grilla del layout, las celdas pueden abarcar varias
+GdkRectangle MosaicRenderer::cell_rect(int cell, int width, int height) const {
+    const LayoutTile &t = layout.tiles[cell];
+    int cell_w = width / layout.cols;
+    int cell_h = height / layout.rows;
+
+    GdkRectangle rect;
+    rect.x = t.col * cell_w;
+    rect.y = t.row * cell_h;
+    rect.width = t.width * cell_w;
+    rect.height = t.height * cell_h;
+    return rect;
+}
+
+gboolean MosaicRenderer::on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
+    MosaicRenderer *self = static_cast<MosaicRenderer *>(data);
+
+    int scale = gtk_widget_get_scale_factor(widget);
+    int width = gtk_widget_get_allocated_width(widget) * scale;
+    int height = gtk_widget_get_allocated_height(widget) * scale;
+    if (width <= 0 || height <= 0) return TRUE;
+
+    // Lienzo reutilizado entre frames; solo se recrea al cambiar el tamaño
+    if (!self->canvas ||
+        cairo_image_surface_get_width(self->canvas) != width ||
+        cairo_image_surface_get_height(self->canvas) != height) {
+        if (self->canvas) cairo_surface_destroy(self->canvas);
+        self->canvas = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+        cairo_surface_set_device_scale(self->canvas, scale, scale);
+        self->canvas_stale = true;
+    }
+
+    cairo_surface_flush(self->canvas);
+    bool stale = self->canvas_stale;
+    self->canvas_stale = false;
+    if (stale) {
+        memset(cairo_image_surface_get_data(self->canvas), 0,
+               (size_t)cairo_image_surface_get_stride(self->canvas) * height);
+        for (Tile *t : self->tiles) t->last_w = t->last_h = 0;
+    }
+
+    for (size_t i = 0; i < self->cell_slots.size(); ++i) {
+        Tile *t = self->tile(self->cell_slots[i]);
+        if (!t) continue;
+
+        // Un frame de una época anterior (vivo durante la repetición o al revés,
+        // o de antes de un clear) no se muestra
+        Frame *frame = t->pending.exchange(nullptr, std::memory_order_acq_rel);
+        GstSample *fresh = nullptr;
+        if (frame && frame->epoch == t->epoch.load(std::memory_order_relaxed)) {
+            fresh = frame->sample;
+            frame->sample = nullptr;
+        }
+        free_frame(frame);
+        if (fresh) {
+            if (t->shown) gst_sample_unref(t->shown);
+            t->shown = fresh;
+            t->presented.fetch_add(1, std::memory_order_relaxed);
+        }
+        // Lienzo limpio: se redibuja también el último frame de los tiles sin novedades
+        if (t->shown && (fresh || stale))
+            self->render_tile(t, t->shown, self->cell_rect((int)i, width, height));
+    }
+    self->repaint_count++;
+
+    cairo_surface_mark_dirty(self->canvas);
+    cairo_set_source_surface(cr, self->canvas, 0, 0);
+    cairo_paint(cr);
+
+    // Tiles sin señal: el velo va sobre cr, el lienzo conserva el frame intacto.
+    // Una repetición se ve sin velo aunque el vivo siga caído.
+    for (size_t i = 0; i < self->cell_slots.size(); ++i) {
+        Tile *t = self->tile(self->cell_slots[i]);
+        if (!t || !t->held || t->replaying()) continue;
+        GdkRectangle rect = self->cell_rect((int)i, width, height);
+        draw_hold(cr, (double)rect.x / scale, (double)rect.y / scale,
+                  (double)rect.width / scale, (double)rect.height / scale, t->stamp);
+    }
+    return TRUE;
+}
+
+void MosaicRenderer::draw_hold(cairo_t *cr, double x, double y, double w, double h, const std::string &stamp) {
+    cairo_save(cr);
+    cairo_rectangle(cr, x, y, w, h);
+    cairo_clip(cr);
+    cairo_set_source_rgba(cr, 0, 0, 0, 0.55);
+    cairo_paint(cr);
+
+    double size = std::max(10.0, std::min(24.0, h / 12));
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, size);
+    cairo_set_source_rgb(cr, 1.0, 0.8, 0.2);
+    cairo_move_to(cr, x + size / 2, y + h - size / 2);
+    cairo_show_text(cr, ("SIN SEÑAL " + stamp).c_str());
+    cairo_restore(cr);
+}
+
+std::string MosaicRenderer::clock_stamp() {
+    GDateTime *now = g_date_time_new_now_local();
+    gchar *text = g_date_time_format(now, "%H:%M:%S");
+    std::string stamp = text ? text : "";
+    g_free(text);
+    g_date_time_unref(now);
+    return stamp;
+}
+
+// Convierte y escala un frame I420/NV12 a dst_w x dst_h píxeles BGRx
+static bool convert_frame(const GstVideoInfo &info, GstBuffer *buffer,
+                          uint8_t *dst, int dst_stride, int dst_w, int dst_h) {
+    YuvConvert::Format format;
+    switch (GST_VIDEO_INFO_FORMAT(&info)) {
+        case GST_VIDEO_FORMAT_I420: format = YuvConvert::Format::I420; break;
+        case GST_VIDEO_FORMAT_NV12: format = YuvConvert::Format::NV12; break;
+        default: return false;
+    }
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, const_cast<GstVideoInfo *>(&info), buffer, GST_MAP_READ)) return false;
+
+    YuvConvert::SourceFrame src;
+    src.format = format;
+    src.width = GST_VIDEO_FRAME_WIDTH(&frame);
+    src.height = GST_VIDEO_FRAME_HEIGHT(&frame);
+    src.y = static_cast<const uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&frame, 0));
+    src.y_stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+    src.u = static_cast<const uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&frame, 1));
+    src.u_stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 1);
+    src.v = format == YuvConvert::Format::I420
+                ? static_cast<const uint8_t *>(GST_VIDEO_FRAME_PLANE_DATA(&frame, 2)) : nullptr;
+    src.v_stride = format == YuvConvert::Format::I420 ? GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 2) : 0;
+
+    YuvConvert::convert_scale(src, dst, dst_stride, dst_w, dst_h);
+
+    gst_video_frame_unmap(&frame);
+    return true;
+}
+
+cairo_surface_t* MosaicRenderer::sample_surface(GstSample *sample) {
+    GstCaps *caps = gst_sample_get_caps(sample);
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    GstVideoInfo info;
+    if (!caps || !buffer || !gst_video_info_from_caps(&info, caps)) return nullptr;
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24,
+                                                          GST_VIDEO_INFO_WIDTH(&info), GST_VIDEO_INFO_HEIGHT(&info));
+    cairo_surface_flush(surface);
+    if (!convert_frame(info, buffer, cairo_image_surface_get_data(surface), cairo_image_surface_get_stride(surface),
+                       GST_VIDEO_INFO_WIDTH(&info), GST_VIDEO_INFO_HEIGHT(&info))) {
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+    cairo_surface_mark_dirty(surface);
+    return surface;
+}
+
+// Convierte y escala el frame directo a su celda del lienzo (manteniendo aspecto)
+void MosaicRenderer::render_tile(Tile *t, GstSample *sample, const GdkRectangle &cell) {
+    GstCaps *caps = gst_sample_get_caps(sample);
+    GstBuffer *buffer = gst_sample_get_buffer(sample);
+    if (!caps || !buffer) return;
+
+    GstVideoInfo info;
+    if (!gst_video_info_from_caps(&info, caps)) return;
+    if (GST_VIDEO_INFO_FORMAT(&info) != GST_VIDEO_FORMAT_I420 &&
+        GST_VIDEO_INFO_FORMAT(&info) != GST_VIDEO_FORMAT_NV12) return;
+
+    // Rectángulo dentro de la celda con el aspecto de la fuente
+    double src_aspect = (double)GST_VIDEO_INFO_WIDTH(&info) * GST_VIDEO_INFO_PAR_N(&info) /
+                        ((double)GST_VIDEO_INFO_HEIGHT(&info) * GST_VIDEO_INFO_PAR_D(&info));
+    int w = cell.width;
+    int h = (int)(w / src_aspect);
+    if (h > cell.height) {
+        h = cell.height;
+        w = (int)(h * src_aspect);
+    }
+    if (w <= 0 || h <= 0) return;
+    int x = cell.x + (cell.width - w) / 2;
+    int y = cell.y + (cell.height - h) / 2;
+
+    uint8_t *data = cairo_image_surface_get_data(canvas);
+    int stride = cairo_image_surface_get_stride(canvas);
+
+    // Cambió el aspecto de la fuente: limpiar las bandas de la celda
+    if (t->last_w != w || t->last_h != h) {
+        for (int row = cell.y; row < cell.y + cell.height; ++row)
+            memset(data + (size_t)row * stride + (size_t)cell.x * 4, 0, (size_t)cell.width * 4);
+        t->last_w = w;
+        t->last_h = h;
+    }
+
+    convert_frame(info, buffer, data + (size_t)y * stride + (size_t)x * 4, stride, w, h);
+}
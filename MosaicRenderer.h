@@ -0,0 +1,121 @@
+#ifndef MOSAICRENDERER_H
+#define MOSAICRENDERER_H
+
+#include <gtk/gtk.h>
+#include <gst/gst.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "LayoutConfig.h"
+
+// Sink propio del mosaico: cada slot entrega frames I420/NV12 (appsink) y el
+// widget los convierte y escala a su celda en una sola pasada (YuvConvert),
+// redibujando todo el mosaico como máximo una vez por tick del frame clock.
+// Cada tile es un buzón sin locks de un solo lugar: el frame más nuevo pisa
+// al que todavía no se mostró (coalescido).
+class MosaicRenderer {
+public:
+    // Tamaño de la celda de un slot en píxeles de dispositivo
+    using CellSizeCallback = std::function<void(int slot, int width, int height)>;
+
+    struct TileStats {
+        guint64 presented = 0;   // frames dibujados
+        guint64 coalesced = 0;   // frames pisados por uno más nuevo antes de dibujarse
+    };
+
+    MosaicRenderer();
+    ~MosaicRenderer();
+
+    GtkWidget* get_widget();
+
+    // Misma geometría que el GtkGrid. slot_ids[i] es el slot de la celda i.
+    void set_layout(const Layout &layout, const std::vector<int> &slot_ids);
+
+    // Último frame del slot (hilo de streaming). Toma la referencia de sample.
+    // Mientras el tile está en repetición solo se aceptan los frames de la
+    // repetición, y fuera de ella solo los del pipeline en vivo.
+    void publish(int slot, GstSample *sample, bool replay = false);
+    void clear(int slot);
+    // Slot sin señal: se sigue mostrando su último frame, atenuado (hilo de GTK)
+    void set_held(int slot, bool held);
+    // Tile mostrando una repetición en vez del vivo (hilo de GTK)
+    void set_replay(int slot, bool replay);
+    // Se llama al cambiar el layout o el tamaño del widget (hilo de GTK): los
+    // slots no tienen widget propio que les diga el tamaño de su tile
+    void set_cell_size_callback(CellSizeCallback cb) { cell_size_callback = cb; }
+    // Slot de la celda bajo el punto (coordenadas del widget), -1 si ninguno
+    int slot_at(int x, int y) const;
+
+    // Acumulados desde el último clear del slot (cualquier hilo)
+    TileStats stats(int slot);
+    // Redibujados del mosaico completo (hilo de GTK)
+    guint64 repaints() const { return repaint_count; }
+    // Copia del lienzo tal como se mostró, frame BGRx en píxeles de
+    // dispositivo (hilo de GTK). nullptr si todavía no se dibujó nada.
+    GstSample* snapshot();
+
+    // Tramo final para el pipeline de un slot (appsink "videosink")
+    static std::string sink_tail(bool fast);
+    // Conecta el appsink del pipeline con este renderer
+    void attach(GstElement *pipeline, int slot, bool replay = false);
+
+    // Frame I420/NV12 convertido a una superficie RGB24 de su tamaño (nullptr si no se puede)
+    static cairo_surface_t* sample_surface(GstSample *sample);
+    // Velo y sello "SIN SEÑAL hh:mm:ss" sobre un tile retenido
+    static void draw_hold(cairo_t *cr, double x, double y, double w, double h, const std::string &stamp);
+    // Hora local actual como hh:mm:ss
+    static std::string clock_stamp();
+
+private:
+    // Frame en el buzón, con la época del tile en que se publicó
+    struct Frame {
+        GstSample *sample;
+        guint epoch;
+    };
+    struct Tile {
+        std::atomic<Frame*> pending{nullptr};       // lo deja el streaming, lo retira GTK
+        // Bit 0: en repetición; el resto cuenta set_replay/clear. Escrita solo
+        // en el hilo de GTK: un frame de otra época ya no corresponde y se descarta.
+        std::atomic<guint> epoch{0};
+        bool replaying() const { return epoch.load(std::memory_order_acquire) & 1; }
+        std::atomic<guint64> presented{0};
+        std::atomic<guint64> coalesced{0};
+        GstSample *shown = nullptr;   // último frame dibujado, solo hilo de GTK
+        int last_w = 0, last_h = 0;   // solo hilo de GTK
+        bool held = false;            // solo hilo de GTK
+        std::string stamp;            // hora de la caída, solo hilo de GTK
+    };
+    struct AttachData {
+        MosaicRenderer *renderer;
+        int slot;
+        bool replay;
+    };
+
+    GtkWidget* area = nullptr;
+    guint tick_id = 0;
+    std::vector<Tile*> tiles;
+    Layout layout;
+    std::vector<int> cell_slots;
+    CellSizeCallback cell_size_callback;
+
+    // Lienzo persistente: cada tile se reescribe solo cuando llega un frame nuevo
+    cairo_surface_t* canvas = nullptr;
+    bool canvas_stale = true;
+    guint64 repaint_count = 0;
+
+    Tile* tile(int slot);
+    static void free_frame(Frame *frame);
+    // Nueva época (hilo de GTK): descarta el buzón y lo que llegue de la anterior
+    static void advance_epoch(Tile *t, bool replay);
+    void render_tile(Tile *t, GstSample *sample, const GdkRectangle &cell);
+    GdkRectangle cell_rect(int cell, int width, int height) const;
+    void report_cell_sizes();
+
+    static gboolean on_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data);
+    static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data);
+    static void on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer data);
+    static GstFlowReturn on_new_sample(GstElement *appsink, gpointer data);
+};
+
+#endif // MOSAICRENDERER_H
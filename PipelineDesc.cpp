@@ -0,0 +1,210 @@
+#include <cstdlib>
+#include "PipelineDesc.h"
+#include "FileSource.h"
+
+namespace PipelineDesc {
+
+// Servidor SRT: MOSAIC_SRT_SERVER o el de producción
+static std::string &srt_server_ref() {
+    static std::string server = std::getenv("MOSAIC_SRT_SERVER") ? std::getenv("MOSAIC_SRT_SERVER")
+                                                                  : "172.23.193.99:8080";
+    return server;
+}
+
+void set_srt_server(const std::string &host_port) {
+    srt_server_ref() = host_port;
+}
+
+const std::string& srt_server() {
+    return srt_server_ref();
+}
+
+static std::string srt_uri(const std::string &streamid) {
+    return "srt://" + srt_server() + "?streamid=" + streamid;
+}
+
+// === INGESTA UDP ===
+static std::string env_string(const char *name) {
+    const char *value = std::getenv(name);
+    return value ? value : "";
+}
+
+static bool &udp_ingest_ref() {
+    static bool enabled = env_string("MOSAIC_UDP_INGEST") == "1";
+    return enabled;
+}
+
+void set_udp_ingest(bool enabled) {
+    udp_ingest_ref() = enabled;
+}
+
+bool udp_ingest() {
+    return udp_ingest_ref();
+}
+
+int udp_recv_buffer() {
+    static int bytes = std::getenv("MOSAIC_UDP_RCVBUF") ? std::atoi(std::getenv("MOSAIC_UDP_RCVBUF"))
+                                                         : 8 * 1024 * 1024;
+    return bytes;
+}
+
+const std::string& udp_multicast_group() {
+    static std::string group = env_string("MOSAIC_UDP_GROUP");
+    return group;
+}
+
+const std::string& udp_multicast_iface() {
+    static std::string iface = env_string("MOSAIC_UDP_IFACE");
+    return iface;
+}
+
+static bool &rtp_demux_ref() {
+    static bool enabled = env_string("MOSAIC_RTP_DEMUX") == "1";
+    return enabled;
+}
+
+void set_rtp_demux(bool enabled) {
+    rtp_demux_ref() = enabled;
+}
+
+bool rtp_demux() {
+    return rtp_demux_ref();
+}
+
+int rtp_demux_port() {
+    static int port = std::getenv("MOSAIC_RTP_PORT") ? std::atoi(std::getenv("MOSAIC_RTP_PORT")) : 5000;
+    return port;
+}
+
+std::string udp_source(const std::string &port, const std::string &suffix) {
+    if (udp_ingest() || rtp_demux())
+        return "appsrc name=rtpsrc" + suffix + " is-live=true format=time do-timestamp=true "
+               "caps=\"application/x-rtp,media=video,clock-rate=90000,encoding-name=H264,payload=96\"";
+
+    std::string src = "udpsrc name=rtpsrc" + suffix + " port=" + port +
+                      " buffer-size=" + std::to_string(udp_recv_buffer());
+    if (!udp_multicast_group().empty()) {
+        src += " address=" + udp_multicast_group() + " auto-multicast=true";
+        if (!udp_multicast_iface().empty()) src += " multicast-iface=" + udp_multicast_iface();
+    }
+    return src;
+}
+
+// === ARCHIVO ===
+bool file_realtime() {
+    static bool realtime = env_string("MOSAIC_FILE_PACE") != "fast";
+    return realtime;
+}
+
+std::string file_decode_branch(const std::string &path, bool realtime, const std::string &suffix) {
+    std::string caps, parse;
+    switch (FileSource::probe(path)) {
+        case FileSource::Format::MPEGTS:
+            caps = "video/mpegts,systemstream=true,packetsize=188";
+            // Solo el pad de video, como en SRT
+            parse = "parsebin ! video/x-h264 ! queue name=decq" + suffix + " ! decodebin name=dec" + suffix;
+            break;
+        case FileSource::Format::RTP:
+            // Sin jitterbuffer: los paquetes salen en el orden y al ritmo de la captura
+            caps = "application/x-rtp,media=video,clock-rate=90000,encoding-name=H264,payload=96";
+            parse = "rtph264depay ! h264parse ! queue name=decq" + suffix + " ! avdec_h264 name=dec" + suffix;
+            break;
+        case FileSource::Format::H264:
+            caps = "video/x-h264,stream-format=byte-stream,alignment=au";
+            parse = "h264parse ! queue name=decq" + suffix + " ! avdec_h264 name=dec" + suffix;
+            break;
+        default:
+            return "";
+    }
+    return "appsrc name=filesrc" + suffix + " format=time do-timestamp=true is-live=" +
+           (realtime ? "true" : "false") + " caps=\"" + caps + "\" ! " + parse;
+}
+
+// === MODO SRT ===
+std::string srt_decode_branch(const std::string &streamid, const std::string &suffix) {
+    std::string uri = srt_uri(streamid);
+    // parsebin antes del decoder: separa el demux del decode. Las caps dejan
+    // enlazar solo el pad de video (un pad de audio del TS no llega al decoder)
+    return "srtclientsrc name=srtsrc" + suffix + " uri=" + uri + " ! parsebin ! video/x-h264 ! queue name=decq" + suffix + " ! decodebin name=dec" + suffix;
+}
+
+// === MODO UDP SAFE ===
+std::string udp_safe_decode_branch(const std::string &port, const std::string &suffix) {
+    // Latencia inicial holgada: JitterController la ajusta a la red real
+    return udp_source(port, suffix) + " ! "
+           "application/x-rtp,media=video,encoding-name=H264,payload=96 ! "
+           "rtpjitterbuffer name=jbuf" + suffix + " latency=100 drop-on-latency=false ! "
+           "rtph264depay ! h264parse ! queue name=decq" + suffix + " ! avdec_h264 name=dec" + suffix;
+}
+
+// === MODO UDP FAST ===
+std::string udp_fast_decode_branch(const std::string &port, const std::string &suffix) {
+    return udp_source(port, suffix) + " ! "
+           "application/x-rtp,media=video,encoding-name=H264,payload=96 ! "
+           "rtpjitterbuffer name=jbuf" + suffix + " latency=20 drop-on-latency=false ! "
+           "rtph264depay ! h264parse ! queue name=decq" + suffix + " ! avdec_h264 name=dec" + suffix;
+}
+
+std::string decode_branch(StreamMode mode, const std::string &streamid, const std::string &port,
+                          const std::string &suffix) {
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC: return srt_decode_branch(streamid, suffix);
+        case StreamMode::UDP_SAFE:   return udp_safe_decode_branch(port, suffix);
+        case StreamMode::UDP_FAST:   return udp_fast_decode_branch(port, suffix);
+    }
+    return "";
+}
+
+// === STANDBY ===
+int standby_pad_index(StreamMode mode) {
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC: return 0;
+        case StreamMode::UDP_SAFE:   return 1;
+        case StreamMode::UDP_FAST:   return 2;
+    }
+    return 0;
+}
+
+std::string standby_jbuf_name(StreamMode mode) {
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC: return "";
+        case StreamMode::UDP_SAFE:   return "jbuf_safe";
+        case StreamMode::UDP_FAST:   return "jbuf_fast";
+    }
+    return "";
+}
+
+std::string standby_pipeline(const std::string &streamid, const std::string &port,
+                             unsigned long budget_bytes, const std::string &tail) {
+    // H.264 en byte-stream con SPS/PPS en cada IDR: el decoder puede
+    // engancharse al cambiar de rama sin esperar parámetros en banda
+    const std::string to_selector =
+        " ! h264parse config-interval=-1 ! video/x-h264,stream-format=byte-stream,alignment=au"
+        " ! queue leaky=downstream max-size-buffers=0 max-size-time=0 max-size-bytes=" +
+        std::to_string(budget_bytes / 3);
+
+    std::string uri = srt_uri(streamid);
+
+    return "input-selector name=sel sync-streams=false cache-buffers=false ! queue name=decq ! avdec_h264 name=dec ! " + tail +
+        // SRT (solo el pad de video de parsebin)
+        " srtclientsrc name=srtsrc uri=" + uri + " ! parsebin ! video/x-h264" + to_selector + " ! sel.sink_0" +
+        // UDP: un solo socket compartido por SAFE y FAST
+        " " + udp_source(port) + " ! "
+        "application/x-rtp,media=video,encoding-name=H264,payload=96 ! tee name=udptee"
+        // Un jitterbuffer por rama, con la latencia inicial de su modo
+        " udptee. ! queue ! rtpjitterbuffer name=jbuf_safe latency=100 drop-on-latency=false ! rtph264depay" +
+        to_selector + " ! sel.sink_1"
+        " udptee. ! queue ! rtpjitterbuffer name=jbuf_fast latency=20 drop-on-latency=false ! rtph264depay" +
+        to_selector + " ! sel.sink_2";
+}
+
+const char* mode_name(StreamMode mode) {
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC: return "SRT Mosaico";
+        case StreamMode::UDP_SAFE:   return "UDP Safe";
+        case StreamMode::UDP_FAST:   return "UDP Fast";
+    }
+    return "?";
+}
+
+} // namespace PipelineDesc
@@ -0,0 +1,76 @@
+#ifndef PIPELINEDESC_H
+#define PIPELINEDESC_H
+
+#include <string>
+
+enum class StreamMode {
+    SRT_MOSAIC,
+    UDP_SAFE,   // antes UDP_MULTISTREAM
+    UDP_FAST,   // antes UDP_SINGLE
+};
+
+// Fragmentos de pipeline compartidos entre StreamSlot y MosaicCompositor.
+// Cada rama va desde la fuente hasta el video decodificado (video/x-raw),
+// el que la usa decide cómo convertir y mostrar. El decoder se llama
+// "dec" + suffix y siempre recibe video ya parseado (flags de keyframe válidos)
+// desde una cola "decq" + suffix: red y decode corren en hilos distintos.
+// En UDP la fuente de paquetes RTP es "rtpsrc" + suffix y el
+// jitterbuffer "jbuf" + suffix (latencia inicial: 100 ms en UDP_SAFE, 20 ms
+// en UDP_FAST; JitterController la adapta por slot).
+namespace PipelineDesc {
+
+    // host:puerto del servidor SRT (MOSAIC_SRT_SERVER o 172.23.193.99:8080)
+    void set_srt_server(const std::string &host_port);
+    const std::string& srt_server();
+
+    // === Ingesta UDP ===
+    // Con ingesta propia (MOSAIC_UDP_INGEST=1 o tecla I) "rtpsrc" es un appsrc
+    // que alimenta UdpIngest; si no, un udpsrc. Ambos con SO_RCVBUF de
+    // udp_recv_buffer() bytes (MOSAIC_UDP_RCVBUF, por defecto 8 MB) y, si hay
+    // grupo (MOSAIC_UDP_GROUP / MOSAIC_UDP_IFACE), unidos a ese multicast.
+    void set_udp_ingest(bool enabled);
+    bool udp_ingest();
+    int udp_recv_buffer();
+    const std::string& udp_multicast_group();
+    const std::string& udp_multicast_iface();
+    std::string udp_source(const std::string &port, const std::string &suffix = "");
+
+    // === Demux RTP ===
+    // Con demux (MOSAIC_RTP_DEMUX=1 o tecla D) todas las fuentes llegan a un
+    // único puerto (MOSAIC_RTP_PORT, por defecto 5000) y RtpDemux reparte
+    // los paquetes por SSRC a los "rtpsrc" (appsrc); el puerto de cada
+    // fuente solo la identifica.
+    void set_rtp_demux(bool enabled);
+    bool rtp_demux();
+    int rtp_demux_port();
+
+    // === Archivo ===
+    // Fuente grabada (FileSource) en el appsrc "filesrc" + suffix, con la
+    // cadena de parseo de su formato. A ritmo real (MOSAIC_FILE_PACE distinto
+    // de "fast") el appsrc es live como una fuente de red. Vacío si el
+    // archivo no se puede leer o su formato no se reconoce.
+    bool file_realtime();
+    std::string file_decode_branch(const std::string &path, bool realtime, const std::string &suffix = "");
+
+    std::string srt_decode_branch(const std::string &streamid, const std::string &suffix = "");
+    std::string udp_safe_decode_branch(const std::string &port, const std::string &suffix = "");
+    std::string udp_fast_decode_branch(const std::string &port, const std::string &suffix = "");
+
+    // Rama según el modo (usa streamid en SRT y port en UDP)
+    std::string decode_branch(StreamMode mode, const std::string &streamid, const std::string &port,
+                              const std::string &suffix = "");
+
+    // === Standby ===
+    // Las tres fuentes quedan conectadas y parseadas detrás de un
+    // input-selector ("sel"); solo la rama activa llega al decoder.
+    // Cada rama tiene una cola acotada a budget_bytes / 3. Las ramas UDP
+    // tienen cada una su jitterbuffer (standby_jbuf_name; SRT no tiene).
+    int standby_pad_index(StreamMode mode);
+    std::string standby_jbuf_name(StreamMode mode);
+    std::string standby_pipeline(const std::string &streamid, const std::string &port,
+                                 unsigned long budget_bytes, const std::string &tail);
+
+    const char* mode_name(StreamMode mode);
+}
+
+#endif // PIPELINEDESC_H
@@ -0,0 +1,137 @@
+#include <cstdio>
+#include "ProcStats.h"
+
+#ifdef G_OS_WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#else
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ProcStats {
+
+gint64 cpu_time_us() {
+#ifdef G_OS_WIN32
+    FILETIME creation, exit_time, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit_time, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    // FILETIME en unidades de 100 ns
+    return (gint64)((k.QuadPart + u.QuadPart) / 10);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (gint64)usage.ru_utime.tv_sec * G_USEC_PER_SEC + usage.ru_utime.tv_usec +
+           (gint64)usage.ru_stime.tv_sec * G_USEC_PER_SEC + usage.ru_stime.tv_usec;
+#endif
+}
+
+int cpu_count() {
+    return (int)g_get_num_processors();
+}
+
+guint64 rss_bytes() {
+#ifdef G_OS_WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return (guint64)counters.WorkingSetSize;
+#else
+    // /proc/self/statm: tamaño total y residente, en páginas
+    gchar *contents = nullptr;
+    if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL))
+        return 0;
+    unsigned long size = 0, resident = 0;
+    int fields = sscanf(contents, "%lu %lu", &size, &resident);
+    g_free(contents);
+    return fields == 2 ? (guint64)resident * (guint64)sysconf(_SC_PAGESIZE) : 0;
+#endif
+}
+
+int thread_count() {
+#ifdef G_OS_WIN32
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE)
+        return -1;
+    DWORD pid = GetCurrentProcessId();
+    int count = 0;
+    THREADENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry))
+        if (entry.th32OwnerProcessID == pid) count++;
+    CloseHandle(snapshot);
+    return count;
+#else
+    GDir *dir = g_dir_open("/proc/self/task", 0, NULL);
+    if (!dir)
+        return -1;
+    int count = 0;
+    while (g_dir_read_name(dir)) count++;
+    g_dir_close(dir);
+    return count;
+#endif
+}
+
+int open_fds() {
+#ifdef G_OS_WIN32
+    DWORD handles = 0;
+    if (!GetProcessHandleCount(GetCurrentProcess(), &handles))
+        return -1;
+    return (int)handles;
+#else
+    GDir *dir = g_dir_open("/proc/self/fd", 0, NULL);
+    if (!dir)
+        return -1;
+    int count = 0;
+    while (g_dir_read_name(dir)) count++;
+    g_dir_close(dir);
+    // El propio directorio abierto aparece en la lista
+    return count - 1;
+#endif
+}
+
+bool udp_socket_stats(int fd, guint64 *drops, guint64 *queue_bytes) {
+#ifdef G_OS_WIN32
+    return false;
+#else
+    // El socket se identifica por su inodo (varios pueden compartir el puerto)
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+        return false;
+
+    const char *files[] = {"/proc/net/udp", "/proc/net/udp6"};
+    for (const char *file : files) {
+        gchar *contents = nullptr;
+        if (!g_file_get_contents(file, &contents, NULL, NULL))
+            continue;
+
+        bool found = false;
+        gchar **lines = g_strsplit(contents, "\n", -1);
+        // sl local rem st tx:rx tr:tm retrnsmt uid timeout inode ref pointer drops
+        for (int i = 1; lines[i] && !found; ++i) {
+            unsigned long rx_queue = 0, inode = 0;
+            unsigned long long dropped = 0;
+            if (sscanf(lines[i], " %*d: %*s %*s %*x %*x:%lx %*x:%*x %*x %*u %*d %lu %*d %*s %llu",
+                       &rx_queue, &inode, &dropped) == 3 && inode == (unsigned long)st.st_ino) {
+                *drops = dropped;
+                *queue_bytes = rx_queue;
+                found = true;
+            }
+        }
+        g_strfreev(lines);
+        g_free(contents);
+        if (found) return true;
+    }
+    return false;
+#endif
+}
+
+} // namespace ProcStats
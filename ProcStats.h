@@ -0,0 +1,29 @@
+#ifndef PROCSTATS_H
+#define PROCSTATS_H
+
+#include <glib.h>
+
+// Consumo de recursos del propio proceso (Linux / Windows)
+namespace ProcStats {
+
+    // Tiempo de CPU (usuario + sistema) consumido por el proceso, en µs
+    gint64 cpu_time_us();
+
+    // Número de CPUs lógicas disponibles
+    int cpu_count();
+
+    // Memoria residente del proceso en bytes (0 si no se puede leer)
+    guint64 rss_bytes();
+
+    // Hilos vivos del proceso (-1 si no se puede leer)
+    int thread_count();
+
+    // Descriptores abiertos (Linux) o handles (Windows) del proceso (-1 si no se puede leer)
+    int open_fds();
+
+    // Contadores del kernel de un socket UDP propio (Linux: /proc/net/udp y udp6):
+    // datagramas descartados por cola llena y bytes en cola. false si no se encuentra.
+    bool udp_socket_stats(int fd, guint64 *drops, guint64 *queue_bytes);
+}
+
+#endif // PROCSTATS_H
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include "Reconnector.h"
+
+// Backoff: 250 ms duplicando hasta 10 s, con ±25% de jitter para que los
+// slots que cayeron juntos (mismo enlace) no reintenten todos a la vez
+static const guint kBackoffBaseMs = 250;
+static const guint kBackoffMaxMs = 10000;
+// Reinicios solo de la fuente antes de reconstruir el pipeline completo
+static const guint kSourceRetries = 3;
+// Sin primer frame tras un intento: cuenta como falla nueva
+static const guint kFirstFrameTimeoutMs = 8000;
+
+Reconnector::Reconnector(ActionCallback callback) : callback(callback) {}
+
+Reconnector::~Reconnector() {
+    cancel_timers();
+}
+
+Reconnector::Failure Reconnector::classify(GstMessage *msg, std::string *element) {
+    GError *err = nullptr;
+    gst_message_parse_error(msg, &err, NULL);
+    Failure failure = Failure::FATAL;
+    if (err && err->domain == GST_RESOURCE_ERROR) failure = Failure::SOURCE;
+    else if (err && err->domain == GST_STREAM_ERROR) failure = Failure::STREAM;
+    if (err) g_error_free(err);
+
+    // Solo las fuentes (srtclientsrc, udpsrc) se pueden reiniciar por separado
+    GstObject *src = GST_MESSAGE_SRC(msg);
+    bool from_source = src && GST_IS_ELEMENT(src) && GST_OBJECT_FLAG_IS_SET(src, GST_ELEMENT_FLAG_SOURCE);
+    if (element) *element = from_source ? GST_OBJECT_NAME(src) : "";
+
+    // "Internal data stream error" de una fuente: falló algo río abajo
+    if (from_source && failure == Failure::STREAM) failure = Failure::FATAL;
+    return failure;
+}
+
+const char* Reconnector::state_name(State state) {
+    switch (state) {
+        case State::IDLE:       return "detenido";
+        case State::CONNECTING: return "conectando";
+        case State::LIVE:       return "en vivo";
+        case State::STALLED:    return "sin señal";
+        case State::BACKOFF:    return "reintento";
+    }
+    return "?";
+}
+
+const char* Reconnector::failure_name(Failure failure) {
+    switch (failure) {
+        case Failure::SOURCE: return "fuente";
+        case Failure::STREAM: return "stream";
+        case Failure::FATAL:  return "fatal";
+        case Failure::END:    return "fin de stream";
+        case Failure::STALL:  return "sin frames";
+    }
+    return "?";
+}
+
+void Reconnector::on_launch() {
+    // Relanzado por un reintento: sigue siendo la misma caída
+    if (in_action) return;
+
+    cancel_timers();
+    attempts = source_attempts = 0;
+    outage_start_us = attempt_start_us = 0;
+    current = State::CONNECTING;
+}
+
+void Reconnector::on_failure(Failure failure, const std::string &element, const char *detail) {
+    if (current == State::IDLE) return;
+
+    // Ya hay un reintento programado: a lo sumo se escala a pipeline completo
+    if (current == State::BACKOFF) {
+        if (failure == Failure::STREAM || failure == Failure::FATAL) pending_action = Action::REBUILD;
+        return;
+    }
+
+    if (!outage_start_us) outage_start_us = g_get_monotonic_time();
+    g_print("[Reconnector] %s: falla (%s)%s%s\n", label.c_str(), failure_name(failure),
+            detail ? ": " : "", detail ? detail : "");
+
+    // udpsrc sigue escuchando el puerto: reconectar no cambia nada
+    if (failure == Failure::STALL && connectionless) {
+        cancel_timers();
+        current = State::STALLED;
+        return;
+    }
+
+    bool source_only = (failure == Failure::SOURCE || failure == Failure::END || failure == Failure::STALL) &&
+                       !element.empty() && source_attempts < kSourceRetries;
+    schedule(source_only ? Action::RESTART_SOURCE : Action::REBUILD, element);
+}
+
+void Reconnector::on_first_frame() {
+    if (outage_start_us) {
+        finish_recovery("reconectado");
+        return;
+    }
+    if (deadline_timer) g_source_remove(deadline_timer);
+    deadline_timer = 0;
+    if (current != State::IDLE) current = State::LIVE;
+}
+
+void Reconnector::on_recovered() {
+    if (outage_start_us && (current == State::STALLED || current == State::BACKOFF))
+        finish_recovery("sin reconectar");
+}
+
+void Reconnector::stop() {
+    cancel_timers();
+    attempts = source_attempts = 0;
+    outage_start_us = attempt_start_us = 0;
+    current = State::IDLE;
+}
+
+void Reconnector::schedule(Action action, const std::string &element) {
+    cancel_timers();
+    pending_action = action;
+    pending_element = element;
+    current = State::BACKOFF;
+
+    guint delay = backoff_ms();
+    g_print("[Reconnector] %s: %s en %u ms (intento %u)\n", label.c_str(),
+            action == Action::RESTART_SOURCE ? "reinicio de la fuente" : "pipeline completo",
+            delay, attempts + 1);
+    retry_timer = g_timeout_add(delay, &Reconnector::on_retry, this);
+}
+
+void Reconnector::finish_recovery(const char *how) {
+    gint64 now = g_get_monotonic_time();
+    recovery_ms = (now - outage_start_us) / 1000.0;
+    if (attempt_start_us)
+        g_print("[Reconnector] %s: %s, primer frame %.1f ms después de la falla (%.1f ms desde el intento %u)\n",
+                label.c_str(), how, recovery_ms, (now - attempt_start_us) / 1000.0, attempts);
+    else
+        g_print("[Reconnector] %s: %s, primer frame %.1f ms después de la falla\n",
+                label.c_str(), how, recovery_ms);
+
+    cancel_timers();
+    attempts = source_attempts = 0;
+    outage_start_us = attempt_start_us = 0;
+    current = State::LIVE;
+}
+
+void Reconnector::cancel_timers() {
+    if (retry_timer) g_source_remove(retry_timer);
+    if (deadline_timer) g_source_remove(deadline_timer);
+    retry_timer = deadline_timer = 0;
+}
+
+guint Reconnector::backoff_ms() const {
+    guint base = kBackoffBaseMs << std::min(attempts, 6u);
+    base = std::min(base, kBackoffMaxMs);
+    return (guint)(base * g_random_double_range(0.75, 1.25));
+}
+
+gboolean Reconnector::on_retry(gpointer data) {
+    Reconnector *self = static_cast<Reconnector *>(data);
+    self->retry_timer = 0;
+
+    self->attempts++;
+    self->total_attempts++;
+    if (self->pending_action == Action::RESTART_SOURCE) self->source_attempts++;
+    else self->source_attempts = 0;
+
+    self->current = State::CONNECTING;
+    self->attempt_start_us = g_get_monotonic_time();
+    self->deadline_timer = g_timeout_add(kFirstFrameTimeoutMs, &Reconnector::on_deadline, self);
+
+    Action action = self->pending_action;
+    std::string element = self->pending_element;
+    self->in_action = true;
+    self->callback(action, element);
+    self->in_action = false;
+    return G_SOURCE_REMOVE;
+}
+
+gboolean Reconnector::on_deadline(gpointer data) {
+    Reconnector *self = static_cast<Reconnector *>(data);
+    self->deadline_timer = 0;
+    self->on_failure(Failure::STALL, self->pending_element, "sin frames después del reintento");
+    return G_SOURCE_REMOVE;
+}
@@ -0,0 +1,81 @@
+#ifndef RECONNECTOR_H
+#define RECONNECTOR_H
+
+#include <gst/gst.h>
+#include <functional>
+#include <string>
+
+// Reconexión automática de un slot (hilo principal). Cada falla se clasifica
+// y se reintenta con backoff exponencial con jitter: primero reiniciando solo
+// la fuente de red (srtclientsrc/udpsrc) y, si eso no alcanza, el pipeline
+// completo. Mide el tiempo desde la falla hasta el primer frame recuperado.
+class Reconnector {
+public:
+    enum class State { IDLE, CONNECTING, LIVE, STALLED, BACKOFF };
+    enum class Failure {
+        SOURCE,   // red/recurso de la fuente: conexión rechazada, caída, timeout
+        STREAM,   // datos inválidos en demux/parse/decode
+        FATAL,    // el resto: negociación, plugins, recursos locales
+        END,      // EOS: el emisor cerró la conexión
+        STALL,    // watchdog o intento sin frames
+    };
+    enum class Action { RESTART_SOURCE, REBUILD };
+    // element: fuente a reiniciar (RESTART_SOURCE)
+    using ActionCallback = std::function<void(Action action, const std::string &element)>;
+
+    explicit Reconnector(ActionCallback callback);
+    ~Reconnector();
+
+    // Clasifica un GST_MESSAGE_ERROR; element recibe el nombre de la fuente
+    // que lo emitió (vacío si el error no viene de una fuente)
+    static Failure classify(GstMessage *msg, std::string *element);
+    static const char* state_name(State state);
+    static const char* failure_name(Failure failure);
+
+    void set_label(const std::string &text) { label = text; }
+    // UDP no tiene conexión: sin frames se espera al emisor en vez de reconectar
+    void set_connectionless(bool value) { connectionless = value; }
+
+    // Pipeline nuevo de un init_* (fuera de un reintento reinicia el backoff)
+    void on_launch();
+    void on_failure(Failure failure, const std::string &element, const char *detail);
+    // Primer frame después de un launch o de un reintento
+    void on_first_frame();
+    // El watchdog volvió a ver frames sin que hiciera falta reconectar
+    void on_recovered();
+    // Slot detenido: cancela el reintento pendiente
+    void stop();
+
+    State state() const { return current; }
+    guint reconnects() const { return total_attempts; }
+    double last_recovery_ms() const { return recovery_ms; }
+
+private:
+    ActionCallback callback;
+    std::string label;
+    bool connectionless = false;
+
+    State current = State::IDLE;
+    Action pending_action = Action::RESTART_SOURCE;
+    std::string pending_element;
+    guint retry_timer = 0;
+    guint deadline_timer = 0;
+    bool in_action = false;
+
+    guint attempts = 0;          // intentos consecutivos sin recuperar (backoff)
+    guint source_attempts = 0;   // de esos, reinicios solo de la fuente
+    guint total_attempts = 0;
+    gint64 outage_start_us = 0;  // primera falla de la caída actual
+    gint64 attempt_start_us = 0;
+    double recovery_ms = 0.0;
+
+    void schedule(Action action, const std::string &element);
+    void finish_recovery(const char *how);
+    void cancel_timers();
+    guint backoff_ms() const;
+
+    static gboolean on_retry(gpointer data);
+    static gboolean on_deadline(gpointer data);
+};
+
+#endif // RECONNECTOR_H
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cstdlib>
+#include "ReplayBuffer.h"
+
+static int env_int(const char *name, int fallback) {
+    const char *value = g_getenv(name);
+    return value ? atoi(value) : fallback;
+}
+
+ReplayBuffer::ReplayBuffer() {
+    g_mutex_init(&lock);
+    max_us = (gint64)std::max(1, env_int("MOSAIC_REPLAY_SECONDS", 30)) * G_USEC_PER_SEC;
+    max_bytes = (gsize)std::max(1, env_int("MOSAIC_REPLAY_MB", 32)) * 1024 * 1024;
+}
+
+ReplayBuffer::~ReplayBuffer() {
+    detach();
+    clear_locked();
+    g_mutex_clear(&lock);
+}
+
+void ReplayBuffer::clear_locked() {
+    for (Gop &gop : gops)
+        for (Frame &frame : gop.frames) gst_buffer_unref(frame.buffer);
+    gops.clear();
+    total_bytes = 0;
+    if (caps) gst_caps_unref(caps);
+    caps = nullptr;
+}
+
+void ReplayBuffer::set_source(const std::string &key) {
+    if (key == source_key) return;
+    source_key = key;
+    g_mutex_lock(&lock);
+    clear_locked();
+    g_mutex_unlock(&lock);
+}
+
+// ===== Probe (hilo de streaming) =====
+
+void ReplayBuffer::attach(GstElement *pipeline) {
+    detach();
+    GstElement *decq = gst_bin_get_by_name(GST_BIN(pipeline), "decq");
+    if (!decq) return;
+    g_mutex_lock(&lock);
+    epoch++;
+    g_mutex_unlock(&lock);
+    probe_pad = gst_element_get_static_pad(decq, "sink");
+    if (probe_pad) {
+        probe_id = gst_pad_add_probe(probe_pad,
+                                     (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM),
+                                     &ReplayBuffer::input_probe_cb, this, NULL);
+    }
+    gst_object_unref(decq);
+}
+
+void ReplayBuffer::detach() {
+    if (probe_pad) {
+        gst_pad_remove_probe(probe_pad, probe_id);
+        gst_object_unref(probe_pad);
+    }
+    probe_pad = nullptr;
+    probe_id = 0;
+}
+
+GstPadProbeReturn ReplayBuffer::input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    ReplayBuffer *self = static_cast<ReplayBuffer *>(user_data);
+
+    if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+        self->on_input(GST_PAD_PROBE_INFO_BUFFER(info));
+        return GST_PAD_PROBE_OK;
+    }
+
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_CAPS) {
+        GstCaps *new_caps;
+        gst_event_parse_caps(event, &new_caps);
+        self->on_caps(new_caps);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+void ReplayBuffer::on_caps(GstCaps *new_caps) {
+    g_mutex_lock(&lock);
+    // Otro formato (avc/byte-stream, resolución): lo anterior ya no se puede decodificar junto
+    if (!caps || !gst_caps_is_equal(caps, new_caps)) {
+        clear_locked();
+        caps = gst_caps_ref(new_caps);
+    }
+    g_mutex_unlock(&lock);
+}
+
+void ReplayBuffer::on_input(GstBuffer *buffer) {
+    bool key = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    gint64 now = g_get_monotonic_time();
+    gsize size = gst_buffer_get_size(buffer);
+
+    std::vector<GstBuffer*> evicted;
+    g_mutex_lock(&lock);
+    // Un delta de otro pipeline no continúa el GOP anterior
+    if (caps && (key || (!gops.empty() && gops.back().epoch == epoch))) {
+        if (key) {
+            gops.emplace_back();
+            gops.back().epoch = epoch;
+        }
+        Gop &gop = gops.back();
+        gop.frames.push_back({gst_buffer_ref(buffer), now});
+        gop.bytes += size;
+        total_bytes += size;
+
+        // Siempre queda al menos el GOP en curso
+        while (gops.size() > 1 &&
+               (total_bytes > max_bytes || now - gops[1].frames.front().arrival_us > max_us)) {
+            for (Frame &frame : gops.front().frames) evicted.push_back(frame.buffer);
+            total_bytes -= gops.front().bytes;
+            gops.pop_front();
+        }
+    }
+    g_mutex_unlock(&lock);
+
+    for (GstBuffer *old : evicted) gst_buffer_unref(old);
+}
+
+// ===== Lectura (hilo principal) =====
+
+bool ReplayBuffer::take_clip(int seconds, Clip *clip) {
+    g_mutex_lock(&lock);
+    if (!caps || gops.empty()) {
+        g_mutex_unlock(&lock);
+        return false;
+    }
+
+    // Último GOP que empieza antes del punto pedido; si el anillo es más
+    // corto, el primero del pipeline actual
+    gint64 newest = gops.back().frames.back().arrival_us;
+    gint64 wanted = newest - (gint64)seconds * G_USEC_PER_SEC;
+    size_t first = gops.size() - 1;
+    while (first > 0 && gops[first - 1].epoch == gops.back().epoch &&
+           gops[first].frames.front().arrival_us > wanted)
+        first--;
+
+    const Frame &start = gops[first].frames.front();
+    GstClockTime base = GST_BUFFER_DTS_OR_PTS(start.buffer);
+    clip->caps = gst_caps_ref(caps);
+    clip->seconds = (newest - start.arrival_us) / 1e6;
+
+    for (size_t i = first; i < gops.size(); ++i) {
+        for (const Frame &frame : gops[i].frames) {
+            // Copia liviana (comparte la memoria) con los tiempos corridos al inicio del clip
+            GstBuffer *out = gst_buffer_copy(frame.buffer);
+            if (GST_CLOCK_TIME_IS_VALID(base)) {
+                GstClockTime pts = GST_BUFFER_PTS(out), dts = GST_BUFFER_DTS(out);
+                GST_BUFFER_PTS(out) = GST_CLOCK_TIME_IS_VALID(pts) && pts >= base ? pts - base : GST_CLOCK_TIME_NONE;
+                GST_BUFFER_DTS(out) = GST_CLOCK_TIME_IS_VALID(dts) && dts >= base ? dts - base : GST_CLOCK_TIME_NONE;
+            } else {
+                // Sin timestamps de origen: se reproduce al ritmo de llegada
+                GST_BUFFER_PTS(out) = (GstClockTime)(frame.arrival_us - start.arrival_us) * GST_USECOND;
+                GST_BUFFER_DTS(out) = GST_CLOCK_TIME_NONE;
+            }
+            clip->buffers.push_back(out);
+        }
+    }
+    g_mutex_unlock(&lock);
+    return true;
+}
+
+void ReplayBuffer::free_clip(Clip *clip) {
+    for (GstBuffer *buffer : clip->buffers) gst_buffer_unref(buffer);
+    clip->buffers.clear();
+    if (clip->caps) gst_caps_unref(clip->caps);
+    clip->caps = nullptr;
+}
+
+double ReplayBuffer::buffered_seconds() {
+    g_mutex_lock(&lock);
+    double seconds = gops.empty() ? 0.0
+        : (gops.back().frames.back().arrival_us - gops.front().frames.front().arrival_us) / 1e6;
+    g_mutex_unlock(&lock);
+    return seconds;
+}
+
+guint64 ReplayBuffer::buffered_bytes() {
+    g_mutex_lock(&lock);
+    guint64 bytes = total_bytes;
+    g_mutex_unlock(&lock);
+    return bytes;
+}
@@ -0,0 +1,73 @@
+#ifndef REPLAYBUFFER_H
+#define REPLAYBUFFER_H
+
+#include <gst/gst.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Repetición instantánea de un slot: anillo en memoria con el video
+// comprimido (ya parseado) que entra a "decq", en GOPs completos desde un
+// keyframe. No copia ni recodifica: guarda referencias a los mismos buffers
+// que van al decoder. Se descarta lo más viejo al pasar de max_seconds o de
+// max_bytes (MOSAIC_REPLAY_SECONDS, por defecto 30; MOSAIC_REPLAY_MB, por
+// defecto 32 por slot).
+class ReplayBuffer {
+public:
+    // Tramo para reproducir: caps del stream y buffers con timestamps desde 0
+    struct Clip {
+        GstCaps *caps = nullptr;
+        std::vector<GstBuffer*> buffers;
+        double seconds = 0.0;
+    };
+
+    ReplayBuffer();
+    ~ReplayBuffer();
+
+    // Fuente del slot (modo + streamid/puerto). Si cambia, se vacía el anillo.
+    void set_source(const std::string &key);
+    // Probe en la entrada de "decq" del pipeline (y fuera del anterior). Los
+    // timestamps de un pipeline nuevo no siguen a los del anterior: un clip
+    // no cruza pipelines.
+    void attach(GstElement *pipeline);
+    void detach();
+
+    // Los últimos seconds (como mínimo), desde el keyframe anterior. false
+    // si todavía no llegó ningún keyframe. El llamador libera con free_clip.
+    bool take_clip(int seconds, Clip *clip);
+    static void free_clip(Clip *clip);
+
+    // Hilo principal (HUD): segundos y bytes retenidos
+    double buffered_seconds();
+    guint64 buffered_bytes();
+
+private:
+    struct Frame {
+        GstBuffer *buffer;
+        gint64 arrival_us;
+    };
+    struct Gop {
+        std::vector<Frame> frames;
+        gsize bytes = 0;
+        int epoch = 0;            // pipeline del que vino
+    };
+
+    GMutex lock;
+    std::deque<Gop> gops;         // protegido por lock
+    GstCaps *caps = nullptr;      // protegido por lock
+    gsize total_bytes = 0;        // protegido por lock
+    int epoch = 0;                // protegido por lock
+    std::string source_key;       // solo hilo principal
+    GstPad *probe_pad = nullptr;  // solo hilo principal
+    gulong probe_id = 0;
+    gint64 max_us;
+    gsize max_bytes;
+
+    void clear_locked();
+    void on_caps(GstCaps *new_caps);
+    void on_input(GstBuffer *buffer);
+
+    static GstPadProbeReturn input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+};
+
+#endif // REPLAYBUFFER_H
@@ -0,0 +1,230 @@
+#include <cstring>
+#include "RtpDemux.h"
+#include "PipelineDesc.h"
+
+// Sin paquetes durante este tiempo el SSRC deja libre su fuente
+static const gint64 kRouteTimeoutUs = 5 * G_USEC_PER_SEC;
+
+RtpDemux& RtpDemux::instance() {
+    static RtpDemux demux;
+    return demux;
+}
+
+RtpDemux::RtpDemux() {
+    g_mutex_init(&lock);
+}
+
+RtpDemux::~RtpDemux() {
+    shutdown();
+    for (Output &out : outputs) gst_object_unref(out.appsrc);
+    outputs.clear();
+    g_mutex_clear(&lock);
+}
+
+void RtpDemux::set_rules(const std::vector<SourceDesc> &sources) {
+    std::vector<Rule> parsed;
+    for (const SourceDesc &source : sources) {
+        if (source.rtp.empty()) continue;
+        bool by_ssrc = g_str_has_prefix(source.rtp.c_str(), "ssrc=");
+        if (!by_ssrc && !g_str_has_prefix(source.rtp.c_str(), "pt=")) {
+            g_printerr("[RtpDemux] Regla inválida en la fuente %s: %s\n", source.name.c_str(), source.rtp.c_str());
+            continue;
+        }
+        const char *value = strchr(source.rtp.c_str(), '=') + 1;
+        parsed.push_back({source.port, by_ssrc, (guint32)g_ascii_strtoull(value, NULL, 0)});
+    }
+
+    g_mutex_lock(&lock);
+    rules = parsed;
+    routes.clear();
+    rejected.clear();
+    g_mutex_unlock(&lock);
+}
+
+int RtpDemux::attach(GstElement *pipeline, const std::string &name, const std::string &key) {
+    if (!pipeline) return 0;
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name.c_str());
+    if (!element) return 0;
+    if (strcmp(G_OBJECT_TYPE_NAME(element), "GstAppSrc") != 0) {
+        gst_object_unref(element);
+        return 0;
+    }
+
+    // El socket se abre con la primera salida y queda abierto entre reconstrucciones
+    if (!ingest) {
+        ingest = new UdpIngest();
+        if (!ingest->start(PipelineDesc::rtp_demux_port(),
+                           [this](GstBuffer **buffers, int count) { on_batch(buffers, count); })) {
+            delete ingest;
+            ingest = nullptr;
+            gst_object_unref(element);
+            return 0;
+        }
+        g_print("[RtpDemux] Recibiendo todas las fuentes RTP en el puerto %d\n", PipelineDesc::rtp_demux_port());
+    }
+
+    g_mutex_lock(&lock);
+    int id = next_id++;
+    outputs.push_back({id, key, element});
+    // Hay una fuente más: los SSRC rechazados pueden tener lugar
+    rejected.clear();
+    g_mutex_unlock(&lock);
+    return id;
+}
+
+void RtpDemux::detach(int id) {
+    GstElement *appsrc = nullptr;
+    g_mutex_lock(&lock);
+    for (auto it = outputs.begin(); it != outputs.end(); ++it) {
+        if (it->id != id) continue;
+        appsrc = it->appsrc;
+        outputs.erase(it);
+        break;
+    }
+    g_mutex_unlock(&lock);
+    // Fuera del lock: el hilo de la ingesta ya no lo ve
+    if (appsrc) gst_object_unref(appsrc);
+}
+
+void RtpDemux::shutdown() {
+    if (ingest) {
+        ingest->stop();
+        delete ingest;
+        ingest = nullptr;
+        g_print("[RtpDemux] Puerto %d cerrado\n", PipelineDesc::rtp_demux_port());
+    }
+    g_mutex_lock(&lock);
+    routes.clear();
+    rejected.clear();
+    unrouted = 0;
+    g_mutex_unlock(&lock);
+}
+
+bool RtpDemux::stats(const std::string &key, Stats *out) {
+    g_mutex_lock(&lock);
+    bool found = output_for(key) != nullptr;
+    if (found) {
+        *out = Stats();
+        out->unrouted = unrouted;
+        for (const auto &entry : routes) {
+            if (entry.second.key != key) continue;
+            out->assigned = true;
+            out->ssrc = entry.first;
+            out->packets = entry.second.packets;
+            out->app_dropped = entry.second.app_dropped;
+            break;
+        }
+    }
+    g_mutex_unlock(&lock);
+
+    if (found && ingest) out->socket = ingest->stats();
+    return found;
+}
+
+// ===== Ruteo (hilo de la ingesta) =====
+
+// Payload type y SSRC de un paquete RTP v2; los RTCP multiplexados no se rutean
+static bool parse_rtp(GstBuffer *buffer, guint32 *ssrc, int *pt) {
+    guint8 header[12];
+    if (gst_buffer_extract(buffer, 0, header, sizeof(header)) != sizeof(header)) return false;
+    if ((header[0] >> 6) != 2) return false;
+    if (header[1] >= 200 && header[1] <= 204) return false;
+    *pt = header[1] & 0x7f;
+    *ssrc = GST_READ_UINT32_BE(header + 8);
+    return true;
+}
+
+void RtpDemux::on_batch(GstBuffer **buffers, int count) {
+    gint64 now = g_get_monotonic_time();
+
+    // Un lock por lote: las salidas no cambian mientras se entrega
+    g_mutex_lock(&lock);
+    if (now - last_expire_us > G_USEC_PER_SEC) {
+        expire_routes(now);
+        last_expire_us = now;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        guint32 ssrc = 0;
+        int pt = 0;
+        Route *route = parse_rtp(buffers[i], &ssrc, &pt) ? route_for(ssrc, pt) : nullptr;
+        GstElement *appsrc = route ? output_for(route->key) : nullptr;
+        if (route) route->last_seen_us = now;
+        if (!appsrc) {
+            // Fuente con regla pero fuera de pantalla, o sin fuente libre
+            unrouted++;
+            gst_buffer_unref(buffers[i]);
+            continue;
+        }
+        route->packets++;
+        if (!UdpIngest::push(appsrc, buffers[i])) route->app_dropped++;
+    }
+    g_mutex_unlock(&lock);
+}
+
+RtpDemux::Route* RtpDemux::route_for(guint32 ssrc, int pt) {
+    auto it = routes.find(ssrc);
+    if (it != routes.end()) return &it->second;
+    if (rejected.count(ssrc)) return nullptr;
+
+    // Regla por SSRC, después por payload type (si esa fuente no tiene ya emisor)
+    std::string key;
+    for (const Rule &rule : rules)
+        if (rule.by_ssrc && rule.value == ssrc) {
+            key = rule.key;
+            break;
+        }
+    for (size_t i = 0; key.empty() && i < rules.size(); ++i)
+        if (!rules[i].by_ssrc && rules[i].value == (guint32)pt && !key_taken(rules[i].key))
+            key = rules[i].key;
+
+    // Sin regla: primera fuente registrada libre (las fuentes con regla esperan la suya)
+    for (size_t i = 0; key.empty() && i < outputs.size(); ++i)
+        if (!has_rule(outputs[i].key) && !key_taken(outputs[i].key))
+            key = outputs[i].key;
+
+    if (key.empty()) {
+        rejected.insert(ssrc);
+        g_print("[RtpDemux] SSRC 0x%08x (pt %d): no hay una fuente libre, se descarta\n", ssrc, pt);
+        return nullptr;
+    }
+
+    g_print("[RtpDemux] SSRC 0x%08x (pt %d) -> fuente del puerto %s\n", ssrc, pt, key.c_str());
+    Route &route = routes[ssrc];
+    route = {key, 0, 0, 0};
+    return &route;
+}
+
+GstElement* RtpDemux::output_for(const std::string &key) const {
+    for (const Output &out : outputs)
+        if (out.key == key) return out.appsrc;
+    return nullptr;
+}
+
+bool RtpDemux::has_rule(const std::string &key) const {
+    for (const Rule &rule : rules)
+        if (rule.key == key) return true;
+    return false;
+}
+
+bool RtpDemux::key_taken(const std::string &key) const {
+    for (const auto &entry : routes)
+        if (entry.second.key == key) return true;
+    return false;
+}
+
+void RtpDemux::expire_routes(gint64 now_us) {
+    bool released = false;
+    for (auto it = routes.begin(); it != routes.end();) {
+        if (now_us - it->second.last_seen_us > kRouteTimeoutUs) {
+            g_print("[RtpDemux] SSRC 0x%08x sin paquetes, libera la fuente del puerto %s\n",
+                    it->first, it->second.key.c_str());
+            it = routes.erase(it);
+            released = true;
+        } else {
+            ++it;
+        }
+    }
+    // Con fuentes liberadas los rechazados vuelven a intentar
+    if (released) rejected.clear();
+}
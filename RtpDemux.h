@@ -0,0 +1,85 @@
+#ifndef RTPDEMUX_H
+#define RTPDEMUX_H
+
+#include <gst/gst.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "LayoutConfig.h"
+#include "UdpIngest.h"
+
+// Demux RTP de un único puerto (PipelineDesc::rtp_demux): un solo socket y
+// un solo hilo de recepción (UdpIngest) para todas las fuentes. Cada
+// datagrama va al appsrc "rtpsrc" de la fuente de su SSRC, y de ahí a la
+// cola de decode de su slot. Las fuentes con regla (SourceDesc::rtp) toman
+// su SSRC o payload type; un SSRC nuevo sin regla ocupa la primera fuente
+// registrada que no tenga emisor. Un SSRC sin paquetes por 5 s la libera.
+class RtpDemux {
+public:
+    struct Stats {
+        bool assigned = false;      // la fuente tiene un SSRC asignado
+        guint32 ssrc = 0;
+        guint64 packets = 0;
+        guint64 app_dropped = 0;    // appsrc de la fuente lleno
+        guint64 unrouted = 0;       // de todo el puerto: sin fuente libre o no RTP
+        UdpIngest::Stats socket;    // de todo el puerto
+    };
+
+    static RtpDemux& instance();
+
+    // Reglas "ssrc=N" / "pt=N" de las fuentes (clave: puerto de la fuente)
+    void set_rules(const std::vector<SourceDesc> &sources);
+
+    // Registra el appsrc name del pipeline como salida de la fuente key y
+    // abre el socket si hace falta. Devuelve el id para detach (0: no es un
+    // appsrc o no se pudo abrir el puerto).
+    int attach(GstElement *pipeline, const std::string &name, const std::string &key);
+    void detach(int id);
+    // Cierra el socket y olvida los SSRC (modo desactivado)
+    void shutdown();
+
+    // Hilo principal. false si la fuente no tiene salida registrada.
+    bool stats(const std::string &key, Stats *out);
+
+private:
+    struct Rule {
+        std::string key;
+        bool by_ssrc;
+        guint32 value;   // SSRC o payload type
+    };
+    struct Output {
+        int id;
+        std::string key;
+        GstElement *appsrc;
+    };
+    struct Route {
+        std::string key;
+        gint64 last_seen_us;
+        guint64 packets;
+        guint64 app_dropped;
+    };
+
+    GMutex lock;
+    UdpIngest* ingest = nullptr;       // solo hilo principal
+    std::vector<Rule> rules;
+    std::vector<Output> outputs;       // en orden de registro (orden de las celdas)
+    std::map<guint32, Route> routes;   // SSRC -> fuente
+    std::set<guint32> rejected;        // SSRC sin fuente libre ya avisados
+    int next_id = 1;
+    guint64 unrouted = 0;
+    gint64 last_expire_us = 0;
+
+    RtpDemux();
+    ~RtpDemux();
+
+    // Hilo de la ingesta, con lock tomado
+    void on_batch(GstBuffer **buffers, int count);
+    Route* route_for(guint32 ssrc, int pt);
+    GstElement* output_for(const std::string &key) const;
+    bool has_rule(const std::string &key) const;
+    bool key_taken(const std::string &key) const;
+    void expire_routes(gint64 now_us);
+};
+
+#endif // RTPDEMUX_H
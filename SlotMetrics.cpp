@@ -0,0 +1,203 @@
+#include "SlotMetrics.h"
+
+void SlotMetrics::reset() {
+    bytes_in = 0;
+    frames_decoded = 0;
+    rtp_packets = 0;
+    rtp_lost = 0;
+    rtp_reordered = 0;
+    jitter_x16 = 0;
+    rtp_resync = true;
+
+    for (int i = 0; i < kRing; ++i) {
+        ring_pts[i] = GST_CLOCK_TIME_NONE;
+        ring_time[i] = 0;
+    }
+    latency_sum_us = 0;
+    latency_count = 0;
+    latency_max_us = 0;
+}
+
+// ===== Probes (hilos de streaming) =====
+
+void SlotMetrics::add_probe(GstElement *pipeline, const char *name, const char *pad_name, GstPadProbeCallback cb) {
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!element) return;
+    GstPad *pad = gst_element_get_static_pad(element, pad_name);
+    if (pad) probes.push_back({pad, gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, cb, this, NULL)});
+    gst_object_unref(element);
+}
+
+void SlotMetrics::attach(GstElement *pipeline) {
+    detach();
+    add_probe(pipeline, "decq", "sink", &SlotMetrics::input_probe_cb);
+    add_probe(pipeline, "dec", "sink", &SlotMetrics::decoder_probe_cb);
+    add_probe(pipeline, "rtpsrc", "src", &SlotMetrics::rtp_probe_cb);
+}
+
+void SlotMetrics::detach() {
+    for (auto &probe : probes) {
+        gst_pad_remove_probe(probe.first, probe.second);
+        gst_object_unref(probe.first);
+    }
+    probes.clear();
+}
+
+GstPadProbeReturn SlotMetrics::input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    SlotMetrics *self = static_cast<SlotMetrics *>(user_data);
+    self->bytes_in.fetch_add(gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info)), std::memory_order_relaxed);
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn SlotMetrics::decoder_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    static_cast<SlotMetrics *>(user_data)->on_decoder_input(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+GstPadProbeReturn SlotMetrics::rtp_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    static_cast<SlotMetrics *>(user_data)->on_rtp_packet(GST_PAD_PROBE_INFO_BUFFER(info));
+    return GST_PAD_PROBE_OK;
+}
+
+void SlotMetrics::on_decoder_input(GstBuffer *buffer) {
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+
+    // Un solo escritor: la hora se publica antes que el PTS que la identifica
+    guint i = ring_head.load(std::memory_order_relaxed) % kRing;
+    ring_time[i].store(g_get_monotonic_time(), std::memory_order_relaxed);
+    ring_pts[i].store(pts, std::memory_order_release);
+    ring_head.store(i + 1, std::memory_order_relaxed);
+}
+
+void SlotMetrics::on_decoded(GstBuffer *buffer) {
+    frames_decoded.fetch_add(1, std::memory_order_relaxed);
+
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(pts)) return;
+
+    // Buscar desde la entrada más reciente hacia atrás
+    guint head = ring_head.load(std::memory_order_relaxed);
+    for (int n = 1; n <= kRing; ++n) {
+        guint i = (head + kRing - n) % kRing;
+        if (ring_pts[i].load(std::memory_order_acquire) != pts) continue;
+
+        gint64 latency = g_get_monotonic_time() - ring_time[i].load(std::memory_order_relaxed);
+        if (latency < 0) return;
+        latency_sum_us.fetch_add(latency, std::memory_order_relaxed);
+        latency_count.fetch_add(1, std::memory_order_relaxed);
+        gint64 max = latency_max_us.load(std::memory_order_relaxed);
+        while (latency > max && !latency_max_us.compare_exchange_weak(max, latency)) {}
+        return;
+    }
+}
+
+// Secuencia y jitter de llegada sobre el header RTP (antes del jitterbuffer)
+void SlotMetrics::on_rtp_packet(GstBuffer *buffer) {
+    guint8 header[8];
+    if (gst_buffer_extract(buffer, 0, header, sizeof(header)) < sizeof(header)) return;
+    if ((header[0] >> 6) != 2) return;
+
+    int seq = (header[2] << 8) | header[3];
+    guint32 rtp_ts = ((guint32)header[4] << 24) | ((guint32)header[5] << 16) |
+                     ((guint32)header[6] << 8) | header[7];
+    // Llegada en unidades del reloj RTP de video (90 kHz)
+    gint64 arrival = g_get_monotonic_time() * 9 / 100;
+
+    rtp_packets.fetch_add(1, std::memory_order_relaxed);
+
+    if (rtp_resync.exchange(false)) {
+        expected_seq = -1;
+        jitter_x16.store(0, std::memory_order_relaxed);
+    }
+
+    bool in_order = true;
+    if (expected_seq >= 0) {
+        gint16 delta = (gint16)(guint16)(seq - expected_seq);
+        if (delta > 0 && delta < 3000) {
+            rtp_lost.fetch_add(delta, std::memory_order_relaxed);
+        } else if (delta < 0 && delta > -3000) {
+            // Llegó tarde: ya se había contado como perdido
+            in_order = false;
+            rtp_reordered.fetch_add(1, std::memory_order_relaxed);
+            if (rtp_lost.load(std::memory_order_relaxed) > 0)
+                rtp_lost.fetch_sub(1, std::memory_order_relaxed);
+        } else if (delta != 0) {
+            // Salto grande: el emisor se reinició
+            last_transit = arrival - rtp_ts;
+            expected_seq = (seq + 1) & 0xFFFF;
+            return;
+        }
+    }
+
+    if (!in_order) return;
+    gint64 transit = arrival - (gint64)rtp_ts;
+    if (expected_seq >= 0) {
+        // J += (|D| - J) / 16, guardado como 16 * J
+        gint32 d = (gint32)((guint32)transit - (guint32)last_transit);
+        if (d < 0) d = -d;
+        gint64 j = jitter_x16.load(std::memory_order_relaxed);
+        jitter_x16.store(j + d - ((j + 8) >> 4), std::memory_order_relaxed);
+    }
+    last_transit = transit;
+    expected_seq = (seq + 1) & 0xFFFF;
+}
+
+// ===== Lectura (hilo principal) =====
+
+SlotMetrics::Snapshot SlotMetrics::snapshot(GstElement *pipeline, const std::string &jbuf_name) {
+    Snapshot s;
+    s.bytes_in = bytes_in.load(std::memory_order_relaxed);
+    s.frames_decoded = frames_decoded.load(std::memory_order_relaxed);
+    s.rtp_packets = rtp_packets.load(std::memory_order_relaxed);
+    s.rtp_lost = rtp_lost.load(std::memory_order_relaxed);
+    s.rtp_reordered = rtp_reordered.load(std::memory_order_relaxed);
+    s.jitter_ms = jitter_x16.load(std::memory_order_relaxed) / 16.0 / 90.0;
+
+    gint64 sum = latency_sum_us.exchange(0);
+    guint64 count = latency_count.exchange(0);
+    s.decode_latency_avg_ms = count ? sum / 1000.0 / count : 0.0;
+    s.decode_latency_max_ms = latency_max_us.exchange(0) / 1000.0;
+
+    if (!pipeline) return s;
+
+    GstElement *decq = gst_bin_get_by_name(GST_BIN(pipeline), "decq");
+    if (decq) {
+        g_object_get(decq,
+                     "current-level-buffers", &s.queue_buffers,
+                     "current-level-bytes", &s.queue_bytes,
+                     "current-level-time", &s.queue_time_ns,
+                     NULL);
+        gst_object_unref(decq);
+    }
+
+    // GstBaseSink::stats (GStreamer >= 1.18)
+    GstElement *sink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+    if (sink) {
+        if (g_object_class_find_property(G_OBJECT_GET_CLASS(sink), "stats")) {
+            GstStructure *stats = nullptr;
+            g_object_get(sink, "stats", &stats, NULL);
+            if (stats) {
+                gst_structure_get_uint64(stats, "dropped", &s.sink_dropped);
+                gst_structure_get_uint64(stats, "rendered", &s.sink_rendered);
+                gst_structure_free(stats);
+            }
+        }
+        gst_object_unref(sink);
+    }
+
+    GstElement *jbuf = jbuf_name.empty() ? nullptr : gst_bin_get_by_name(GST_BIN(pipeline), jbuf_name.c_str());
+    if (jbuf) {
+        GstStructure *stats = nullptr;
+        g_object_get(jbuf, "stats", &stats, NULL);
+        if (stats) {
+            s.has_jitterbuffer = true;
+            gst_structure_get_uint64(stats, "num-lost", &s.jb_lost);
+            gst_structure_get_uint64(stats, "num-late", &s.jb_late);
+            gst_structure_get_uint64(stats, "num-duplicates", &s.jb_duplicates);
+            gst_structure_free(stats);
+        }
+        gst_object_unref(jbuf);
+    }
+    return s;
+}
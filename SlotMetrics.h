@@ -0,0 +1,129 @@
+#ifndef SLOTMETRICS_H
+#define SLOTMETRICS_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Métricas de un slot. Los contadores se actualizan desde los hilos de
+// streaming solo con atómicos (sin locks); el hilo principal los lee con
+// snapshot() y completa lo que se consulta al pipeline (colas, sink, jitterbuffer).
+class SlotMetrics {
+public:
+    struct Snapshot {
+        // Acumulados desde el último reset()
+        guint64 bytes_in = 0;          // video comprimido a la entrada de "decq"
+        guint64 frames_decoded = 0;
+        guint64 rtp_packets = 0;
+        guint64 rtp_lost = 0;          // huecos en la secuencia RTP
+        guint64 rtp_reordered = 0;     // paquetes que llegaron después de uno posterior
+        double jitter_ms = 0.0;        // jitter de llegada RTP (RFC 3550)
+        // Latencia de decode (entrada del decoder -> frame listo) desde el último snapshot
+        double decode_latency_avg_ms = 0.0;
+        double decode_latency_max_ms = 0.0;
+
+        // Consultado al pipeline (hilo principal)
+        guint64 sink_dropped = 0;
+        guint64 sink_rendered = 0;
+        guint queue_buffers = 0;       // nivel actual de "decq"
+        guint queue_bytes = 0;
+        guint64 queue_time_ns = 0;
+        bool has_jitterbuffer = false;
+        guint64 jb_lost = 0;
+        guint64 jb_late = 0;
+        guint64 jb_duplicates = 0;
+        // Latencia adaptativa (lo completa StreamSlot desde JitterController)
+        bool has_jitter_control = false;
+        guint jb_latency_ms = 0;
+        guint jb_target_ms = 0;
+        double jb_late_pct = 0.0;      // tarde + perdidos en el jitterbuffer, último segundo
+
+        // Ingesta UDP propia (lo completa StreamSlot): descartes del kernel y
+        // de la cola del appsrc, para separarlos de las pérdidas de red
+        bool has_ingest = false;
+        guint64 ingest_datagrams = 0;
+        double ingest_batch_avg = 0.0;  // datagramas por syscall
+        guint64 ingest_dropped = 0;
+        bool has_kernel = false;
+        guint64 kernel_drops = 0;
+        guint64 kernel_queue_bytes = 0;
+        // Demux RTP de un solo puerto: SSRC asignado a la fuente del slot
+        bool has_demux = false;
+        bool demux_assigned = false;
+        guint32 demux_ssrc = 0;
+        guint64 demux_unrouted = 0;     // de todo el puerto
+        // Presentación con el renderer de mosaico (lo completa StreamSlot)
+        bool has_presentation = false;
+        guint64 frames_presented = 0;
+        guint64 frames_coalesced = 0;  // pisados por uno más nuevo antes del próximo redibujado
+        // Repetición instantánea (lo completa StreamSlot desde ReplayBuffer)
+        double replay_seconds = 0.0;    // video retenido en el anillo
+        guint64 replay_bytes = 0;
+        bool replaying = false;
+        // Fuente grabada (lo completa StreamSlot desde FileSource)
+        bool has_file = false;
+        guint64 file_units = 0;         // paquetes o frames entregados
+        guint file_loops = 0;
+
+        // Reconexión (lo completa StreamSlot, acumulado en la vida del slot)
+        const char *link_state = "";
+        guint reconnects = 0;
+        double last_recovery_ms = 0.0;  // falla -> primer frame de la última caída
+        // Contenido según el watchdog: normal, congelado, negro, color fijo o sin datos
+        const char *content = "";
+    };
+
+    SlotMetrics() { reset(); }
+    ~SlotMetrics() { detach(); }
+
+    // Pipeline nuevo: todo vuelve a cero
+    void reset();
+
+    // Instala los probes en los elementos conocidos (decq, dec, rtpsrc) y
+    // quita los del pipeline anterior, que puede seguir vivo un momento
+    void attach(GstElement *pipeline);
+    void detach();
+    // Frame decodificado listo para mostrar (probe del slot, hilo de streaming)
+    void on_decoded(GstBuffer *buffer);
+
+    // Hilo principal. Reinicia los agregados de latencia del intervalo.
+    // jbuf_name: jitterbuffer de la rama que se muestra ("" si no tiene)
+    Snapshot snapshot(GstElement *pipeline, const std::string &jbuf_name = "jbuf");
+
+private:
+    std::atomic<guint64> bytes_in{0};
+    std::atomic<guint64> frames_decoded{0};
+
+    // RTP: un solo hilo escritor (udpsrc)
+    std::atomic<guint64> rtp_packets{0};
+    std::atomic<guint64> rtp_lost{0};
+    std::atomic<guint64> rtp_reordered{0};
+    std::atomic<gint64> jitter_x16{0};     // en unidades de reloj RTP * 16
+    std::atomic<bool> rtp_resync{true};    // pedido por reset(), lo consume el hilo de udpsrc
+    int expected_seq = -1;                 // solo hilo de udpsrc
+    gint64 last_transit = 0;               // solo hilo de udpsrc
+
+    // Latencia de decode: PTS + hora de entrada al decoder en un anillo
+    static const int kRing = 64;
+    std::atomic<guint64> ring_pts[kRing];
+    std::atomic<gint64> ring_time[kRing];
+    std::atomic<guint> ring_head{0};
+    std::atomic<gint64> latency_sum_us{0};
+    std::atomic<guint64> latency_count{0};
+    std::atomic<gint64> latency_max_us{0};
+
+    // Probes instalados por attach (solo hilo principal)
+    std::vector<std::pair<GstPad*, gulong>> probes;
+
+    void add_probe(GstElement *pipeline, const char *name, const char *pad_name, GstPadProbeCallback cb);
+    void on_rtp_packet(GstBuffer *buffer);
+    void on_decoder_input(GstBuffer *buffer);
+
+    static GstPadProbeReturn input_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn decoder_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn rtp_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+};
+
+#endif // SLOTMETRICS_H
@@ -1,353 +1,1384 @@
-#include <gst/gst.h>
-#include <gst/video/video.h>
-#include <gst/video/videooverlay.h>
-#include "StreamSlot.h"
-#include "Watchdog.h"  // Incluye el header de watchdog
-
-// Callback del bus GStreamer para mensajes de error y EOS
-static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
-    switch (GST_MESSAGE_TYPE(msg)) {
-        case GST_MESSAGE_ERROR: {
-            GError *err;
-            gchar *debug;
-            gst_message_parse_error(msg, &err, &debug);
-            g_printerr("[GStreamer error] %s\n", err->message);
-            g_error_free(err);
-            g_free(debug);
-            break;
-        }
-        case GST_MESSAGE_EOS:
-            g_print("[GStreamer] End of stream\n");
-            break;
-        default:
-            break;
-    }
-    return TRUE;
-}
-
-// Callback para el probe que cuenta buffers y notifica watchdog
-static GstPadProbeReturn buffer_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
-    Watchdog *wd = static_cast<Watchdog *>(user_data);
-    wd->notify_buffer();
-    return GST_PAD_PROBE_OK;
-}
-
-StreamSlot::StreamSlot() : container(nullptr), pipeline(nullptr), video_widget(nullptr), watchdog(nullptr) {
-    // Crear watchdog con callback ligado a este StreamSlot
-    watchdog = new Watchdog([this](bool show_black){
-        if (watchdog_enabled) {
-            on_watchdog_event(show_black);
-        }
-    }, 5000);
-}
-
-StreamSlot::~StreamSlot() {
-    // Detener watchdog para evitar callbacks mientras destruimos
-    if (watchdog) {
-        watchdog->stop();
-        delete watchdog;
-        watchdog = nullptr;
-    }
-
-    // Detener y liberar pipeline
-    if (pipeline) {
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
-        pipeline = nullptr;
-    }
-
-    // Remover container del padre (si lo tiene) y destruir de forma segura
-    if (container) {
-        GtkWidget *parent = gtk_widget_get_parent(container);
-        if (parent && GTK_IS_CONTAINER(parent)) {
-            // Remover del padre, esto evita que el padre intente usar un widget ya destruido
-            gtk_container_remove(GTK_CONTAINER(parent), container);
-        }
-        if (GTK_IS_WIDGET(container)) {
-            gtk_widget_destroy(container);
-        }
-        container = nullptr;
-        video_widget = nullptr;
-    }
-}
-
-// Callback del watchdog (seguro: comprobamos video_widget y GTK_IS_WIDGET)
-void StreamSlot::on_watchdog_event(bool show_black) {
-    g_print("[StreamSlot] Watchdog evento, show_black = %d\n", show_black);
-    if (!video_widget) return;
-    if (!GTK_IS_WIDGET(video_widget)) return;
-
-    if (show_black) {
-        gtk_widget_hide(video_widget);
-    } else {
-        gtk_widget_show(video_widget);
-    }
-}
-
-// ===== Helpers internos =====
-// Remueve de forma segura el video_widget actual del container (si existe)
-void StreamSlot::remove_existing_video_widget() {
-    if (video_widget && GTK_IS_WIDGET(video_widget)) {
-        GtkWidget *parent = gtk_widget_get_parent(video_widget);
-        if (parent && GTK_IS_CONTAINER(parent)) {
-            // Quitar del container; esto también unparentea internamente
-            gtk_container_remove(GTK_CONTAINER(parent), video_widget);
-        } else {
-            // Si no tiene parent pero es widget válido, destruirlo
-            gtk_widget_destroy(video_widget);
-        }
-        video_widget = nullptr;
-    }
-}
-
-// Coloca un placeholder negro (drawing area) en el container
-void StreamSlot::place_black_placeholder() {
-    // Primero quitar widget anterior
-    remove_existing_video_widget();
-
-    // Crear un drawing area simple (será negro por el CSS global que usas)
-    GtkWidget *da = gtk_drawing_area_new();
-    gtk_widget_set_hexpand(da, TRUE);
-    gtk_widget_set_vexpand(da, TRUE);
-
-    // Añadir al container
-    if (!container) {
-        container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        gtk_widget_set_hexpand(container, TRUE);
-        gtk_widget_set_vexpand(container, TRUE);
-    }
-    gtk_container_add(GTK_CONTAINER(container), da);
-    video_widget = da;
-    gtk_widget_show_all(container);
-}
-// ======================================================================================================================================
-// === MODO SRT ===
-void StreamSlot::init_with_streamid(const std::string &streamid) {
-    
-    watchdog_enabled = true;
-
-    // Detener watchdog para evitar callbacks durante reconfiguración
-    if (watchdog) watchdog->stop();
-
-    // Detener y liberar pipeline previo
-    if (pipeline) {
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
-        pipeline = nullptr;
-    }
-
-    // Si existe video_widget previo, removerlo del container (sin destruir container)
-    remove_existing_video_widget();
-
-    // Asegurar que container exista (si fue destruido antes)
-    if (!container) {
-        container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        gtk_widget_set_hexpand(container, TRUE);
-        gtk_widget_set_vexpand(container, TRUE);
-    }
-
-    // Construir pipeline SRT
-    std::string uri = "srt://172.23.193.99:8080?streamid=" + streamid;
-    std::string pipeline_str =
-        "srtclientsrc uri=" + uri +
-        " ! decodebin ! videoconvert name=videoconvert ! gtksink name=videosink";
-
-    GError *error = nullptr;
-    pipeline = gst_parse_launch(pipeline_str.c_str(), &error);
-    if (error) {
-        g_printerr("[StreamSlot] Error creando pipeline SRT: %s\n", error->message);
-        g_error_free(error);
-        pipeline = nullptr;
-        // Colocar placeholder negro para mantener UI consistente
-        place_black_placeholder();
-        if (watchdog) watchdog->start();
-        return;
-    }
-
-    // Bus de mensajes
-    GstBus *bus = gst_element_get_bus(pipeline);
-    gst_bus_add_watch(bus, bus_call, this);
-    gst_object_unref(bus);
-
-    // Obtener el widget del gtksink (si existe)
-    GstElement *videosink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
-    if (videosink) {
-        g_object_get(G_OBJECT(videosink), "widget", &video_widget, NULL);
-        gst_object_unref(videosink);
-    } else {
-        video_widget = nullptr;
-    }
-
-    if (video_widget && GTK_IS_WIDGET(video_widget)) {
-        gtk_widget_set_hexpand(video_widget, TRUE);
-        gtk_widget_set_vexpand(video_widget, TRUE);
-
-        // Asegurarse de que no tenga padre
-        GtkWidget *parent = gtk_widget_get_parent(video_widget);
-        if (parent && GTK_IS_CONTAINER(parent)) {
-            gtk_container_remove(GTK_CONTAINER(parent), video_widget);
-        }
-
-        // Añadir al container
-        if (!container) {
-            container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-            gtk_widget_set_hexpand(container, TRUE);
-            gtk_widget_set_vexpand(container, TRUE);
-        }
-        gtk_container_add(GTK_CONTAINER(container), video_widget);
-    } else {
-        g_printerr("[StreamSlot] No se pudo obtener el widget de video (SRT)\n");
-        place_black_placeholder();
-    }
-
-    // Agregar probe para watchdog (si existe videoconvert)
-    GstElement* videoconvert = gst_bin_get_by_name(GST_BIN(pipeline), "videoconvert");
-    if (videoconvert) {
-        GstPad *sinkpad = gst_element_get_static_pad(videoconvert, "sink");
-        if (sinkpad) {
-            gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe_cb, watchdog, NULL);
-            gst_object_unref(sinkpad);
-        }
-        gst_object_unref(videoconvert);
-    }
-
-    gst_element_set_state(pipeline, GST_STATE_PLAYING);
-
-    // Reiniciar watchdog cuando todo esté listo
-    if (watchdog) watchdog->start();
-
-    // Mostrar container (si no está insertado en otro lado, el caller ya lo hace)
-    if (container && GTK_IS_WIDGET(container))
-        gtk_widget_show_all(container);
-}
-// ======================================================================================================================================
-// === MODO UDP ===
-
-// === MODO UDP SAFE ===
-void StreamSlot::init_with_udp_port_safe(const std::string &port) {
-    
-    watchdog_enabled = true;
-
-    setup_udp_pipeline(port,
-        "udpsrc port=" + port + " ! "
-        "application/x-rtp,media=video,encoding-name=H264,payload=96 ! "
-        "rtph264depay ! h264parse ! avdec_h264 ! videoconvert name=videoconvert ! "
-        "gtksink name=videosink");
-}
-
-// === MODO UDP FAST ===
-void StreamSlot::init_with_udp_port_fast(const std::string &port) {
-    
-    watchdog_enabled = false;  // desactivar watchdog para modo ultra rápido
-
-    setup_udp_pipeline(port,
-        "udpsrc port=" + port + " buffer-size=200000 ! "
-        "application/x-rtp,media=video,encoding-name=H264,payload=96 ! "
-        "rtpjitterbuffer latency=20 drop-on-latency=false ! "
-        "rtph264depay ! h264parse ! avdec_h264 ! videoconvert ! "
-        "gtksink sync=false max-lateness=0 qos=false name=videosink");
-}
-
-
-void StreamSlot::setup_udp_pipeline(const std::string &port, const std::string &pipeline_str) {
-    if (watchdog) watchdog->stop();
-    if (pipeline) {
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
-        pipeline = nullptr;
-    }
-
-    remove_existing_video_widget();
-
-    if (!container) {
-        container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        gtk_widget_set_hexpand(container, TRUE);
-        gtk_widget_set_vexpand(container, TRUE);
-    }
-
-    GError *error = nullptr;
-    pipeline = gst_parse_launch(pipeline_str.c_str(), &error);
-    if (error) {
-        g_printerr("[StreamSlot] Error creando pipeline UDP: %s\n", error->message);
-        g_error_free(error);
-        pipeline = nullptr;
-        place_black_placeholder();
-        if (watchdog) watchdog->start();
-        return;
-    }
-
-    GstBus *bus = gst_element_get_bus(pipeline);
-    gst_bus_add_watch(bus, bus_call, this);
-    gst_object_unref(bus);
-
-    GstElement *videosink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
-    if (videosink) {
-        g_object_get(G_OBJECT(videosink), "widget", &video_widget, NULL);
-        gst_object_unref(videosink);
-    } else {
-        video_widget = nullptr;
-    }
-
-    if (video_widget && GTK_IS_WIDGET(video_widget)) {
-        gtk_widget_set_hexpand(video_widget, TRUE);
-        gtk_widget_set_vexpand(video_widget, TRUE);
-        GtkWidget *parent = gtk_widget_get_parent(video_widget);
-        if (parent && GTK_IS_CONTAINER(parent))
-            gtk_container_remove(GTK_CONTAINER(parent), video_widget);
-        gtk_container_add(GTK_CONTAINER(container), video_widget);
-    } else {
-        g_printerr("[StreamSlot] No se pudo obtener el widget de video (UDP)\n");
-        place_black_placeholder();
-    }
-
-    GstElement *videoconvert = gst_bin_get_by_name(GST_BIN(pipeline), "videoconvert");
-    if (videoconvert) {
-        GstPad *sinkpad = gst_element_get_static_pad(videoconvert, "sink");
-        if (sinkpad) {
-            gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe_cb, watchdog, NULL);
-            gst_object_unref(sinkpad);
-        }
-        gst_object_unref(videoconvert);
-    }
-
-    gst_element_set_state(pipeline, GST_STATE_PLAYING);
-    if (watchdog) watchdog->start();
-
-    if (container && GTK_IS_WIDGET(container))
-        gtk_widget_show_all(container);
-}
-// ======================================================================================================================================
-
-// ===== modo "pantalla negra" para slots inactivos =====
-void StreamSlot::init_with_black_screen() {
-    // Detener pipeline y watchdog
-    if (watchdog) watchdog->stop();
-    if (pipeline) {
-        gst_element_set_state(pipeline, GST_STATE_NULL);
-        gst_object_unref(pipeline);
-        pipeline = nullptr;
-    }
-
-    // Reemplazar widget por placeholder negro
-    place_black_placeholder();
-
-    if (watchdog) watchdog->start();
-}
-
-// Obtener widget contenedor (si no existe, crearlo)
-GtkWidget* StreamSlot::get_widget() {
-    if (!container) {
-        container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-        gtk_widget_set_hexpand(container, TRUE);
-        gtk_widget_set_vexpand(container, TRUE);
-        // colocar placeholder vacío hasta inicializar pipeline
-        place_black_placeholder();
-    }
-
-    GtkWidget *parent = gtk_widget_get_parent(container);
-    g_print("[StreamSlot::get_widget] Devuelvo widget %p con padre %p (%s)\n",
-            container,
-            parent,
-            parent ? G_OBJECT_TYPE_NAME(parent) : "NULL");
-    return container;
-}
+#include <algorithm>
+#include <cstdlib>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include <gst/video/videooverlay.h>
+#include "StreamSlot.h"
+#include "Watchdog.h"  // Incluye el header de watchdog
+#include "PipelineDesc.h"
+#include "DecoderScheduler.h"
+#include "MosaicRenderer.h"
+
+// Trabajo asíncrono de un slot: apagar el pipeline anterior y arrancar el nuevo
+struct SlotJob {
+    GstElement *old_pipeline;   // referencia propia (puede ser nullptr)
+    GstElement *new_pipeline;   // referencia propia (puede ser nullptr)
+    int generation;
+    GstElement *restart_source; // referencia propia: fuente a reiniciar sola (puede ser nullptr)
+};
+
+// Clip de una repetición: lo suelta el appsrc al destruirse (teardown en el pool)
+struct ReplayFeed {
+    ReplayBuffer::Clip clip;
+    bool sent = false;
+};
+
+// El appsrc pide datos ya en PAUSED (antes descartaría lo empujado): va todo
+// el clip y el EOS de una vez, son referencias a memoria que ya está en el anillo
+static void on_replay_need_data(GstElement *src, guint length, gpointer data) {
+    ReplayFeed *feed = static_cast<ReplayFeed *>(data);
+    if (feed->sent) return;
+    feed->sent = true;
+
+    GstFlowReturn ret;
+    for (GstBuffer *buffer : feed->clip.buffers) {
+        g_signal_emit_by_name(src, "push-buffer", buffer, &ret);
+        if (ret != GST_FLOW_OK) break;
+    }
+    g_signal_emit_by_name(src, "end-of-stream", &ret);
+}
+
+// Callback del bus GStreamer (hilo principal)
+gboolean StreamSlot::bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(data);
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR: {
+            GError *err;
+            gchar *debug;
+            gst_message_parse_error(msg, &err, &debug);
+            g_printerr("[GStreamer error] %s\n", err->message);
+            std::string element;
+            Reconnector::Failure failure = Reconnector::classify(msg, &element);
+            slot->set_hold(true);
+            slot->reconnector.on_failure(failure, element, err->message);
+            g_error_free(err);
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+            g_print("[GStreamer] End of stream\n");
+            // El emisor cerró la conexión: se reabre la fuente de la rama activa
+            slot->set_hold(true);
+            slot->reconnector.on_failure(Reconnector::Failure::END, slot->source_element(), nullptr);
+            break;
+        case GST_MESSAGE_STATE_CHANGED: {
+            // Solo interesa el pipeline actual, no sus elementos
+            if (GST_MESSAGE_SRC(msg) != GST_OBJECT(slot->pipeline)) break;
+            GstState old_state, new_state;
+            gst_message_parse_state_changed(msg, &old_state, &new_state, NULL);
+            if (new_state == GST_STATE_PLAYING && old_state != GST_STATE_PLAYING)
+                slot->on_pipeline_playing();
+            break;
+        }
+        case GST_MESSAGE_APPLICATION: {
+            const GstStructure *s = gst_message_get_structure(msg);
+            if (s && gst_structure_has_name(s, "first-frame"))
+                slot->on_first_frame();
+            break;
+        }
+        default:
+            break;
+    }
+    return TRUE;
+}
+
+// Se ejecuta en el hilo que emite el mensaje: al entrar un hilo de streaming
+// del slot se le aplica la afinidad/prioridad del plan del scheduler
+GstBusSyncReply StreamSlot::bus_sync_cb(GstBus *bus, GstMessage *msg, gpointer data) {
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STREAM_STATUS) {
+        GstStreamStatusType type;
+        GstElement *owner;
+        gst_message_parse_stream_status(msg, &type, &owner);
+        if (type == GST_STREAM_STATUS_TYPE_ENTER) {
+            StreamSlot *slot = static_cast<StreamSlot *>(data);
+            DecoderScheduler &scheduler = DecoderScheduler::instance();
+            scheduler.apply_to_current_thread(scheduler.plan_for(slot->slot_index, slot->mode.load()));
+        }
+    }
+    return GST_BUS_PASS;
+}
+
+// Callback para el probe que cuenta buffers y notifica watchdog (hilo de streaming)
+GstPadProbeReturn StreamSlot::buffer_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    if (slot->watchdog) {
+        slot->watchdog->notify_buffer();
+        slot->watchdog->notify_frame(pad, GST_PAD_PROBE_INFO_BUFFER(info));
+    }
+    slot->metrics.on_decoded(GST_PAD_PROBE_INFO_BUFFER(info));
+
+    // Último frame, para retenerlo si se corta la señal (el renderer guarda el suyo)
+    if (!slot->renderer && !slot->headless) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        g_mutex_lock(&slot->last_frame_lock);
+        gst_buffer_replace(&slot->last_frame, GST_PAD_PROBE_INFO_BUFFER(info));
+        gst_caps_replace(&slot->last_caps, caps);
+        g_mutex_unlock(&slot->last_frame_lock);
+        if (caps) gst_caps_unref(caps);
+    }
+
+    // Primer frame del pipeline: avisar al hilo principal por el bus (y el
+    // pipeline saliente de un cambio de variante deja de mostrar ya mismo)
+    if (slot->first_frame_pending.exchange(false)) {
+        slot->outgoing_cut = true;
+        GstElement *element = gst_pad_get_parent_element(pad);
+        if (element) {
+            gst_element_post_message(element,
+                gst_message_new_application(GST_OBJECT(element), gst_structure_new_empty("first-frame")));
+            gst_object_unref(element);
+        }
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// Pipeline saliente de un cambio de variante (hilo de streaming): sus frames
+// llegan al tile solo hasta que el nuevo tiene el primero
+GstPadProbeReturn StreamSlot::outgoing_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    return slot->outgoing_cut.load() ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+}
+
+// Política de decode a la entrada del decoder (hilo de streaming)
+GstPadProbeReturn StreamSlot::decode_policy_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    int policy = slot->decode_policy.load(std::memory_order_relaxed);
+    if (policy == DECODE_FULL) return GST_PAD_PROBE_OK;
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        slot->hidden_drops.fetch_add(1, std::memory_order_relaxed);
+        return GST_PAD_PROBE_DROP;
+    }
+
+    // Keyframe: si el slot volvió a mostrarse, desde aquí se decodifica todo
+    if (policy == DECODE_RESUMING) {
+        int expected = DECODE_RESUMING;
+        slot->decode_policy.compare_exchange_strong(expected, DECODE_FULL);
+    }
+    return GST_PAD_PROBE_OK;
+}
+
+// Frame renderizado por el fakesink en modo headless (hilo de streaming)
+void StreamSlot::on_sink_handoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    slot->frame_callback(buffer, caps);
+    if (caps) gst_caps_unref(caps);
+}
+
+// Descarta frames delta hasta el primer keyframe y luego se retira
+GstPadProbeReturn StreamSlot::keyframe_gate_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+        return GST_PAD_PROBE_DROP;
+
+    // El próximo frame decodificado marca el fin del cambio
+    static_cast<StreamSlot *>(user_data)->first_frame_pending = true;
+    return GST_PAD_PROBE_REMOVE;
+}
+
+// A la entrada del decoder, al arrancar y después de una caída: descarta frames
+// delta hasta el próximo keyframe y le antepone los SPS/PPS cacheados si no los trae
+GstPadProbeReturn StreamSlot::resync_gate_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    if (buffer == slot->warmup_inflight) return GST_PAD_PROBE_OK;
+
+    if (slot->warmup_pending.exchange(false)) slot->inject_warmup(pad);
+
+    if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+        return GST_PAD_PROBE_DROP;
+
+    GST_PAD_PROBE_INFO_DATA(info) = slot->codec_cache.complete_keyframe(buffer);
+    slot->first_frame_pending = true;
+    slot->resync_armed = false;
+    return GST_PAD_PROBE_REMOVE;
+}
+
+// Pipeline nuevo de la misma fuente: el decoder procesa el último keyframe
+// conocido (sin mostrarlo) antes que el stream vivo y no arranca en frío
+void StreamSlot::inject_warmup(GstPad *pad) {
+    // Con decodebin (SRT) el decoder todavía no existe detrás del ghost pad
+    GstObject *parent = gst_pad_get_parent(pad);
+    bool decoder = parent && GST_IS_VIDEO_DECODER(parent);
+    if (parent) gst_object_unref(parent);
+    if (!decoder) return;
+
+    GstBuffer *warm = codec_cache.warmup_buffer();
+    if (!warm) return;
+
+    // Mismo hilo y mismo pad: el stream lock es recursivo
+    warmup_inflight = warm;
+    gst_pad_chain(pad, warm);
+    warmup_inflight = nullptr;
+}
+
+// Se ejecuta en un hilo del pool (nunca en el hilo de GTK)
+void StreamSlot::run_job(gpointer data, gpointer user_data) {
+    SlotJob *job = static_cast<SlotJob *>(data);
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+
+    // Lo que se cree durante el cambio de estado no debe heredar el núcleo de GTK
+    DecoderScheduler::instance().release_current_thread();
+
+    if (job->old_pipeline) {
+        gst_element_set_state(job->old_pipeline, GST_STATE_NULL);
+        gst_object_unref(job->old_pipeline);
+    }
+
+    // Reinicio solo de la fuente: se vacía lo que quedó río abajo (incluido un
+    // EOS) y la fuente vuelve al estado del pipeline, lo que reabre la conexión
+    if (job->restart_source) {
+        if (job->generation == slot->generation.load()) {
+            GstElement *source = job->restart_source;
+            GstPad *srcpad = gst_element_get_static_pad(source, "src");
+            GstPad *peer = srcpad ? gst_pad_get_peer(srcpad) : nullptr;
+
+            gst_element_set_state(source, GST_STATE_NULL);
+            if (peer) {
+                gst_pad_send_event(peer, gst_event_new_flush_start());
+                gst_pad_send_event(peer, gst_event_new_flush_stop(FALSE));
+                gst_object_unref(peer);
+            }
+            if (srcpad) gst_object_unref(srcpad);
+
+            if (!gst_element_sync_state_with_parent(source))
+                g_printerr("[StreamSlot] No se pudo reiniciar la fuente %s\n", GST_OBJECT_NAME(source));
+        }
+        gst_object_unref(job->restart_source);
+    }
+
+    if (job->new_pipeline) {
+        // Si el slot ya fue reconfigurado otra vez, no tiene sentido arrancarlo
+        if (job->generation == slot->generation.load()) {
+            if (gst_element_set_state(job->new_pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE)
+                g_printerr("[StreamSlot] No se pudo pasar el pipeline a PLAYING\n");
+        }
+        gst_object_unref(job->new_pipeline);
+    }
+
+    delete job;
+}
+
+StreamSlot::StreamSlot() : container(nullptr), video_widget(nullptr), pipeline(nullptr), watchdog(nullptr),
+    reconnector([this](Reconnector::Action action, const std::string &element) {
+        on_reconnect_action(action, element);
+    }) {
+    // Crear watchdog con callback ligado a este StreamSlot
+    watchdog = new Watchdog([this](bool show_black){
+        if (watchdog_enabled) {
+            on_watchdog_event(show_black);
+        }
+    }, 5000);
+    // Contenido anómalo con buffers llegando: se informa, no se reconecta
+    // (un encoder trabado no se arregla reabriendo el stream)
+    watchdog->set_content_callback([this](Watchdog::Content content) {
+        g_print("[StreamSlot] Slot %d: contenido %s\n", slot_index, Watchdog::content_name(content));
+    });
+
+    g_mutex_init(&last_frame_lock);
+
+    // Un solo hilo a la vez por slot (orden garantizado); hilos compartidos entre slots
+    jobs = g_thread_pool_new(&StreamSlot::run_job, this, 1, FALSE, NULL);
+}
+
+StreamSlot::~StreamSlot() {
+    reconnector.stop();
+
+    // Quitar el probe de frames antes que el watchdog: los hilos de streaming
+    // siguen corriendo hasta que el pipeline pase a NULL más abajo
+    if (frame_probe_pad) {
+        if (frame_probe_id) gst_pad_remove_probe(frame_probe_pad, frame_probe_id);
+        gst_object_unref(frame_probe_pad);
+        frame_probe_pad = nullptr;
+        frame_probe_id = 0;
+    }
+
+    // Detener watchdog para evitar callbacks mientras destruimos
+    if (watchdog) {
+        watchdog->stop();
+        delete watchdog;
+        watchdog = nullptr;
+    }
+
+    if (tile_size_timer) {
+        g_source_remove(tile_size_timer);
+        tile_size_timer = 0;
+    }
+
+    stop_ingest();
+    drop_outgoing();
+
+    // La repetición en curso se libera en el pool, como el pipeline anterior
+    if (replay_bus_id) g_source_remove(replay_bus_id);
+    replay_bus_id = 0;
+    if (replay_pipeline) queue_job(replay_pipeline, nullptr);
+    replay_pipeline = nullptr;
+
+    // Esperar a que terminen los trabajos pendientes de este slot
+    generation++;
+    if (jobs) {
+        g_thread_pool_free(jobs, FALSE, TRUE);
+        jobs = nullptr;
+    }
+
+    // Detener y liberar pipeline
+    if (bus_watch_id) {
+        g_source_remove(bus_watch_id);
+        bus_watch_id = 0;
+    }
+    if (pipeline) {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+        pipeline = nullptr;
+    }
+
+    // Remover container del padre (si lo tiene) y destruir de forma segura
+    if (container) {
+        GtkWidget *parent = gtk_widget_get_parent(container);
+        if (parent && GTK_IS_CONTAINER(parent)) {
+            // Remover del padre, esto evita que el padre intente usar un widget ya destruido
+            gtk_container_remove(GTK_CONTAINER(parent), container);
+        }
+        if (GTK_IS_WIDGET(container)) {
+            gtk_widget_destroy(container);
+        }
+        container = nullptr;
+        video_widget = nullptr;
+        pending_widget = nullptr;
+        hold_widget = nullptr;
+        replay_widget = nullptr;
+    }
+
+    if (frame_probe_pad) gst_object_unref(frame_probe_pad);
+    frame_probe_pad = nullptr;
+
+    if (hold_surface) cairo_surface_destroy(hold_surface);
+    hold_surface = nullptr;
+    gst_buffer_replace(&last_frame, NULL);
+    gst_caps_replace(&last_caps, NULL);
+    g_mutex_clear(&last_frame_lock);
+}
+
+// Callback del watchdog (seguro: comprobamos video_widget y GTK_IS_WIDGET)
+void StreamSlot::on_watchdog_event(bool show_black) {
+    g_print("[StreamSlot] Watchdog evento, show_black = %d\n", show_black);
+
+    // Sin frames: reconectar (SRT) o esperar al emisor (UDP) y retomar en el
+    // próximo keyframe. Oculto solo decodifica keyframes: un GOP largo no es una caída.
+    if (show_black && is_visible()) {
+        arm_resync_gate();
+        reconnector.on_failure(Reconnector::Failure::STALL, source_element(), nullptr);
+    } else if (!show_black) {
+        reconnector.on_recovered();
+    }
+
+    // El tile conserva el último frame, atenuado, hasta que vuelva la señal
+    set_hold(show_black);
+}
+
+// Sin señal: último frame atenuado y con la hora de la caída, en vez de negro
+void StreamSlot::set_hold(bool hold) {
+    if (hold == holding) return;
+    holding = hold;
+
+    if (renderer) {
+        renderer->set_held(slot_index, hold);
+        return;
+    }
+    if (headless) return;
+
+    if (hold) {
+        GstSample *sample = last_frame_sample();
+        hold_surface = sample ? MosaicRenderer::sample_surface(sample) : nullptr;
+        if (sample) gst_sample_unref(sample);
+        hold_stamp = MosaicRenderer::clock_stamp();
+
+        ensure_container();
+        hold_widget = gtk_drawing_area_new();
+        gtk_widget_set_hexpand(hold_widget, TRUE);
+        gtk_widget_set_vexpand(hold_widget, TRUE);
+        g_signal_connect(hold_widget, "draw", G_CALLBACK(&StreamSlot::on_hold_draw), this);
+        gtk_container_add(GTK_CONTAINER(container), hold_widget);
+
+        if (video_widget && GTK_IS_WIDGET(video_widget)) {
+            gtk_widget_set_no_show_all(video_widget, TRUE);
+            gtk_widget_hide(video_widget);
+        }
+        // Durante una repetición el velo aparece recién cuando termina
+        gtk_widget_set_no_show_all(hold_widget, TRUE);
+        if (!replay_pipeline) gtk_widget_show(hold_widget);
+    } else {
+        if (hold_widget && GTK_IS_WIDGET(hold_widget)) gtk_widget_destroy(hold_widget);
+        hold_widget = nullptr;
+        if (hold_surface) cairo_surface_destroy(hold_surface);
+        hold_surface = nullptr;
+
+        if (video_widget && GTK_IS_WIDGET(video_widget) && !replay_pipeline) {
+            gtk_widget_set_no_show_all(video_widget, FALSE);
+            gtk_widget_show(video_widget);
+        }
+    }
+}
+
+GstSample* StreamSlot::last_frame_sample() {
+    g_mutex_lock(&last_frame_lock);
+    GstSample *sample = last_frame ? gst_sample_new(last_frame, last_caps, NULL, NULL) : nullptr;
+    g_mutex_unlock(&last_frame_lock);
+    return sample;
+}
+
+gboolean StreamSlot::on_hold_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    double w = gtk_widget_get_allocated_width(widget);
+    double h = gtk_widget_get_allocated_height(widget);
+
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_paint(cr);
+
+    if (slot->hold_surface) {
+        double sw = cairo_image_surface_get_width(slot->hold_surface);
+        double sh = cairo_image_surface_get_height(slot->hold_surface);
+        double k = std::min(w / sw, h / sh);
+        cairo_save(cr);
+        cairo_translate(cr, (w - sw * k) / 2, (h - sh * k) / 2);
+        cairo_scale(cr, k, k);
+        cairo_set_source_surface(cr, slot->hold_surface, 0, 0);
+        cairo_paint(cr);
+        cairo_restore(cr);
+    }
+
+    MosaicRenderer::draw_hold(cr, 0, 0, w, h, slot->hold_stamp);
+    return TRUE;
+}
+
+// ===== Repetición instantánea =====
+// Clip del anillo -> appsrc -> decoder propio -> el mismo tile. El pipeline en
+// vivo no se toca: sigue recibiendo, decodificando y llenando el anillo.
+bool StreamSlot::start_replay(int seconds) {
+    if (headless) return false;
+    stop_replay();
+
+    ReplayBuffer::Clip clip;
+    if (!replay.take_clip(seconds, &clip)) {
+        g_print("[Replay] slot %d: todavía no hay video para repetir\n", slot_index);
+        return false;
+    }
+
+    std::string tail = renderer ? MosaicRenderer::sink_tail(false)
+                                : std::string("videoconvert ! gtksink name=videosink");
+    std::string desc =
+        "appsrc name=replaysrc format=time max-bytes=0 ! decodebin ! videoconvert ! "
+        "textoverlay text=\"REPETICIÓN\" valignment=top halignment=left font-desc=\"Sans Bold 14\" ! " + tail;
+
+    GError *error = nullptr;
+    GstElement *replay_bin = gst_parse_launch(desc.c_str(), &error);
+    if (error) {
+        g_printerr("[Replay] Error creando pipeline: %s\n", error->message);
+        g_error_free(error);
+        if (replay_bin) gst_object_unref(replay_bin);
+        ReplayBuffer::free_clip(&clip);
+        return false;
+    }
+
+    g_print("[Replay] slot %d: repitiendo %.1f s (%zu frames)\n",
+            slot_index, clip.seconds, clip.buffers.size());
+    GstElement *src = gst_bin_get_by_name(GST_BIN(replay_bin), "replaysrc");
+    g_object_set(src, "caps", clip.caps, NULL);
+    ReplayFeed *feed = new ReplayFeed{clip};
+    g_signal_connect_data(src, "need-data", G_CALLBACK(on_replay_need_data), feed,
+                          [](gpointer data, GClosure *) {
+                              ReplayFeed *feed = static_cast<ReplayFeed *>(data);
+                              ReplayBuffer::free_clip(&feed->clip);
+                              delete feed;
+                          },
+                          (GConnectFlags)0);
+    gst_object_unref(src);
+
+    replay_pipeline = replay_bin;
+    GstBus *bus = gst_element_get_bus(replay_pipeline);
+    replay_bus_id = gst_bus_add_watch(bus, &StreamSlot::replay_bus_call, this);
+    gst_object_unref(bus);
+    DecoderScheduler::instance().release_streaming_threads(replay_pipeline);
+
+    if (renderer) {
+        // El tile deja de aceptar frames del vivo hasta stop_replay
+        renderer->set_replay(slot_index, true);
+        renderer->attach(replay_pipeline, slot_index, true);
+    } else {
+        GstElement *videosink = gst_bin_get_by_name(GST_BIN(replay_pipeline), "videosink");
+        if (videosink) {
+            g_object_get(G_OBJECT(videosink), "widget", &replay_widget, NULL);
+            gst_object_unref(videosink);
+        }
+        if (replay_widget) {
+            gtk_widget_set_hexpand(replay_widget, TRUE);
+            gtk_widget_set_vexpand(replay_widget, TRUE);
+            ensure_container();
+            gtk_container_add(GTK_CONTAINER(container), replay_widget);
+            g_object_unref(replay_widget);
+
+            if (video_widget && GTK_IS_WIDGET(video_widget)) {
+                gtk_widget_set_no_show_all(video_widget, TRUE);
+                gtk_widget_hide(video_widget);
+            }
+            if (hold_widget && GTK_IS_WIDGET(hold_widget)) gtk_widget_hide(hold_widget);
+            gtk_widget_show(replay_widget);
+        }
+    }
+
+    queue_job(nullptr, replay_pipeline);
+    return true;
+}
+
+void StreamSlot::stop_replay() {
+    if (!replay_pipeline) return;
+
+    if (replay_bus_id) g_source_remove(replay_bus_id);
+    replay_bus_id = 0;
+    queue_job(replay_pipeline, nullptr);
+    replay_pipeline = nullptr;
+
+    if (renderer) {
+        renderer->set_replay(slot_index, false);
+    } else {
+        if (replay_widget && GTK_IS_WIDGET(replay_widget)) {
+            GtkWidget *parent = gtk_widget_get_parent(replay_widget);
+            if (parent && GTK_IS_CONTAINER(parent))
+                gtk_container_remove(GTK_CONTAINER(parent), replay_widget);
+        }
+        replay_widget = nullptr;
+
+        // De vuelta al vivo, o al último frame retenido si sigue sin señal
+        if (holding && hold_widget && GTK_IS_WIDGET(hold_widget)) {
+            gtk_widget_show(hold_widget);
+        } else if (!holding && video_widget && GTK_IS_WIDGET(video_widget)) {
+            gtk_widget_set_no_show_all(video_widget, FALSE);
+            gtk_widget_show(video_widget);
+        }
+    }
+    g_print("[Replay] slot %d: de vuelta al vivo\n", slot_index);
+}
+
+gboolean StreamSlot::replay_bus_call(GstBus *bus, GstMessage *msg, gpointer data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(data);
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_ERROR: {
+            GError *err;
+            gst_message_parse_error(msg, &err, NULL);
+            g_printerr("[Replay] Error: %s\n", err->message);
+            g_error_free(err);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+            break;
+        default:
+            return G_SOURCE_CONTINUE;
+    }
+
+    // Fin del clip (o error): el watch se va con esta vuelta
+    slot->replay_bus_id = 0;
+    slot->stop_replay();
+    return G_SOURCE_REMOVE;
+}
+
+// ===== Helpers internos =====
+// Remueve de forma segura el video_widget actual del container (si existe)
+void StreamSlot::remove_existing_video_widget() {
+    if (video_widget && GTK_IS_WIDGET(video_widget)) {
+        GtkWidget *parent = gtk_widget_get_parent(video_widget);
+        if (parent && GTK_IS_CONTAINER(parent)) {
+            // Quitar del container; esto también unparentea internamente
+            gtk_container_remove(GTK_CONTAINER(parent), video_widget);
+        } else {
+            // Si no tiene parent pero es widget válido, destruirlo
+            gtk_widget_destroy(video_widget);
+        }
+        video_widget = nullptr;
+    }
+}
+
+// Crea el container del tile (una sola vez) y sigue su tamaño en pantalla
+void StreamSlot::ensure_container() {
+    if (container || headless) return;
+    container = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_widget_set_hexpand(container, TRUE);
+    gtk_widget_set_vexpand(container, TRUE);
+    g_signal_connect(container, "size-allocate", G_CALLBACK(&StreamSlot::on_size_allocate), this);
+}
+
+// Coloca un placeholder negro (drawing area) en el container
+void StreamSlot::place_black_placeholder() {
+    if (headless) return;
+
+    // Primero quitar widget anterior
+    remove_existing_video_widget();
+
+    // Crear un drawing area simple (será negro por el CSS global que usas)
+    GtkWidget *da = gtk_drawing_area_new();
+    gtk_widget_set_hexpand(da, TRUE);
+    gtk_widget_set_vexpand(da, TRUE);
+
+    // Añadir al container
+    ensure_container();
+    gtk_container_add(GTK_CONTAINER(container), da);
+    video_widget = da;
+    gtk_widget_show_all(container);
+}
+
+// Suelta el pipeline actual: sin bus watch ni widget pendiente.
+// Devuelve la propiedad del pipeline al llamador vía queue_job.
+void StreamSlot::detach_pipeline() {
+    if (bus_watch_id) {
+        g_source_remove(bus_watch_id);
+        bus_watch_id = 0;
+    }
+    // El jitterbuffer del pipeline saliente ya no se ajusta
+    jitter.detach();
+    // El pipeline saliente sigue corriendo hasta su NULL en el pool: sus
+    // frames no deben llegar al watchdog ni al primer frame del nuevo
+    if (frame_probe_pad) {
+        if (frame_probe_id) gst_pad_remove_probe(frame_probe_pad, frame_probe_id);
+        gst_object_unref(frame_probe_pad);
+    }
+    frame_probe_pad = nullptr;
+    frame_probe_id = 0;
+
+    if (pending_widget && GTK_IS_WIDGET(pending_widget)) {
+        GtkWidget *parent = gtk_widget_get_parent(pending_widget);
+        if (parent && GTK_IS_CONTAINER(parent))
+            gtk_container_remove(GTK_CONTAINER(parent), pending_widget);
+    }
+    pending_widget = nullptr;
+}
+
+void StreamSlot::queue_job(GstElement *old_pipeline, GstElement *new_pipeline, GstElement *restart_source) {
+    SlotJob *job = new SlotJob{old_pipeline,
+                               new_pipeline ? GST_ELEMENT(gst_object_ref(new_pipeline)) : nullptr,
+                               generation.load(),
+                               restart_source};
+    g_thread_pool_push(jobs, job, NULL);
+}
+
+// ===== Reconexión =====
+// Fuente de red de la rama activa (nombres de PipelineDesc)
+const char* StreamSlot::source_element() const {
+    return mode.load() == StreamMode::SRT_MOSAIC ? "srtsrc" : "rtpsrc";
+}
+
+// Decide el Reconnector (hilo principal, al vencer el backoff)
+void StreamSlot::on_reconnect_action(Reconnector::Action action, const std::string &element) {
+    GstElement *source = (action == Reconnector::Action::RESTART_SOURCE && pipeline)
+                             ? gst_bin_get_by_name(GST_BIN(pipeline), element.c_str())
+                             : nullptr;
+    if (!source) {
+        // Copia: el init_* reemplaza relaunch mientras se ejecuta
+        std::function<void()> fn = relaunch;
+        if (fn) fn();
+        return;
+    }
+
+    g_print("[StreamSlot] Reiniciando solo la fuente %s\n", element.c_str());
+    arm_resync_gate();
+    launch_time_us = g_get_monotonic_time();
+    queue_job(nullptr, nullptr, source);
+}
+
+// El decoder retoma en el próximo keyframe: nada de frames corruptos al reconectar
+void StreamSlot::arm_resync_gate() {
+    if (!pipeline || resync_armed.exchange(true)) return;
+
+    GstElement *dec = gst_bin_get_by_name(GST_BIN(pipeline), "dec");
+    GstPad *sinkpad = dec ? gst_element_get_static_pad(dec, "sink") : nullptr;
+    if (sinkpad) {
+        gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, &StreamSlot::resync_gate_cb, this, NULL);
+        gst_object_unref(sinkpad);
+    } else {
+        resync_armed = false;
+    }
+    if (dec) gst_object_unref(dec);
+}
+
+// Construye el pipeline en el hilo principal (rápido) y delega los cambios
+// de estado, que pueden bloquear (conexión SRT, teardown), al pool del slot.
+void StreamSlot::launch_pipeline(const std::string &pipeline_str, const char *label) {
+    // Cambio de variante con imagen en pantalla: el pipeline actual no se
+    // apaga todavía, sigue mostrando hasta el primer frame del nuevo
+    bool overlap = overlap_next_launch && pipeline && !headless && !holding && !first_frame_pending.load();
+    overlap_next_launch = false;
+
+    // Detener watchdog para evitar callbacks durante reconfiguración
+    if (watchdog) watchdog->stop();
+    stop_replay();
+    drop_outgoing();
+    // El socket de la ingesta se libera antes de que el pipeline nuevo lo pida
+    // (en un cambio de variante es otro puerto: el saliente conserva la suya)
+    if (overlap) {
+        outgoing_ingest = ingest;
+        ingest = nullptr;
+    }
+    stop_ingest();
+
+    generation++;
+    standby = false;
+    GstElement *old_pipeline = pipeline;
+    pipeline = nullptr;
+    if (overlap) {
+        retire_pipeline(old_pipeline);
+        old_pipeline = nullptr;
+    }
+    detach_pipeline();
+
+    // Asegurar que container exista (si fue destruido antes)
+    ensure_container();
+
+    GError *error = nullptr;
+    pipeline = gst_parse_launch(pipeline_str.c_str(), &error);
+    if (error) {
+        g_printerr("[StreamSlot] Error creando pipeline %s: %s\n", label, error->message);
+        g_error_free(error);
+        if (pipeline) gst_object_unref(pipeline);
+        pipeline = nullptr;
+        queue_job(old_pipeline, nullptr);
+        drop_outgoing();
+        // Un pipeline mal formado no se arregla reintentando
+        reconnector.stop();
+        // Colocar placeholder negro para mantener UI consistente
+        place_black_placeholder();
+        if (watchdog) watchdog->start();
+        return;
+    }
+
+    // Bus de mensajes
+    GstBus *bus = gst_element_get_bus(pipeline);
+    bus_watch_id = gst_bus_add_watch(bus, &StreamSlot::bus_call, this);
+    gst_bus_set_sync_handler(bus, &StreamSlot::bus_sync_cb, this, NULL);
+    gst_object_unref(bus);
+
+    // Con renderer de mosaico el appsink entrega frames al widget común
+    if (renderer) renderer->attach(pipeline, slot_index);
+
+    // Obtener el widget del gtksink (si existe). Queda oculto hasta PLAYING,
+    // mientras tanto el tile sigue mostrando el widget anterior.
+    GstElement *videosink = (renderer || headless) ? nullptr : gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+    if (videosink) {
+        g_object_get(G_OBJECT(videosink), "widget", &pending_widget, NULL);
+        gst_object_unref(videosink);
+    }
+
+    if (pending_widget && GTK_IS_WIDGET(pending_widget)) {
+        gtk_widget_set_hexpand(pending_widget, TRUE);
+        gtk_widget_set_vexpand(pending_widget, TRUE);
+
+        // Asegurarse de que no tenga padre
+        GtkWidget *parent = gtk_widget_get_parent(pending_widget);
+        if (parent && GTK_IS_CONTAINER(parent)) {
+            gtk_container_remove(GTK_CONTAINER(parent), pending_widget);
+        }
+
+        gtk_widget_set_no_show_all(pending_widget, TRUE);
+        gtk_container_add(GTK_CONTAINER(container), pending_widget);
+        // g_object_get devolvió una referencia propia; el container y el sink ya tienen la suya
+        g_object_unref(pending_widget);
+    } else if (!renderer && !headless) {
+        g_printerr("[StreamSlot] No se pudo obtener el widget de video (%s)\n", label);
+        pending_widget = nullptr;
+        place_black_placeholder();
+    }
+
+    // Headless: cada frame renderizado por el fakesink (después de la espera de sync)
+    if (headless && frame_callback) {
+        GstElement *fakesink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+        if (fakesink) {
+            g_object_set(fakesink, "signal-handoffs", TRUE, NULL);
+            g_signal_connect(fakesink, "handoff", G_CALLBACK(&StreamSlot::on_sink_handoff), this);
+            gst_object_unref(fakesink);
+        }
+    }
+
+    // Agregar probe para watchdog y primer frame (si existe videoconvert)
+    GstElement* videoconvert = gst_bin_get_by_name(GST_BIN(pipeline), "videoconvert");
+    if (videoconvert) {
+        frame_probe_pad = gst_element_get_static_pad(videoconvert, "sink");
+        if (frame_probe_pad)
+            frame_probe_id = gst_pad_add_probe(frame_probe_pad, GST_PAD_PROBE_TYPE_BUFFER,
+                                               &StreamSlot::buffer_probe_cb, this, NULL);
+        gst_object_unref(videoconvert);
+    }
+
+    // Política de decode (slots ocultos) a la entrada del decoder
+    GstElement *dec = gst_bin_get_by_name(GST_BIN(pipeline), "dec");
+    if (dec) {
+        GstPad *sinkpad = gst_element_get_static_pad(dec, "sink");
+        if (sinkpad) {
+            gst_pad_add_probe(sinkpad, GST_PAD_PROBE_TYPE_BUFFER, &StreamSlot::decode_policy_cb, this, NULL);
+            gst_object_unref(sinkpad);
+        }
+        gst_object_unref(dec);
+    }
+
+    // Contadores del slot (después de la política: lo descartado no cuenta como decode)
+    metrics.reset();
+    metrics.attach(pipeline);
+    codec_cache.attach(pipeline);
+    replay.attach(pipeline);
+    jitter.attach(pipeline);
+
+    // Ingesta UDP propia o demux por SSRC: el "rtpsrc" del pipeline es un appsrc
+    if (!udp_port.empty()) {
+        if (PipelineDesc::rtp_demux())
+            demux_id = RtpDemux::instance().attach(pipeline, "rtpsrc", udp_port);
+        else
+            ingest = UdpIngest::attach(pipeline, "rtpsrc", atoi(udp_port.c_str()));
+    }
+    if (!file_path.empty()) file_source = FileSource::attach(pipeline, "filesrc", file_path, file_realtime);
+
+    // Tamaño actual del tile y decoders que aparezcan más tarde (decodebin)
+    g_signal_connect(pipeline, "deep-element-added", G_CALLBACK(&StreamSlot::on_deep_element_added), this);
+    apply_tile_size();
+
+    first_frame_pending = true;
+    // El decoder arranca en un keyframe; si la fuente ya se conoce, precalentado con el último
+    resync_armed = false;
+    warmup_pending = codec_cache.has_headers();
+    arm_resync_gate();
+    launch_time_us = g_get_monotonic_time();
+    queue_job(old_pipeline, pipeline);
+    reconnector.on_launch();
+
+    // Mostrar container (si no está insertado en otro lado, el caller ya lo hace)
+    if (container && GTK_IS_WIDGET(container))
+        gtk_widget_show_all(container);
+}
+
+// El pipeline actual llegó a PLAYING: reemplazar el widget del tile
+void StreamSlot::on_pipeline_playing() {
+    // En un cambio de variante el widget se reemplaza con el primer frame
+    if (pending_widget && !outgoing) {
+        remove_existing_video_widget();
+        video_widget = pending_widget;
+        pending_widget = nullptr;
+        // Reconectando: el widget nuevo aparece recién con su primer frame
+        if (!holding && !replay_pipeline) {
+            gtk_widget_set_no_show_all(video_widget, FALSE);
+            gtk_widget_show(video_widget);
+        }
+    }
+
+    // Reiniciar watchdog cuando todo esté listo
+    if (watchdog) watchdog->start();
+}
+
+void StreamSlot::on_first_frame() {
+    g_print("[StreamSlot] Primer frame %.1f ms después del init\n",
+            (g_get_monotonic_time() - launch_time_us) / 1000.0);
+    if (outgoing) finish_switch();
+    reconnector.on_first_frame();
+    set_hold(false);
+
+    // Ya se conoce la resolución de la fuente: reevaluar el decode del tile
+    apply_tile_size();
+
+    if (live_callback) live_callback();
+}
+
+// ===== Cambio de variante sin corte =====
+// El pipeline anterior queda reproduciendo fuera del estado del slot (sin bus,
+// sin métricas ni caché): su probe de frames pasa a solo dejar pasar hasta
+// que el nuevo tenga imagen.
+void StreamSlot::retire_pipeline(GstElement *old_pipeline) {
+    outgoing = old_pipeline;
+    outgoing_cut = false;
+    if (frame_probe_pad) {
+        gst_pad_remove_probe(frame_probe_pad, frame_probe_id);
+        frame_probe_id = 0;
+        gst_pad_add_probe(frame_probe_pad, GST_PAD_PROBE_TYPE_BUFFER, &StreamSlot::outgoing_probe_cb, this, NULL);
+    }
+    // Si la variante nueva no llega a mostrar nada, no se retiene la vieja para siempre
+    outgoing_timer = g_timeout_add_seconds(5, &StreamSlot::on_outgoing_timeout, this);
+}
+
+// Primer frame del pipeline nuevo: su widget reemplaza al del saliente
+void StreamSlot::finish_switch() {
+    if (pending_widget) {
+        remove_existing_video_widget();
+        video_widget = pending_widget;
+        pending_widget = nullptr;
+        if (!holding && !replay_pipeline) {
+            gtk_widget_set_no_show_all(video_widget, FALSE);
+            gtk_widget_show(video_widget);
+        }
+    }
+    drop_outgoing();
+}
+
+void StreamSlot::drop_outgoing() {
+    if (outgoing_timer) g_source_remove(outgoing_timer);
+    outgoing_timer = 0;
+    if (outgoing_ingest) {
+        outgoing_ingest->stop();
+        delete outgoing_ingest;
+        outgoing_ingest = nullptr;
+    }
+    if (outgoing) queue_job(outgoing, nullptr);
+    outgoing = nullptr;
+}
+
+gboolean StreamSlot::on_outgoing_timeout(gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    slot->outgoing_timer = 0;
+    g_printerr("[StreamSlot] Slot %d: la variante nueva no entregó frames, se suelta la anterior\n",
+               slot->slot_index);
+    slot->finish_switch();
+    return G_SOURCE_REMOVE;
+}
+
+// Variante para el tamaño actual del tile y el modo del slot
+int StreamSlot::choose_variant() const {
+    bool srt = (mode.load() == StreamMode::SRT_MOSAIC);
+    // Con demux RTP el puerto identifica a la fuente en las reglas del demux
+    if (!srt && PipelineDesc::rtp_demux()) return -1;
+    return pick_variant(variants, tile_height, srt);
+}
+
+// El tile cambió de tamaño (layout, F11): si le corresponde otra variante,
+// se relanza el slot con ella y el cambio se hace en su primer keyframe
+void StreamSlot::update_variant() {
+    if (variants.empty() || standby || !file_path.empty() || !pipeline || !relaunch || replay_pipeline) return;
+    int wanted = choose_variant();
+    if (wanted == variant) return;
+
+    std::string name = wanted < 0 ? std::string("principal") : std::to_string(variants[wanted].height) + "p";
+    g_print("[StreamSlot] Slot %d: tile de %d px de alto, paso a la variante %s\n",
+            slot_index, tile_height, name.c_str());
+    overlap_next_launch = true;
+    // Copia: el init_* reemplaza relaunch mientras se ejecuta
+    std::function<void()> fn = relaunch;
+    fn();
+}
+// ===== Decode según el tamaño del tile =====
+// Cambios de tamaño del tile (grid, F11): se aplican con un pequeño retardo
+// para no renegociar caps en cada paso de un resize.
+void StreamSlot::on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    int scale = gtk_widget_get_scale_factor(widget);
+    slot->set_tile_size(allocation->width * scale, allocation->height * scale);
+}
+
+void StreamSlot::set_tile_size(int width, int height) {
+    if (width == tile_width && height == tile_height) return;
+
+    tile_width = width;
+    tile_height = height;
+    if (tile_size_timer) g_source_remove(tile_size_timer);
+    tile_size_timer = g_timeout_add(150, &StreamSlot::on_tile_size_timeout, this);
+}
+
+gboolean StreamSlot::on_tile_size_timeout(gpointer user_data) {
+    StreamSlot *slot = static_cast<StreamSlot *>(user_data);
+    slot->tile_size_timer = 0;
+    slot->apply_tile_size();
+    slot->update_variant();
+    return G_SOURCE_REMOVE;
+}
+
+// Decoders agregados después del parse (decodebin en SRT)
+void StreamSlot::on_deep_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element, gpointer user_data) {
+    if (GST_IS_VIDEO_DECODER(element))
+        static_cast<StreamSlot *>(user_data)->configure_decoder(element);
+}
+
+// Primer decoder de video del pipeline (directo o dentro de decodebin)
+GstElement* StreamSlot::find_video_decoder() {
+    if (!pipeline) return nullptr;
+
+    GstElement *found = nullptr;
+    GstIterator *it = gst_bin_iterate_recurse(GST_BIN(pipeline));
+    GValue item = G_VALUE_INIT;
+    while (!found && gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement *element = GST_ELEMENT(g_value_get_object(&item));
+        if (GST_IS_VIDEO_DECODER(element))
+            found = GST_ELEMENT(gst_object_ref(element));
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return found;
+}
+
+void StreamSlot::configure_decoder(GstElement *decoder) {
+    // Hilos y tipo de threading según el presupuesto de CPU del mosaico
+    DecoderScheduler &scheduler = DecoderScheduler::instance();
+    scheduler.configure_decoder(decoder, scheduler.plan_for(slot_index, mode.load()));
+
+    // avdec_*: 0 = decodificar todo, 1 = saltar B-frames (no referencia)
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(decoder), "skip-frame"))
+        g_object_set(decoder, "skip-frame", skip_frame_mode.load(), NULL);
+}
+
+// Escala temprana (antes de videoconvert) al tamaño real del tile y, si el
+// tile es mucho más chico que la fuente, el decoder salta frames no referencia.
+void StreamSlot::apply_tile_size() {
+    if (!pipeline || tile_width <= 0 || tile_height <= 0) return;
+
+    int w = std::max(16, tile_width & ~1);
+    int h = std::max(16, tile_height & ~1);
+
+    // Rango hasta el tamaño del tile: videoscale conserva el aspecto y nunca agranda
+    GstElement *tilecaps = gst_bin_get_by_name(GST_BIN(pipeline), "tilecaps");
+    if (tilecaps) {
+        GstCaps *caps = gst_caps_new_simple("video/x-raw",
+                                            "width", GST_TYPE_INT_RANGE, 16, w,
+                                            "height", GST_TYPE_INT_RANGE, 16, h,
+                                            NULL);
+        g_object_set(tilecaps, "caps", caps, NULL);
+        gst_caps_unref(caps);
+        gst_object_unref(tilecaps);
+    }
+
+    int source_height = 0;
+    GstElement *decoder = find_video_decoder();
+    if (decoder) {
+        GstPad *srcpad = gst_element_get_static_pad(decoder, "src");
+        GstCaps *caps = srcpad ? gst_pad_get_current_caps(srcpad) : nullptr;
+        if (caps) {
+            gst_structure_get_int(gst_caps_get_structure(caps, 0), "height", &source_height);
+            gst_caps_unref(caps);
+        }
+        if (srcpad) gst_object_unref(srcpad);
+    }
+
+    skip_frame_mode = (source_height > 0 && source_height >= 3 * h) ? 1 : 0;
+    if (decoder) {
+        configure_decoder(decoder);
+        gst_object_unref(decoder);
+    }
+
+    g_print("[StreamSlot] Tile %dx%d (fuente %dp): escala antes de convertir, saltar B-frames: %s\n",
+            w, h, source_height, skip_frame_mode.load() ? "sí" : "no");
+}
+// Tramo final de cada pipeline: escala al tile, conversión y gtksink
+// (o el appsink del renderer de mosaico, que escala y convierte por su cuenta,
+// o un fakesink en modo headless)
+std::string StreamSlot::display_tail(bool fast) const {
+    if (renderer) return MosaicRenderer::sink_tail(fast);
+
+    // fakesink no sincroniza por defecto: se copian los ajustes del gtksink
+    if (headless)
+        return std::string("videoconvert name=videoconvert ! fakesink name=videosink") +
+               (fast ? " sync=false max-lateness=0 qos=false" : " sync=true max-lateness=20000000 qos=true");
+
+    return std::string("videoscale name=tilescale ! capsfilter name=tilecaps ! "
+                       "videoconvert name=videoconvert ! gtksink name=videosink") +
+           (fast ? " sync=false max-lateness=0 qos=false" : "");
+}
+// ======================================================================================================================================
+// === MODO SRT ===
+void StreamSlot::init_with_streamid(const std::string &streamid) {
+
+    watchdog_enabled = true;
+    mode = StreamMode::SRT_MOSAIC;
+    udp_port.clear();
+    file_path.clear();
+    reconnector.set_connectionless(false);
+    relaunch = [this, streamid]() { init_with_streamid(streamid); };
+    variant = choose_variant();
+    const std::string &source = variant < 0 ? streamid : variants[variant].streamid;
+    codec_cache.set_source("srt:" + source);
+    replay.set_source("srt:" + source);
+
+    // Construir pipeline SRT
+    launch_pipeline(
+        PipelineDesc::srt_decode_branch(source) +
+        " ! " + display_tail(false),
+        "SRT");
+}
+// ======================================================================================================================================
+// === MODO UDP ===
+
+// === MODO UDP SAFE ===
+void StreamSlot::init_with_udp_port_safe(const std::string &port) {
+
+    watchdog_enabled = true;
+    mode = StreamMode::UDP_SAFE;
+    reconnector.set_connectionless(true);
+    relaunch = [this, port]() { init_with_udp_port_safe(port); };
+    variant = choose_variant();
+    const std::string &source = variant < 0 ? port : variants[variant].port;
+    codec_cache.set_source("udp:" + source);
+    replay.set_source("udp:" + source);
+
+    setup_udp_pipeline(source,
+        PipelineDesc::udp_safe_decode_branch(source) + " ! " + display_tail(false));
+}
+
+// === MODO UDP FAST ===
+void StreamSlot::init_with_udp_port_fast(const std::string &port) {
+
+    watchdog_enabled = false;  // desactivar watchdog para modo ultra rápido
+    mode = StreamMode::UDP_FAST;
+    reconnector.set_connectionless(true);
+    relaunch = [this, port]() { init_with_udp_port_fast(port); };
+    variant = choose_variant();
+    const std::string &source = variant < 0 ? port : variants[variant].port;
+    codec_cache.set_source("udp:" + source);
+    replay.set_source("udp:" + source);
+
+    setup_udp_pipeline(source,
+        PipelineDesc::udp_fast_decode_branch(source) + " ! " + display_tail(true));
+}
+
+
+void StreamSlot::setup_udp_pipeline(const std::string &port, const std::string &pipeline_str) {
+    udp_port = port;
+    file_path.clear();
+    launch_pipeline(pipeline_str, "UDP");
+}
+// ======================================================================================================================================
+// === MODO ARCHIVO ===
+void StreamSlot::init_with_file(const std::string &path, bool realtime) {
+    std::string branch = PipelineDesc::file_decode_branch(path, realtime);
+    if (branch.empty()) {
+        g_printerr("[StreamSlot] %s: archivo ilegible o de formato desconocido\n", path.c_str());
+        init_with_black_screen();
+        return;
+    }
+
+    watchdog_enabled = true;
+    udp_port.clear();
+    file_path = path;
+    file_realtime = realtime;
+    // Un archivo no se corta: si deja de haber frames, el pipeline se trabó y se relanza
+    reconnector.set_connectionless(false);
+    relaunch = [this, path, realtime]() { init_with_file(path, realtime); };
+    variant = -1;
+    codec_cache.set_source("file:" + path);
+    replay.set_source("file:" + path);
+
+    launch_pipeline(branch + " ! " + display_tail(!realtime), "archivo");
+}
+// ======================================================================================================================================
+// === MODO STANDBY ===
+void StreamSlot::init_standby(const std::string &streamid, const std::string &port,
+                              StreamMode initial_mode, unsigned long budget_bytes) {
+    mode = initial_mode;
+    udp_port = port;
+    file_path.clear();
+    reconnector.set_connectionless(initial_mode != StreamMode::SRT_MOSAIC);
+    // Se relanza en la rama activa al momento del reintento
+    relaunch = [this, streamid, port, budget_bytes]() { init_standby(streamid, port, mode.load(), budget_bytes); };
+    // Las tres ramas ya están conectadas: standby usa siempre la fuente principal
+    variant = -1;
+    codec_cache.set_source("standby:" + streamid + ":" + port);
+    replay.set_source("standby:" + streamid + ":" + port);
+    launch_pipeline(
+        PipelineDesc::standby_pipeline(streamid, port, budget_bytes, display_tail(false)),
+        "standby");
+    if (!pipeline) return;
+
+    standby = true;
+    select_mode(initial_mode);
+}
+
+bool StreamSlot::select_mode(StreamMode new_mode) {
+    if (!standby || !pipeline) return false;
+
+    GstElement *sel = gst_bin_get_by_name(GST_BIN(pipeline), "sel");
+    if (!sel) return false;
+
+    std::string pad_name = "sink_" + std::to_string(PipelineDesc::standby_pad_index(new_mode));
+    GstPad *pad = gst_element_get_static_pad(sel, pad_name.c_str());
+    if (!pad) {
+        gst_object_unref(sel);
+        return false;
+    }
+
+    // La rama nueva entra al decoder recién en su próximo keyframe
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, &StreamSlot::keyframe_gate_cb, this, NULL);
+    g_object_set(sel, "active-pad", pad, NULL);
+    gst_object_unref(pad);
+    gst_object_unref(sel);
+
+    mode = new_mode;
+    apply_sink_mode(new_mode);
+    // Solo se adapta (y se informa) el jitterbuffer de la rama en pantalla
+    jitter.attach(pipeline, PipelineDesc::standby_jbuf_name(new_mode));
+    watchdog_enabled = (new_mode != StreamMode::UDP_FAST);
+    reconnector.set_connectionless(new_mode != StreamMode::SRT_MOSAIC);
+    launch_time_us = g_get_monotonic_time();
+
+    g_print("[StreamSlot] Standby: rama activa %s\n", PipelineDesc::mode_name(new_mode));
+    return true;
+}
+
+// Ajustes de sincronización del sink que antes dependían del pipeline de cada modo
+void StreamSlot::apply_sink_mode(StreamMode sink_mode) {
+    GstElement *videosink = gst_bin_get_by_name(GST_BIN(pipeline), "videosink");
+    if (!videosink) return;
+
+    bool fast = (sink_mode == StreamMode::UDP_FAST);
+    g_object_set(videosink,
+                 "sync", fast ? FALSE : TRUE,
+                 "qos", fast ? FALSE : TRUE,
+                 "max-lateness", (gint64)(fast ? 0 : 20 * GST_MSECOND),
+                 NULL);
+    gst_object_unref(videosink);
+}
+// ======================================================================================================================================
+
+// ===== modo "pantalla negra" para slots inactivos =====
+void StreamSlot::init_with_black_screen() {
+    // Detener pipeline y watchdog (el teardown corre en el pool del slot)
+    if (watchdog) watchdog->stop();
+    reconnector.stop();
+    relaunch = nullptr;
+    stop_replay();
+    set_hold(false);
+    drop_outgoing();
+    stop_ingest();
+    generation++;
+    standby = false;
+    detach_pipeline();
+    if (pipeline) {
+        queue_job(pipeline, nullptr);
+        pipeline = nullptr;
+    }
+
+    // Reemplazar widget por placeholder negro
+    place_black_placeholder();
+
+    if (watchdog) watchdog->start();
+}
+
+void StreamSlot::set_renderer(MosaicRenderer *r) {
+    if (renderer && renderer != r) renderer->clear(slot_index);
+    renderer = r;
+}
+
+// Detener el slot sin reiniciar el watchdog (p. ej. al pasar a modo compositor)
+void StreamSlot::stop() {
+    if (renderer) renderer->clear(slot_index);
+    if (watchdog) watchdog->stop();
+    reconnector.stop();
+    relaunch = nullptr;
+    stop_replay();
+    set_hold(false);
+    drop_outgoing();
+    stop_ingest();
+    generation++;
+    standby = false;
+    detach_pipeline();
+    if (pipeline) {
+        queue_job(pipeline, nullptr);
+        pipeline = nullptr;
+    }
+    place_black_placeholder();
+}
+
+void StreamSlot::set_visible(bool visible) {
+    if (visible) {
+        int expected = DECODE_KEYFRAMES;
+        if (decode_policy.compare_exchange_strong(expected, DECODE_RESUMING))
+            g_print("[StreamSlot] Visible: decode completo desde el próximo keyframe\n");
+    } else if (decode_policy.exchange(DECODE_KEYFRAMES) != DECODE_KEYFRAMES) {
+        g_print("[StreamSlot] Oculto: solo se decodifican keyframes\n");
+    }
+}
+
+// Posición del slot en el mosaico (reparto de núcleos del scheduler)
+void StreamSlot::init(int index) {
+    slot_index = index;
+    reconnector.set_label("slot " + std::to_string(index));
+    jitter.set_label("slot " + std::to_string(index));
+}
+
+void StreamSlot::stop_ingest() {
+    if (demux_id) RtpDemux::instance().detach(demux_id);
+    demux_id = 0;
+    if (file_source) {
+        file_source->stop();
+        delete file_source;
+        file_source = nullptr;
+    }
+    if (!ingest) return;
+    ingest->stop();
+    delete ingest;
+    ingest = nullptr;
+}
+
+SlotMetrics::Snapshot StreamSlot::sample_metrics() {
+    SlotMetrics::Snapshot snap = metrics.snapshot(pipeline, standby ? PipelineDesc::standby_jbuf_name(mode) : "jbuf");
+    if (ingest) {
+        UdpIngest::Stats stats = ingest->stats();
+        snap.has_ingest = true;
+        snap.ingest_datagrams = stats.datagrams;
+        snap.ingest_batch_avg = stats.batches ? (double)stats.datagrams / stats.batches : 0.0;
+        snap.ingest_dropped = stats.app_dropped;
+        snap.has_kernel = stats.has_kernel;
+        snap.kernel_drops = stats.kernel_drops;
+        snap.kernel_queue_bytes = stats.kernel_queue_bytes;
+    }
+    RtpDemux::Stats demux;
+    if (demux_id && RtpDemux::instance().stats(udp_port, &demux)) {
+        snap.has_ingest = true;
+        snap.ingest_datagrams = demux.packets;
+        snap.ingest_batch_avg = demux.socket.batches ? (double)demux.socket.datagrams / demux.socket.batches : 0.0;
+        snap.ingest_dropped = demux.app_dropped;
+        snap.has_kernel = demux.socket.has_kernel;
+        snap.kernel_drops = demux.socket.kernel_drops;
+        snap.kernel_queue_bytes = demux.socket.kernel_queue_bytes;
+        snap.has_demux = true;
+        snap.demux_assigned = demux.assigned;
+        snap.demux_ssrc = demux.ssrc;
+        snap.demux_unrouted = demux.unrouted;
+    }
+    if (renderer) {
+        MosaicRenderer::TileStats tile = renderer->stats(slot_index);
+        snap.has_presentation = true;
+        snap.frames_presented = tile.presented;
+        snap.frames_coalesced = tile.coalesced;
+    }
+    snap.replay_seconds = replay.buffered_seconds();
+    snap.replay_bytes = replay.buffered_bytes();
+    snap.replaying = is_replaying();
+    JitterController::Status jb = jitter.status();
+    if (jb.active) {
+        snap.has_jitter_control = true;
+        snap.jb_latency_ms = jb.latency_ms;
+        snap.jb_target_ms = jb.target_ms;
+        snap.jb_late_pct = jb.late_pct;
+    }
+    if (file_source) {
+        FileSource::Stats stats = file_source->stats();
+        snap.has_file = true;
+        snap.file_units = stats.units;
+        snap.file_loops = stats.loops;
+    }
+    snap.link_state = Reconnector::state_name(reconnector.state());
+    snap.content = watchdog->is_stalled() ? "sin datos" : Watchdog::content_name(watchdog->content());
+    snap.reconnects = reconnector.reconnects();
+    snap.last_recovery_ms = reconnector.last_recovery_ms();
+    return snap;
+}
+
+const char* StreamSlot::mode_label() const {
+    return file_path.empty() ? PipelineDesc::mode_name(mode.load()) : "Archivo";
+}
+
+// Obtener widget contenedor (si no existe, crearlo)
+GtkWidget* StreamSlot::get_widget() {
+    if (!container) {
+        ensure_container();
+        // colocar placeholder vacío hasta inicializar pipeline
+        place_black_placeholder();
+    }
+
+    GtkWidget *parent = gtk_widget_get_parent(container);
+    g_print("[StreamSlot::get_widget] Devuelvo widget %p con padre %p (%s)\n",
+            container,
+            parent,
+            parent ? G_OBJECT_TYPE_NAME(parent) : "NULL");
+    return container;
+}
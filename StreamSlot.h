@@ -1,38 +1,239 @@
-#ifndef STREAMSLOT_H
-#define STREAMSLOT_H
-
-#include <gtk/gtk.h>
-#include <gst/gst.h>
-#include <string>
-#include "Watchdog.h"
-
-class StreamSlot {
-public:
-    StreamSlot();
-    ~StreamSlot();
-
-    void init(int index);
-    void init_with_streamid(const std::string &streamid);
-    // void init_with_udp_port(const std::string &port);
-    void init_with_udp_port_safe(const std::string &port);
-    void init_with_udp_port_fast(const std::string &port);
-
-    GtkWidget* get_widget();
-
-    bool watchdog_enabled = true;  // por defecto activo
-
-private:
-    GtkWidget* container = nullptr;
-    GtkWidget* video_widget = nullptr;
-    GstElement* pipeline = nullptr;
-    Watchdog* watchdog = nullptr;
-
-    void on_watchdog_event(bool show_black);
-    void setup_udp_pipeline(const std::string &port, const std::string &pipeline_str);
-    
-    void remove_existing_video_widget();
-    void place_black_placeholder();
-    void init_with_black_screen();
-};
-
-#endif // STREAMSLOT_H
+#ifndef STREAMSLOT_H
+#define STREAMSLOT_H
+
+#include <gtk/gtk.h>
+#include <gst/gst.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Watchdog.h"
+#include "PipelineDesc.h"
+#include "SlotMetrics.h"
+#include "Reconnector.h"
+#include "CodecCache.h"
+#include "UdpIngest.h"
+#include "RtpDemux.h"
+#include "FileSource.h"
+#include "JitterController.h"
+#include "ReplayBuffer.h"
+#include "LayoutConfig.h"
+
+class MosaicRenderer;
+
+class StreamSlot {
+public:
+    // Se llama (hilo principal) cuando llega el primer frame tras un init_*
+    using LiveCallback = std::function<void()>;
+    // Se llama en el hilo de streaming con cada frame que renderiza el sink (solo headless)
+    using FrameCallback = std::function<void(GstBuffer *buffer, GstCaps *caps)>;
+
+    StreamSlot();
+    ~StreamSlot();
+
+    void init(int index);
+    int get_index() const { return slot_index; }
+    void init_with_streamid(const std::string &streamid);
+    // void init_with_udp_port(const std::string &port);
+    void init_with_udp_port_safe(const std::string &port);
+    void init_with_udp_port_fast(const std::string &port);
+    // Archivo grabado en bucle (FileSource), sin red: realtime sigue los
+    // tiempos del archivo; si no, se decodifica tan rápido como se pueda
+    // (sink sin sincronización). Los slots con la misma ruta comparten el mapeo.
+    void init_with_file(const std::string &path, bool realtime);
+
+    // Standby: SRT, UDP_SAFE y UDP_FAST quedan conectados y parseados detrás
+    // de un input-selector; cambiar de modo no reconstruye el pipeline.
+    void init_standby(const std::string &streamid, const std::string &port,
+                      StreamMode initial_mode, unsigned long budget_bytes);
+    // Cambia la rama activa y espera el próximo keyframe. false si no hay standby.
+    bool select_mode(StreamMode new_mode);
+    bool is_standby() const { return standby; }
+
+    // Detiene el pipeline y deja el slot en negro (libera puertos/conexiones)
+    void stop();
+
+    // Slot oculto: solo se decodifican keyframes. Al volver a mostrarse se
+    // retoma el decode completo en el próximo keyframe (dentro de un GOP).
+    void set_visible(bool visible);
+    bool is_visible() const { return decode_policy.load() != DECODE_KEYFRAMES; }
+    // Frames descartados antes del decoder desde la última llamada
+    guint64 take_hidden_drops() { return hidden_drops.exchange(0); }
+
+    GtkWidget* get_widget();
+
+    // Con renderer, el slot entrega frames I420/NV12 a un widget común en vez
+    // de usar su propio gtksink. Se aplica en el próximo init_*.
+    void set_renderer(MosaicRenderer *r);
+    void set_live_callback(LiveCallback cb) { live_callback = cb; }
+
+    // Sin GTK: el slot termina en un fakesink con la misma sincronización que
+    // el gtksink de cada modo (benchmarks y pruebas). Llamar antes del primer init_*.
+    void set_headless(FrameCallback cb) { headless = true; frame_callback = cb; }
+
+    // Repetición instantánea: el tile reproduce los últimos seconds del anillo
+    // del slot con un decoder aparte; el vivo sigue recibiendo detrás. Termina
+    // sola al final del clip. false si todavía no hay video para repetir.
+    bool start_replay(int seconds);
+    void stop_replay();
+    bool is_replaying() const { return replay_pipeline != nullptr; }
+
+    // Otras resoluciones de la fuente (LayoutConfig). Se usan desde el próximo
+    // init_* y después siguen al tamaño del tile: al cambiar, el pipeline de la
+    // variante nueva arranca mientras el anterior sigue en pantalla y el tile
+    // pasa de uno a otro en el primer frame (keyframe) del nuevo.
+    void set_variants(const std::vector<SourceVariant> &list) { variants = list; variant = -1; }
+    // Alto de la variante en uso; 0 si es la fuente principal
+    int variant_height() const { return variant < 0 ? 0 : variants[variant].height; }
+    // Tamaño del tile en píxeles de dispositivo cuando no lo da el container
+    // propio (el renderer dibuja todos los tiles en un widget común)
+    void set_tile_size(int width, int height);
+
+    // Métricas del pipeline actual y estado de la reconexión (hilo principal)
+    SlotMetrics::Snapshot sample_metrics();
+    StreamMode get_mode() const { return mode.load(); }
+    // Nombre del modo para métricas y estado ("Archivo" en los slots de archivo)
+    const char* mode_label() const;
+
+    bool watchdog_enabled = true;  // por defecto activo
+
+private:
+    GtkWidget* container = nullptr;
+    GtkWidget* video_widget = nullptr;
+    GtkWidget* pending_widget = nullptr;   // widget del pipeline nuevo, hasta llegar a PLAYING
+    GstElement* pipeline = nullptr;
+    guint bus_watch_id = 0;
+    Watchdog* watchdog = nullptr;
+
+    // Cola de trabajos del slot: teardown/arranque fuera del hilo de GTK,
+    // en orden por slot y en paralelo entre slots
+    GThreadPool* jobs = nullptr;
+    std::atomic<int> generation{0};
+    std::atomic<bool> first_frame_pending{false};
+    gint64 launch_time_us = 0;
+    LiveCallback live_callback;
+    bool headless = false;
+    FrameCallback frame_callback;
+
+    bool standby = false;
+    MosaicRenderer* renderer = nullptr;
+    SlotMetrics metrics;
+
+    // Reconexión: relaunch repite el último init_* con los mismos parámetros
+    Reconnector reconnector;
+    std::function<void()> relaunch;
+    std::atomic<bool> resync_armed{false};
+
+    // Latencia del jitterbuffer adaptada a la red (solo UDP)
+    JitterController jitter;
+
+    // Arranque rápido: parámetros/keyframe de la fuente que sobreviven al pipeline
+    CodecCache codec_cache;
+
+    // Últimos segundos comprimidos de la fuente y la repetición en curso
+    ReplayBuffer replay;
+    GstElement* replay_pipeline = nullptr;
+    guint replay_bus_id = 0;
+    GtkWidget* replay_widget = nullptr;
+
+    // Ingesta UDP propia (PipelineDesc::udp_ingest) del puerto del slot, o
+    // salida del demux RTP compartido (PipelineDesc::rtp_demux)
+    UdpIngest* ingest = nullptr;
+    int demux_id = 0;
+    std::string udp_port;
+    // Fuente grabada del slot (init_with_file)
+    FileSource* file_source = nullptr;
+    std::string file_path;
+    bool file_realtime = true;
+    std::atomic<bool> warmup_pending{false};
+    GstBuffer* warmup_inflight = nullptr;   // solo hilo de streaming del decoder
+
+    // Sin señal: el tile retiene el último frame atenuado (hilo principal)
+    bool holding = false;
+    GtkWidget* hold_widget = nullptr;
+    cairo_surface_t* hold_surface = nullptr;
+    std::string hold_stamp;
+    // Último frame entregado al gtksink (con renderer lo guarda el propio renderer)
+    GMutex last_frame_lock;
+    GstBuffer* last_frame = nullptr;
+    GstCaps* last_caps = nullptr;
+
+    enum { DECODE_FULL, DECODE_KEYFRAMES, DECODE_RESUMING };
+    std::atomic<int> decode_policy{DECODE_FULL};
+    std::atomic<guint64> hidden_drops{0};
+
+    // Id del slot y modo actual (los lee el scheduler desde los hilos de streaming)
+    int slot_index = 0;
+    std::atomic<StreamMode> mode{StreamMode::SRT_MOSAIC};
+
+    // Tamaño del tile en píxeles de dispositivo
+    int tile_width = 0;
+    int tile_height = 0;
+    guint tile_size_timer = 0;
+    std::atomic<int> skip_frame_mode{0};
+
+    // Variantes de resolución; variant es la elegida (-1 = fuente principal)
+    std::vector<SourceVariant> variants;
+    int variant = -1;
+    // Cambio de variante: el pipeline anterior sigue mostrando (sin tocar el
+    // estado del slot) hasta que el nuevo entrega su primer frame
+    bool overlap_next_launch = false;
+    GstElement* outgoing = nullptr;
+    UdpIngest* outgoing_ingest = nullptr;
+    guint outgoing_timer = 0;
+    std::atomic<bool> outgoing_cut{false};
+    // Probe de frames del pipeline actual (watchdog, métricas, primer frame)
+    GstPad* frame_probe_pad = nullptr;
+    gulong frame_probe_id = 0;
+
+    void on_watchdog_event(bool show_black);
+    void setup_udp_pipeline(const std::string &port, const std::string &pipeline_str);
+    void launch_pipeline(const std::string &pipeline_str, const char *label);
+    void detach_pipeline();
+    void queue_job(GstElement *old_pipeline, GstElement *new_pipeline, GstElement *restart_source = nullptr);
+
+    void on_reconnect_action(Reconnector::Action action, const std::string &element);
+    void arm_resync_gate();
+    void stop_ingest();
+    void inject_warmup(GstPad *pad);
+    void set_hold(bool hold);
+    GstSample* last_frame_sample();
+    const char* source_element() const;
+
+    void apply_sink_mode(StreamMode sink_mode);
+    void on_pipeline_playing();
+    void on_first_frame();
+
+    void ensure_container();
+    void apply_tile_size();
+    void update_variant();
+    int choose_variant() const;
+    void retire_pipeline(GstElement *old_pipeline);
+    void finish_switch();
+    void drop_outgoing();
+    void configure_decoder(GstElement *decoder);
+    GstElement* find_video_decoder();
+    std::string display_tail(bool fast) const;
+
+    void remove_existing_video_widget();
+    void place_black_placeholder();
+    void init_with_black_screen();
+
+    static gboolean bus_call(GstBus *bus, GstMessage *msg, gpointer data);
+    static gboolean replay_bus_call(GstBus *bus, GstMessage *msg, gpointer data);
+    static GstBusSyncReply bus_sync_cb(GstBus *bus, GstMessage *msg, gpointer data);
+    static GstPadProbeReturn buffer_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn outgoing_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn decode_policy_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn keyframe_gate_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static GstPadProbeReturn resync_gate_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data);
+    static void run_job(gpointer data, gpointer user_data);
+    static void on_size_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data);
+    static gboolean on_tile_size_timeout(gpointer user_data);
+    static gboolean on_outgoing_timeout(gpointer user_data);
+    static void on_sink_handoff(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer user_data);
+    static gboolean on_hold_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data);
+    static void on_deep_element_added(GstBin *bin, GstBin *sub_bin, GstElement *element, gpointer user_data);
+};
+
+#endif // STREAMSLOT_H
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstring>
+#include <gst/video/video.h>
+#include "TestSender.h"
+
+namespace TestSender {
+
+// La marca son bloques de luma de 16x16 (alineados a macrobloques, sobreviven
+// al encoder): 32 bits de hora + 2 bloques de control (1, 0) en la primera fila.
+static const int kBlock = 16;
+static const int kBits = 32;
+static const guint8 kHigh = 235, kLow = 16;
+
+static GstPadProbeReturn stamp_probe_cb(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    GstBuffer *buffer = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+    GST_PAD_PROBE_INFO_DATA(info) = buffer;
+
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    GstVideoInfo vinfo;
+    bool ok = caps && gst_video_info_from_caps(&vinfo, caps);
+    if (caps) gst_caps_unref(caps);
+    if (!ok || GST_VIDEO_INFO_WIDTH(&vinfo) < (kBits + 2) * kBlock) return GST_PAD_PROBE_OK;
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, &vinfo, buffer, GST_MAP_WRITE)) return GST_PAD_PROBE_OK;
+
+    guint32 now = (guint32)g_get_monotonic_time();
+    guint8 *y = static_cast<guint8 *>(GST_VIDEO_FRAME_COMP_DATA(&frame, 0));
+    int stride = GST_VIDEO_FRAME_COMP_STRIDE(&frame, 0);
+    for (int b = 0; b < kBits + 2; ++b) {
+        bool one = b < kBits ? ((now >> (kBits - 1 - b)) & 1) : (b == kBits);
+        for (int row = 0; row < kBlock; ++row)
+            memset(y + (size_t)row * stride + b * kBlock, one ? kHigh : kLow, kBlock);
+    }
+    gst_video_frame_unmap(&frame);
+    return GST_PAD_PROBE_OK;
+}
+
+bool read_stamp(GstBuffer *buffer, GstCaps *caps, guint32 *stamp_us) {
+    GstVideoInfo vinfo;
+    if (!caps || !gst_video_info_from_caps(&vinfo, caps)) return false;
+    if (GST_VIDEO_INFO_WIDTH(&vinfo) < (kBits + 2) * kBlock || GST_VIDEO_INFO_HEIGHT(&vinfo) < kBlock) return false;
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, &vinfo, buffer, GST_MAP_READ)) return false;
+
+    const guint8 *y = static_cast<const guint8 *>(GST_VIDEO_FRAME_COMP_DATA(&frame, 0));
+    int stride = GST_VIDEO_FRAME_COMP_STRIDE(&frame, 0);
+    // Centro de cada bloque
+    auto bit = [&](int b) { return y[(size_t)(kBlock / 2) * stride + b * kBlock + kBlock / 2] > 128; };
+
+    bool valid = bit(kBits) && !bit(kBits + 1);
+    guint32 value = 0;
+    for (int b = 0; b < kBits; ++b) value = (value << 1) | (bit(b) ? 1u : 0u);
+    gst_video_frame_unmap(&frame);
+
+    if (valid) *stamp_us = value;
+    return valid;
+}
+
+GstElement* start(StreamMode mode, int port, const Options &options, int count) {
+    std::string source =
+        "videotestsrc name=src is-live=true pattern=" + std::string(options.pattern) + " ! "
+        "video/x-raw,format=I420,width=" + std::to_string(options.width) +
+        ",height=" + std::to_string(options.height) +
+        ",framerate=" + std::to_string(options.fps) + "/1 ! "
+        "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=" + std::to_string(options.fps) +
+        " bitrate=" + std::to_string(options.bitrate_kbps) + " ! h264parse config-interval=-1 ! ";
+
+    count = std::max(1, count);
+    std::string desc;
+    if (mode == StreamMode::SRT_MOSAIC) {
+        // srtsink en modo listener acepta varios callers en el mismo puerto
+        desc = source + "mpegtsmux ! srtsink uri=srt://:" + std::to_string(port) +
+               "?mode=listener wait-for-connection=false sync=false";
+    } else {
+        std::string clients;
+        for (int i = 0; i < count; ++i)
+            clients += (i ? "," : "") + std::string("127.0.0.1:") + std::to_string(port + i);
+        desc = source + "rtph264pay pt=96 config-interval=-1 ! "
+               "multiudpsink clients=" + clients + " sync=false";
+    }
+
+    GError *error = nullptr;
+    GstElement *sender = gst_parse_launch(desc.c_str(), &error);
+    if (!sender) {
+        g_printerr("[TestSender] Error creando emisor: %s\n", error ? error->message : "?");
+        if (error) g_error_free(error);
+        return nullptr;
+    }
+
+    if (options.stamp) {
+        GstElement *src = gst_bin_get_by_name(GST_BIN(sender), "src");
+        GstPad *pad = gst_element_get_static_pad(src, "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, stamp_probe_cb, NULL, NULL);
+        gst_object_unref(pad);
+        gst_object_unref(src);
+    }
+
+    if (gst_element_set_state(sender, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+        g_printerr("[TestSender] No se pudo arrancar el emisor (%s, puerto %d)\n",
+                   PipelineDesc::mode_name(mode), port);
+        gst_object_unref(sender);
+        return nullptr;
+    }
+    return sender;
+}
+
+void stop(GstElement *sender) {
+    if (!sender) return;
+    gst_element_set_state(sender, GST_STATE_NULL);
+    gst_object_unref(sender);
+}
+
+} // namespace TestSender
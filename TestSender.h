@@ -0,0 +1,33 @@
+#ifndef TESTSENDER_H
+#define TESTSENDER_H
+
+#include <gst/gst.h>
+#include <string>
+#include "PipelineDesc.h"
+
+// Emisores locales para benchmarks: patrón de prueba -> H.264 -> RTP/UDP o
+// MPEG-TS/SRT (listener) en localhost, sin encoder externo.
+namespace TestSender {
+
+    struct Options {
+        int width = 640;
+        int height = 360;
+        int fps = 30;
+        int bitrate_kbps = 2000;
+        const char *pattern = "ball";
+        bool stamp = false;   // hora de captura en la imagen (ver read_stamp)
+    };
+
+    // UDP_SAFE/UDP_FAST: RTP a 127.0.0.1:port. SRT_MOSAIC: listener en :port.
+    // Con count > 1 un solo encoder alimenta los puertos UDP port .. port+count-1
+    // (en SRT los count receptores se conectan al mismo listener).
+    // Devuelve el pipeline ya en PLAYING (nullptr si falla).
+    GstElement* start(StreamMode mode, int port, const Options &options, int count = 1);
+    void stop(GstElement *sender);
+
+    // Hora (g_get_monotonic_time, 32 bits bajos) estampada por un emisor con
+    // stamp=true. false si el frame no trae marca legible.
+    bool read_stamp(GstBuffer *buffer, GstCaps *caps, guint32 *stamp_us);
+}
+
+#endif // TESTSENDER_H
@@ -0,0 +1,237 @@
+#include <cstring>
+#include "UdpIngest.h"
+#include "DecoderScheduler.h"
+#include "PipelineDesc.h"
+#include "ProcStats.h"
+
+#ifdef G_OS_WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+// Datagramas por syscall y tamaño de cada buffer (RTP sobre Ethernet, MTU 1500)
+static const int kBatch = 32;
+static const guint kDatagramSize = 2048;
+// Cola máxima del appsrc; más allá el pipeline no da abasto y se descarta acá
+static const guint64 kMaxQueueBytes = 4 * 1024 * 1024;
+
+UdpIngest::UdpIngest() {}
+
+UdpIngest::~UdpIngest() {
+    stop();
+}
+
+UdpIngest* UdpIngest::attach(GstElement *pipeline, const std::string &name, int port) {
+    if (!pipeline || port <= 0) return nullptr;
+    GstElement *element = gst_bin_get_by_name(GST_BIN(pipeline), name.c_str());
+    if (!element) return nullptr;
+
+    UdpIngest *ingest = nullptr;
+    if (strcmp(G_OBJECT_TYPE_NAME(element), "GstAppSrc") == 0) {
+        ingest = new UdpIngest();
+        if (!ingest->start(element, port)) {
+            delete ingest;
+            ingest = nullptr;
+        }
+    }
+    gst_object_unref(element);
+    return ingest;
+}
+
+bool UdpIngest::open_socket() {
+    GError *error = nullptr;
+    socket = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, &error);
+    if (!socket) {
+        g_printerr("[UdpIngest] No se pudo crear el socket: %s\n", error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    // Buffer de kernel grande: absorbe las ráfagas mientras el hilo no está en el recv
+    int wanted = PipelineDesc::udp_recv_buffer();
+    g_socket_set_option(socket, SOL_SOCKET, SO_RCVBUF, wanted, NULL);
+    g_socket_get_option(socket, SOL_SOCKET, SO_RCVBUF, &recv_buffer, NULL);
+    if (recv_buffer < wanted)
+        g_print("[UdpIngest] Puerto %d: SO_RCVBUF %d de %d bytes pedidos (subir net.core.rmem_max)\n",
+                port, recv_buffer, wanted);
+
+    // Reuso: el udpsrc/ingesta del pipeline anterior puede seguir cerrándose
+    GInetAddress *any = g_inet_address_new_any(G_SOCKET_FAMILY_IPV4);
+    GSocketAddress *address = g_inet_socket_address_new(any, (guint16)port);
+    gboolean bound = g_socket_bind(socket, address, TRUE, &error);
+    g_object_unref(address);
+    g_object_unref(any);
+    if (!bound) {
+        g_printerr("[UdpIngest] No se pudo abrir el puerto %d: %s\n", port, error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    const std::string &group = PipelineDesc::udp_multicast_group();
+    if (!group.empty()) {
+        GInetAddress *group_address = g_inet_address_new_from_string(group.c_str());
+        const std::string &iface = PipelineDesc::udp_multicast_iface();
+        gboolean joined = group_address &&
+            g_socket_join_multicast_group(socket, group_address, FALSE, iface.empty() ? NULL : iface.c_str(), &error);
+        if (group_address) g_object_unref(group_address);
+        if (!joined) {
+            g_printerr("[UdpIngest] No se pudo unir al grupo %s en el puerto %d: %s\n",
+                       group.c_str(), port, error ? error->message : "dirección inválida");
+            if (error) g_error_free(error);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UdpIngest::start(GstElement *src, int udp_port) {
+    stop();
+    port = udp_port;
+    appsrc = GST_ELEMENT(gst_object_ref(src));
+    callback = [this](GstBuffer **buffers, int count) { push_batch(buffers, count); };
+    return start_thread();
+}
+
+bool UdpIngest::start(int udp_port, BatchCallback batch_callback) {
+    stop();
+    port = udp_port;
+    callback = batch_callback;
+    return start_thread();
+}
+
+bool UdpIngest::start_thread() {
+    if (!open_socket()) {
+        stop();
+        return false;
+    }
+
+    pool = gst_buffer_pool_new();
+    GstStructure *config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, NULL, kDatagramSize, kBatch * 2, 0);
+    gst_buffer_pool_set_config(pool, config);
+    gst_buffer_pool_set_active(pool, TRUE);
+
+    cancellable = g_cancellable_new();
+    thread = g_thread_new("udp-ingest", &UdpIngest::thread_func, this);
+
+    g_print("[UdpIngest] Puerto %d%s%s: lotes de hasta %d datagramas, SO_RCVBUF %d bytes\n",
+            port, PipelineDesc::udp_multicast_group().empty() ? "" : ", grupo ",
+            PipelineDesc::udp_multicast_group().c_str(), kBatch, recv_buffer);
+    return true;
+}
+
+void UdpIngest::stop() {
+    if (thread) {
+        g_cancellable_cancel(cancellable);
+        g_thread_join(thread);
+        thread = nullptr;
+    }
+    if (cancellable) g_object_unref(cancellable);
+    cancellable = nullptr;
+
+    if (socket) {
+        g_socket_close(socket, NULL);
+        g_object_unref(socket);
+        socket = nullptr;
+    }
+    if (pool) {
+        gst_buffer_pool_set_active(pool, FALSE);
+        gst_object_unref(pool);
+        pool = nullptr;
+    }
+    if (appsrc) gst_object_unref(appsrc);
+    appsrc = nullptr;
+    callback = nullptr;
+}
+
+gpointer UdpIngest::thread_func(gpointer data) {
+    static_cast<UdpIngest *>(data)->run();
+    return NULL;
+}
+
+void UdpIngest::run() {
+    // Hilo creado desde GTK: no heredar su núcleo fijo
+    DecoderScheduler::instance().release_current_thread();
+
+    GstBuffer *buffers[kBatch] = {};
+    GstMapInfo maps[kBatch];
+    GInputVector vectors[kBatch];
+    GInputMessage messages[kBatch];
+
+    while (!g_cancellable_is_cancelled(cancellable)) {
+        // Los buffers entregados se reponen del pool; los no usados siguen mapeados
+        bool ready = true;
+        for (int i = 0; i < kBatch; ++i) {
+            if (!buffers[i]) {
+                if (gst_buffer_pool_acquire_buffer(pool, &buffers[i], NULL) != GST_FLOW_OK) {
+                    buffers[i] = nullptr;
+                    ready = false;
+                    break;
+                }
+                gst_buffer_map(buffers[i], &maps[i], GST_MAP_WRITE);
+                vectors[i].buffer = maps[i].data;
+                vectors[i].size = maps[i].size;
+            }
+            memset(&messages[i], 0, sizeof(messages[i]));
+            messages[i].vectors = &vectors[i];
+            messages[i].num_vectors = 1;
+        }
+        if (!ready) break;
+
+        GError *error = nullptr;
+        gint received = g_socket_receive_messages(socket, messages, kBatch, 0, cancellable, &error);
+        if (received < 0) {
+            bool cancelled = g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+            if (!cancelled) g_printerr("[UdpIngest] Puerto %d: %s\n", port, error->message);
+            g_error_free(error);
+            if (cancelled) break;
+            continue;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            gst_buffer_unmap(buffers[i], &maps[i]);
+            gst_buffer_set_size(buffers[i], messages[i].bytes_received);
+        }
+        if (received > 0) callback(buffers, received);
+        for (int i = 0; i < received; ++i) buffers[i] = nullptr;
+
+        datagrams.fetch_add(received, std::memory_order_relaxed);
+        if (received > 0) batches.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (int i = 0; i < kBatch; ++i) {
+        if (!buffers[i]) continue;
+        gst_buffer_unmap(buffers[i], &maps[i]);
+        gst_buffer_unref(buffers[i]);
+    }
+}
+
+void UdpIngest::push_batch(GstBuffer **buffers, int count) {
+    for (int i = 0; i < count; ++i)
+        if (!push(appsrc, buffers[i])) app_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool UdpIngest::push(GstElement *appsrc, GstBuffer *buffer) {
+    // Pipeline frenado o cambiando de estado: se descarta acá, contado
+    guint64 level = 0;
+    g_object_get(appsrc, "current-level-bytes", &level, NULL);
+    bool full = level > kMaxQueueBytes;
+    if (!full) {
+        GstFlowReturn ret;
+        g_signal_emit_by_name(appsrc, "push-buffer", buffer, &ret);
+    }
+    gst_buffer_unref(buffer);
+    return !full;
+}
+
+UdpIngest::Stats UdpIngest::stats() {
+    Stats s;
+    s.datagrams = datagrams.load(std::memory_order_relaxed);
+    s.batches = batches.load(std::memory_order_relaxed);
+    s.app_dropped = app_dropped.load(std::memory_order_relaxed);
+    s.recv_buffer = recv_buffer;
+    if (socket)
+        s.has_kernel = ProcStats::udp_socket_stats(g_socket_get_fd(socket), &s.kernel_drops, &s.kernel_queue_bytes);
+    return s;
+}
@@ -0,0 +1,74 @@
+#ifndef UDPINGEST_H
+#define UDPINGEST_H
+
+#include <gio/gio.h>
+#include <gst/gst.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+// Recepción UDP propia de una rama RTP: un hilo por socket lee varios
+// datagramas por syscall (g_socket_receive_messages -> recvmmsg) en buffers
+// de un pool y los entrega al appsrc "rtpsrc" del pipeline (o, en el demux
+// RTP, a RtpDemux, que los reparte por SSRC). El socket tiene
+// un buffer de kernel grande y se cuentan los descartes del kernel (cola del
+// socket llena), para separarlos de las pérdidas de red (huecos RTP).
+class UdpIngest {
+public:
+    struct Stats {
+        guint64 datagrams = 0;
+        guint64 batches = 0;            // syscalls con al menos un datagrama
+        guint64 app_dropped = 0;        // appsrc lleno: descartados antes del pipeline
+        bool has_kernel = false;        // contadores del kernel disponibles (Linux)
+        guint64 kernel_drops = 0;
+        guint64 kernel_queue_bytes = 0;
+        int recv_buffer = 0;            // SO_RCVBUF efectivo
+    };
+
+    // Lote recibido (hilo de la ingesta): toma las referencias de los buffers
+    using BatchCallback = std::function<void(GstBuffer **buffers, int count)>;
+
+    UdpIngest();
+    ~UdpIngest();
+
+    // Si el elemento name del pipeline es un appsrc (ingesta activa en
+    // PipelineDesc), crea y arranca la ingesta del puerto. Si no, nullptr.
+    static UdpIngest* attach(GstElement *pipeline, const std::string &name, int port);
+
+    // Abre el socket (puerto + grupo multicast opcional) y arranca el hilo,
+    // que entrega cada datagrama al appsrc o cada lote al callback
+    bool start(GstElement *appsrc, int port);
+    bool start(int port, BatchCallback callback);
+    // Despierta al hilo (cancellable), lo espera y cierra el socket
+    void stop();
+
+    // Hilo principal
+    Stats stats();
+
+    // Entrega un datagrama al appsrc salvo que su cola esté llena; toma la
+    // referencia del buffer y devuelve false si se descartó
+    static bool push(GstElement *appsrc, GstBuffer *buffer);
+
+private:
+    GSocket* socket = nullptr;
+    GCancellable* cancellable = nullptr;
+    GThread* thread = nullptr;
+    GstElement* appsrc = nullptr;
+    GstBufferPool* pool = nullptr;
+    int port = 0;
+    int recv_buffer = 0;
+    BatchCallback callback;
+
+    std::atomic<guint64> datagrams{0};
+    std::atomic<guint64> batches{0};
+    std::atomic<guint64> app_dropped{0};
+
+    bool open_socket();
+    bool start_thread();
+    void push_batch(GstBuffer **buffers, int count);
+    void run();
+
+    static gpointer thread_func(gpointer data);
+};
+
+#endif // UDPINGEST_H
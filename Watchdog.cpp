@@ -1,40 +1,204 @@
-#include "Watchdog.h"
-#include <chrono>
-#include <thread>
-
-Watchdog::Watchdog(Callback cb, int timeout) : callback(cb), timeout_ms(timeout), buffer_count(0), running(false) {}
-
-Watchdog::~Watchdog() {
-    stop();
-}
-
-void Watchdog::notify_buffer() {
-    buffer_count++;
-}
-
-void Watchdog::start() {
-    running = true;
-    watchdog_thread = std::thread(&Watchdog::run, this);
-}
-
-void Watchdog::stop() {
-    running = false;
-    if (watchdog_thread.joinable()) {
-        watchdog_thread.join();
-    }
-}
-
-void Watchdog::run() {
-    while (running) {
-        int count_before = buffer_count.load();
-        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
-
-        int count_after = buffer_count.load();
-        if (count_after == count_before) {
-            // No se recibieron buffers en el timeout
-            callback(true); // mostrar pantalla negra
-        } else {
-            callback(false); // stream activo, restaurar video
-        }
-    }
-}
+#include <cstdlib>
+#include <gst/video/video.h>
+#include "Watchdog.h"
+#include "HealthMonitor.h"
+#include "FrameCheck.h"
+
+// ===== Análisis de contenido =====
+
+struct ContentConfig {
+    bool enabled = true;
+    gint64 interval_us = 1000 * 1000;
+    gint64 hold_us = 10 * G_USEC_PER_SEC;
+};
+
+static const ContentConfig& content_config() {
+    static const ContentConfig config = [] {
+        ContentConfig c;
+        const char *env = g_getenv("MOSAIC_CONTENT_CHECK");
+        if (env && *env) c.enabled = atoi(env) != 0;
+        env = g_getenv("MOSAIC_CONTENT_INTERVAL_MS");
+        if (env && atoi(env) > 0) c.interval_us = (gint64)atoi(env) * 1000;
+        env = g_getenv("MOSAIC_CONTENT_SECONDS");
+        if (env && atoi(env) > 0) c.hold_us = (gint64)atoi(env) * G_USEC_PER_SEC;
+        return c;
+    }();
+    return config;
+}
+
+// Compartido entre el Watchdog y el hilo de análisis: un trabajo en curso
+// puede terminar después de que el slot se destruyó
+struct Watchdog::ContentTrack {
+    std::atomic<int> state{(int)Content::NORMAL};
+    std::atomic<bool> busy{false};        // hay un frame encolado o en análisis
+    std::atomic<guint> generation{0};     // cambia con cada start()
+
+    // Solo el hilo de análisis
+    guint seen_generation = 0;
+    bool has_previous = false;
+    FrameCheck::LumaStats previous;
+    gint64 black_since = 0;
+    gint64 flat_since = 0;
+    gint64 same_since = 0;
+};
+
+struct ContentJob {
+    std::shared_ptr<Watchdog::ContentTrack> track;
+    GstBuffer *buffer;
+    GstCaps *caps;
+    gint64 time_us;
+    guint generation;
+};
+
+// Luma de 8 bits en un plano propio (I420, NV12, Y42B, GRAY8...)
+static bool analyze_frame(GstBuffer *buffer, GstCaps *caps, FrameCheck::LumaStats *stats) {
+    GstVideoInfo info;
+    if (!gst_video_info_from_caps(&info, caps)) return false;
+    if (!GST_VIDEO_INFO_IS_YUV(&info) && !GST_VIDEO_INFO_IS_GRAY(&info)) return false;
+    if (GST_VIDEO_INFO_COMP_DEPTH(&info, 0) != 8 || GST_VIDEO_INFO_COMP_PSTRIDE(&info, 0) != 1) return false;
+
+    GstVideoFrame frame;
+    if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ)) return false;
+    FrameCheck::analyze(static_cast<const uint8_t *>(GST_VIDEO_FRAME_COMP_DATA(&frame, 0)),
+                        GST_VIDEO_FRAME_COMP_STRIDE(&frame, 0),
+                        GST_VIDEO_FRAME_COMP_WIDTH(&frame, 0),
+                        GST_VIDEO_FRAME_COMP_HEIGHT(&frame, 0), stats);
+    gst_video_frame_unmap(&frame);
+    return true;
+}
+
+static gint64 track_since(gint64 since, bool condition, gint64 now_us) {
+    if (!condition) return 0;
+    return since ? since : now_us;
+}
+
+static void run_content_job(gpointer data, gpointer) {
+    ContentJob *job = static_cast<ContentJob *>(data);
+    Watchdog::ContentTrack &t = *job->track;
+
+    if (job->generation != t.seen_generation) {
+        t.seen_generation = job->generation;
+        t.has_previous = false;
+        t.black_since = t.flat_since = t.same_since = 0;
+    }
+
+    FrameCheck::LumaStats stats;
+    if (analyze_frame(job->buffer, job->caps, &stats)) {
+        gint64 now = job->time_us;
+        bool same = t.has_previous && FrameCheck::same_picture(t.previous, stats);
+        t.black_since = track_since(t.black_since, FrameCheck::is_black(stats), now);
+        t.flat_since = track_since(t.flat_since, FrameCheck::is_flat(stats), now);
+        t.same_since = track_since(t.same_since, same, now);
+        t.previous = stats;
+        t.has_previous = true;
+
+        // Negro también es liso y repetido: gana el diagnóstico más específico
+        gint64 hold = content_config().hold_us;
+        Watchdog::Content content = Watchdog::Content::NORMAL;
+        if (t.black_since && now - t.black_since >= hold) content = Watchdog::Content::BLACK;
+        else if (t.flat_since && now - t.flat_since >= hold) content = Watchdog::Content::FLAT;
+        else if (t.same_since && now - t.same_since >= hold) content = Watchdog::Content::FROZEN;
+        // Un start() mientras se analizaba invalida el resultado
+        if (job->generation == t.generation.load()) t.state = (int)content;
+    }
+
+    gst_buffer_unref(job->buffer);
+    gst_caps_unref(job->caps);
+    t.busy = false;
+    delete job;
+}
+
+// Un solo hilo para todos los slots: a un frame por segundo por slot sobra
+static GThreadPool* content_pool() {
+    static GThreadPool *pool = g_thread_pool_new(&run_content_job, NULL, 1, FALSE, NULL);
+    return pool;
+}
+
+// ===== Watchdog =====
+
+Watchdog::Watchdog(Callback cb, int timeout) : buffer_count(0), timeout_ms(timeout), running(false), callback(cb) {
+    if (content_config().enabled) track = std::make_shared<ContentTrack>();
+}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::notify_buffer() {
+    buffer_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Watchdog::notify_frame(GstPad *pad, GstBuffer *buffer) {
+    if (!track || !buffer) return;
+
+    // Un solo hilo gana el turno de muestreo; el resto sale con una lectura atómica
+    gint64 now = g_get_monotonic_time();
+    gint64 due = next_sample_us.load(std::memory_order_relaxed);
+    if (now < due) return;
+    if (!next_sample_us.compare_exchange_strong(due, now + content_config().interval_us)) return;
+    // El análisis anterior no terminó: se salta esta muestra
+    if (track->busy.exchange(true)) return;
+
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    if (!caps) {
+        track->busy = false;
+        return;
+    }
+    g_thread_pool_push(content_pool(),
+                       new ContentJob{track, gst_buffer_ref(buffer), caps, now, track->generation.load()}, NULL);
+}
+
+void Watchdog::start() {
+    last_count = buffer_count.load(std::memory_order_relaxed);
+    last_activity_us = g_get_monotonic_time();
+    stalled = false;
+    // Pipeline nuevo: el historial de contenido no sirve (check_content avisa la vuelta a normal)
+    if (track) {
+        track->generation.fetch_add(1);
+        track->state = (int)Content::NORMAL;
+        next_sample_us = 0;
+    }
+    if (!running) {
+        running = true;
+        HealthMonitor::instance().add(this);
+    }
+}
+
+void Watchdog::stop() {
+    if (running) {
+        running = false;
+        HealthMonitor::instance().remove(this);
+    }
+}
+
+// Devuelve true si cambió el estado (stalled <-> activo)
+bool Watchdog::check(gint64 now_us) {
+    int count = buffer_count.load(std::memory_order_relaxed);
+    if (count != last_count) {
+        last_count = count;
+        last_activity_us = now_us;
+    }
+
+    bool now_stalled = (now_us - last_activity_us) >= (gint64)timeout_ms * 1000;
+    if (now_stalled == stalled) return false;
+    stalled = now_stalled;
+    return true;
+}
+
+// Devuelve true si cambió el contenido detectado
+bool Watchdog::check_content() {
+    if (!track) return false;
+    Content now_content = (Content)track->state.load();
+    if (now_content == content_state) return false;
+    content_state = now_content;
+    return true;
+}
+
+const char* Watchdog::content_name(Content content) {
+    switch (content) {
+        case Content::FROZEN: return "congelado";
+        case Content::BLACK: return "negro";
+        case Content::FLAT: return "color fijo";
+        default: return "normal";
+    }
+}
@@ -1,34 +1,73 @@
-#ifndef WATCHDOG_H
-#define WATCHDOG_H
-
-#include <gst/gst.h>
-#include <atomic>
-#include <thread>
-#include <functional>
-
-class Watchdog {
-public:
-    // callback para mostrar pantalla negra
-    using Callback = std::function<void(bool show_black)>;
-
-    Watchdog(Callback callback, int timeout_ms = 3000);
-    ~Watchdog();
-
-    // Indicar que se recibió un buffer (reset del contador)
-    void notify_buffer();
-
-    // Iniciar y detener el thread del watchdog
-    void start();
-    void stop();
-
-private:
-    void run();
-
-    std::atomic<int> buffer_count;
-    int timeout_ms;
-    std::thread watchdog_thread;
-    bool running;
-    Callback callback;
-};
-
-#endif // WATCHDOG_H
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <gst/gst.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Estado de salud de un stream. Ya no tiene hilo propio: lo revisa el
+// HealthMonitor compartido desde el main loop de GLib.
+//
+// Además del flujo de buffers mira el contenido: un encoder trabado que
+// repite la misma imagen, o que manda negro o un color fijo, sigue enviando
+// buffers. Cada MOSAIC_CONTENT_INTERVAL_MS (1000) se toma un frame
+// decodificado y se analiza su luma (FrameCheck) en un hilo compartido por
+// todos los slots, nunca en el de streaming. El estado se informa si dura
+// MOSAIC_CONTENT_SECONDS (10). MOSAIC_CONTENT_CHECK=0 lo desactiva.
+class Watchdog {
+public:
+    // callback para mostrar pantalla negra (se llama en el hilo principal)
+    using Callback = std::function<void(bool show_black)>;
+
+    enum class Content { NORMAL, FROZEN, BLACK, FLAT };
+    // Cambio de contenido (hilo principal)
+    using ContentCallback = std::function<void(Content content)>;
+
+    Watchdog(Callback callback, int timeout_ms = 3000);
+    ~Watchdog();
+
+    // Indicar que se recibió un buffer (seguro desde hilos de streaming)
+    void notify_buffer();
+    // Frame decodificado que sale por pad (hilo de streaming). Casi siempre
+    // vuelve enseguida; cuando toca muestrear, encola una referencia.
+    void notify_frame(GstPad *pad, GstBuffer *buffer);
+
+    // Registrar/quitar del monitor. stop() es inmediato, no bloquea.
+    void start();
+    void stop();
+
+    int get_timeout_ms() const { return timeout_ms; }
+
+    void set_content_callback(ContentCallback cb) { content_callback = cb; }
+    // Hilo principal
+    bool is_stalled() const { return stalled; }
+    Content content() const { return content_state; }
+    static const char* content_name(Content content);
+
+    // Estado compartido con el hilo de análisis (definido en Watchdog.cpp)
+    struct ContentTrack;
+
+private:
+    friend class HealthMonitor;
+
+    // Solo desde el hilo principal (HealthMonitor::tick)
+    bool check(gint64 now_us);
+    bool check_content();
+
+    std::atomic<int> buffer_count;
+    int timeout_ms;
+    bool running;
+    Callback callback;
+
+    int last_count = 0;
+    gint64 last_activity_us = 0;
+    bool stalled = false;
+
+    std::shared_ptr<ContentTrack> track;
+    std::atomic<gint64> next_sample_us{0};
+    Content content_state = Content::NORMAL;
+    ContentCallback content_callback;
+};
+
+#endif // WATCHDOG_H
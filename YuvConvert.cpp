@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <vector>
+#include "YuvConvert.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YUVCONVERT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace YuvConvert {
+
+// Coeficientes BT.601 rango limitado en punto fijo de 6 bits:
+//   R = 1.164 (Y-16) + 1.596 (V-128)
+//   G = 1.164 (Y-16) - 0.391 (U-128) - 0.813 (V-128)
+//   B = 1.164 (Y-16) + 2.018 (U-128)
+// 1.164 * 64 = 74.5 se aplica como 74 + 1/2. Todos los términos caben en
+// int16; solo B puede desbordar y se satura (queda en 255 igual que en escalar).
+enum { K_Y = 74, K_RV = 102, K_GU = 25, K_GV = 52, K_BU = 129, K_ROUND = 32 };
+
+using RowFn = void (*)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int n);
+
+static inline uint8_t clamp255(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static void row_scalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int n) {
+    for (int x = 0; x < n; ++x) {
+        int ys = y[x] - 16;
+        int yy = ys * K_Y + (ys >> 1) + K_ROUND;
+        int uu = u[x] - 128;
+        int vv = v[x] - 128;
+        dst[4 * x + 0] = clamp255((yy + K_BU * uu) >> 6);
+        dst[4 * x + 1] = clamp255((yy - K_GU * uu - K_GV * vv) >> 6);
+        dst[4 * x + 2] = clamp255((yy + K_RV * vv) >> 6);
+        dst[4 * x + 3] = 0xFF;
+    }
+}
+
+#ifdef YUVCONVERT_X86
+// 8 píxeles por iteración
+static void row_sse2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int n) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c16 = _mm_set1_epi16(16);
+    const __m128i c128 = _mm_set1_epi16(128);
+    const __m128i ky = _mm_set1_epi16(K_Y);
+    const __m128i krv = _mm_set1_epi16(K_RV);
+    const __m128i kgu = _mm_set1_epi16(K_GU);
+    const __m128i kgv = _mm_set1_epi16(K_GV);
+    const __m128i kbu = _mm_set1_epi16(K_BU);
+    const __m128i round = _mm_set1_epi16(K_ROUND);
+    const __m128i max255 = _mm_set1_epi16(255);
+    const __m128i alpha = _mm_set1_epi16((short)0xFF00);
+
+    int x = 0;
+    for (; x + 8 <= n; x += 8) {
+        __m128i Y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(y + x)), zero);
+        __m128i U = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(u + x)), zero);
+        __m128i V = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(v + x)), zero);
+
+        Y = _mm_sub_epi16(Y, c16);
+        Y = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(Y, ky), _mm_srai_epi16(Y, 1)), round);
+        U = _mm_sub_epi16(U, c128);
+        V = _mm_sub_epi16(V, c128);
+
+        __m128i R = _mm_add_epi16(Y, _mm_mullo_epi16(V, krv));
+        __m128i G = _mm_sub_epi16(_mm_sub_epi16(Y, _mm_mullo_epi16(U, kgu)), _mm_mullo_epi16(V, kgv));
+        __m128i B = _mm_adds_epi16(Y, _mm_mullo_epi16(U, kbu));
+
+        R = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(R, 6), zero), max255);
+        G = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(G, 6), zero), max255);
+        B = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(B, 6), zero), max255);
+
+        // Bytes en memoria: B G R x
+        __m128i bg = _mm_or_si128(B, _mm_slli_epi16(G, 8));
+        __m128i ra = _mm_or_si128(R, alpha);
+        _mm_storeu_si128((__m128i *)(dst + 4 * x), _mm_unpacklo_epi16(bg, ra));
+        _mm_storeu_si128((__m128i *)(dst + 4 * x + 16), _mm_unpackhi_epi16(bg, ra));
+    }
+    row_scalar(y + x, u + x, v + x, dst + 4 * x, n - x);
+}
+
+// 16 píxeles por iteración
+__attribute__((target("avx2")))
+static void row_avx2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int n) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i c16 = _mm256_set1_epi16(16);
+    const __m256i c128 = _mm256_set1_epi16(128);
+    const __m256i ky = _mm256_set1_epi16(K_Y);
+    const __m256i krv = _mm256_set1_epi16(K_RV);
+    const __m256i kgu = _mm256_set1_epi16(K_GU);
+    const __m256i kgv = _mm256_set1_epi16(K_GV);
+    const __m256i kbu = _mm256_set1_epi16(K_BU);
+    const __m256i round = _mm256_set1_epi16(K_ROUND);
+    const __m256i max255 = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi16((short)0xFF00);
+
+    int x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m256i Y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(y + x)));
+        __m256i U = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(u + x)));
+        __m256i V = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(v + x)));
+
+        Y = _mm256_sub_epi16(Y, c16);
+        Y = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(Y, ky), _mm256_srai_epi16(Y, 1)), round);
+        U = _mm256_sub_epi16(U, c128);
+        V = _mm256_sub_epi16(V, c128);
+
+        __m256i R = _mm256_add_epi16(Y, _mm256_mullo_epi16(V, krv));
+        __m256i G = _mm256_sub_epi16(_mm256_sub_epi16(Y, _mm256_mullo_epi16(U, kgu)), _mm256_mullo_epi16(V, kgv));
+        __m256i B = _mm256_adds_epi16(Y, _mm256_mullo_epi16(U, kbu));
+
+        R = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(R, 6), zero), max255);
+        G = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(G, 6), zero), max255);
+        B = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(B, 6), zero), max255);
+
+        __m256i bg = _mm256_or_si256(B, _mm256_slli_epi16(G, 8));
+        __m256i ra = _mm256_or_si256(R, alpha);
+        // unpack trabaja por carril de 128 bits: lo = [p0-3 | p8-11], hi = [p4-7 | p12-15]
+        __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+        __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256((__m256i *)(dst + 4 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 4 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    row_sse2(y + x, u + x, v + x, dst + 4 * x, n - x);
+}
+#endif
+
+static RowFn select_row_fn() {
+#ifdef YUVCONVERT_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return row_avx2;
+    if (__builtin_cpu_supports("sse2")) return row_sse2;
+#endif
+    return row_scalar;
+}
+
+static RowFn best_row_fn() {
+    static const RowFn fn = select_row_fn();
+    return fn;
+}
+
+// Una sola pasada: por fila de destino se juntan Y/U/V de las columnas de
+// origen correspondientes (vecino más cercano, muestreo al centro) y se convierten.
+static void convert_with(RowFn row_fn, const SourceFrame &src, uint8_t *dst, int dst_stride, int dst_w, int dst_h) {
+    if (dst_w <= 0 || dst_h <= 0 || src.width <= 0 || src.height <= 0) return;
+
+    // Buffers de fila reutilizados entre llamadas (uno por hilo)
+    thread_local std::vector<int> xmap;
+    thread_local std::vector<uint8_t> yrow, urow, vrow;
+    xmap.resize(dst_w);
+    yrow.resize(dst_w);
+    urow.resize(dst_w);
+    vrow.resize(dst_w);
+
+    for (int x = 0; x < dst_w; ++x)
+        xmap[x] = std::min(src.width - 1, (int)(((2LL * x + 1) * src.width) / (2LL * dst_w)));
+
+    const bool nv12 = (src.format == Format::NV12);
+    const bool same_width = (dst_w == src.width);
+
+    for (int row = 0; row < dst_h; ++row) {
+        int sy = std::min(src.height - 1, (int)(((2LL * row + 1) * src.height) / (2LL * dst_h)));
+        const uint8_t *ys = src.y + (size_t)sy * src.y_stride;
+        const uint8_t *us = src.u + (size_t)(sy >> 1) * src.u_stride;
+        const uint8_t *vs = nv12 ? nullptr : src.v + (size_t)(sy >> 1) * src.v_stride;
+
+        const uint8_t *yline = ys;
+        if (!same_width) {
+            for (int x = 0; x < dst_w; ++x) yrow[x] = ys[xmap[x]];
+            yline = yrow.data();
+        }
+
+        if (nv12) {
+            for (int x = 0; x < dst_w; ++x) {
+                int c = (xmap[x] >> 1) << 1;
+                urow[x] = us[c];
+                vrow[x] = us[c + 1];
+            }
+        } else {
+            for (int x = 0; x < dst_w; ++x) {
+                int c = xmap[x] >> 1;
+                urow[x] = us[c];
+                vrow[x] = vs[c];
+            }
+        }
+
+        row_fn(yline, urow.data(), vrow.data(), dst + (size_t)row * dst_stride, dst_w);
+    }
+}
+
+void convert_scale(const SourceFrame &src, uint8_t *dst, int dst_stride, int dst_w, int dst_h) {
+    convert_with(best_row_fn(), src, dst, dst_stride, dst_w, dst_h);
+}
+
+void convert_scale_scalar(const SourceFrame &src, uint8_t *dst, int dst_stride, int dst_w, int dst_h) {
+    convert_with(row_scalar, src, dst, dst_stride, dst_w, dst_h);
+}
+
+const char* active_kernel() {
+    RowFn fn = best_row_fn();
+#ifdef YUVCONVERT_X86
+    if (fn == row_avx2) return "avx2";
+    if (fn == row_sse2) return "sse2";
+#endif
+    return fn == row_scalar ? "scalar" : "?";
+}
+
+} // namespace YuvConvert
@@ -0,0 +1,32 @@
+#ifndef YUVCONVERT_H
+#define YUVCONVERT_H
+
+#include <cstdint>
+
+// Conversión YUV 4:2:0 -> BGRx (BT.601, rango limitado) con escalado en la
+// misma pasada: por cada fila de destino se toman las muestras de origen
+// (vecino más cercano) y se convierten con SSE2/AVX2, sin frame intermedio.
+namespace YuvConvert {
+
+    enum class Format { I420, NV12 };
+
+    struct SourceFrame {
+        Format format;
+        int width;
+        int height;
+        const uint8_t *y;  int y_stride;
+        const uint8_t *u;  int u_stride;   // NV12: plano UV intercalado
+        const uint8_t *v;  int v_stride;   // NV12: sin uso
+    };
+
+    // Escribe dst_w x dst_h píxeles BGRx (4 bytes) en dst
+    void convert_scale(const SourceFrame &src, uint8_t *dst, int dst_stride, int dst_w, int dst_h);
+
+    // Igual, forzando la versión escalar (referencia y benchmark)
+    void convert_scale_scalar(const SourceFrame &src, uint8_t *dst, int dst_stride, int dst_w, int dst_h);
+
+    // "avx2", "sse2" o "scalar"
+    const char* active_kernel();
+}
+
+#endif // YUVCONVERT_H
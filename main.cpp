@@ -1,225 +1,894 @@
-#include <gtk/gtk.h>
-#include "StreamSlot.h"
-#include <vector>
-#include <memory>
-
-enum class StreamMode {
-    SRT_MOSAIC,
-    UDP_SAFE,   // antes UDP_MULTISTREAM
-    UDP_FAST,   // antes UDP_SINGLE
-};
-
-struct AppData {
-    GtkWidget *window;
-    GtkWidget *grid;
-
-    int active_slots = 1;
-    bool layout_locked = false;
-    bool is_fullscreen = false;
-
-    StreamMode mode = StreamMode::SRT_MOSAIC;
-    std::vector<std::shared_ptr<StreamSlot>> slots;
-};
-
-// ---------- FUNCIONES AUXILIARES ----------
-
-void update_layout(AppData* app) {
-    for (int i = 0; i < 6; ++i) {
-        GtkWidget* w = app->slots[i]->get_widget();
-        if (!GTK_IS_WIDGET(w)) {
-            g_print("[ERROR] Slot %d get_widget() NO es válido\n", i + 1);
-            continue;
-        }
-
-        if (i < app->active_slots) {
-            gtk_widget_show(w);
-        } else {
-            gtk_widget_hide(w);
-        }
-    }
-}
-
-static void apply_black_background(GtkWidget *widget) {
-    GtkCssProvider *provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider,
-        R"css(
-            * {
-                background-color: black;
-                color: white;
-            }
-            window, grid, frame {
-                background-color: black;
-                border: none;
-            }
-        )css",
-        -1, nullptr);
-
-    GdkScreen *screen = gtk_window_get_screen(GTK_WINDOW(widget));
-    gtk_style_context_add_provider_for_screen(screen, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-    g_object_unref(provider);
-}
-
-// Reconstruye los pipelines dependiendo del modo
-void rebuild_pipelines(AppData* app) {
-    g_print("[INFO] Reconstruyendo pipelines en modo: %s\n",
-            app->mode == StreamMode::SRT_MOSAIC ? "SRT Mosaico" :
-            app->mode == StreamMode::UDP_SAFE? "UDP Safe" : "UDP Fast");
-
-    std::vector<std::string> stream_ids = {
-        "live.sls.com/live/stream1",
-        "live.sls.com/live/stream2",
-        "live.sls.com/live/stream3",
-        "live.sls.com/live/stream4",
-        "live.sls.com/live/stream5",
-        "live.sls.com/live/stream6"
-    };
-
-    std::vector<std::string> udp_ports = {
-        "5000", "5001", "5002", "5003", "5004", "5005"
-    };
-
-    for (int i = 0; i < 6; i++) {
-        switch (app->mode) {
-            case StreamMode::SRT_MOSAIC:
-                app->slots[i]->init_with_streamid(stream_ids[i]);
-                gtk_widget_show(app->slots[i]->get_widget());
-                break;
-
-        case StreamMode::UDP_SAFE:
-            app->slots[i]->init_with_udp_port_safe(udp_ports[i]);
-            gtk_widget_show(app->slots[i]->get_widget());
-            break;
-
-        case StreamMode::UDP_FAST:
-            app->slots[i]->init_with_udp_port_fast(udp_ports[i]);
-            gtk_widget_show(app->slots[i]->get_widget());
-            break;
-        }
-    }
-
-    update_layout(app);
-}
-
-
-// ---------- EVENTOS ----------
-
-static gboolean on_key_press(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
-    AppData *app = static_cast<AppData *>(user_data);
-    guint keyval = event->keyval;
-
-    // Bloquear layout con 'L'
-    if (keyval == GDK_KEY_l || keyval == GDK_KEY_L) {
-        app->layout_locked = !app->layout_locked;
-        g_print("[INFO] Layout bloqueado: %s\n", app->layout_locked ? "sí" : "no");
-        return TRUE;
-    }
-
-    // --- Modo UDP seguro (latencia normal) ---
-    if (keyval == GDK_KEY_v || keyval == GDK_KEY_V) {
-        app->mode = StreamMode::UDP_SAFE;
-        app->active_slots = 6;
-        rebuild_pipelines(app);
-        update_layout(app);
-        return TRUE;
-    }
-
-    // --- Modo UDP rápido (ultra low latency) ---
-    if (keyval == GDK_KEY_u || keyval == GDK_KEY_U) {
-        app->mode = StreamMode::UDP_FAST;
-        app->active_slots = 6;
-        rebuild_pipelines(app);
-        update_layout(app);
-        return TRUE;
-    }
-
-    if (keyval == GDK_KEY_m || keyval == GDK_KEY_M) {
-        app->mode = StreamMode::SRT_MOSAIC;
-        rebuild_pipelines(app);
-        update_layout(app);
-        return TRUE;
-    }
-
-    if (keyval == GDK_KEY_F11) {
-        if (app->is_fullscreen) {
-            gtk_window_unfullscreen(GTK_WINDOW(app->window));
-            app->is_fullscreen = false;
-            g_print("[INFO] Saliendo de pantalla completa\n");
-        } else {
-            gtk_window_fullscreen(GTK_WINDOW(app->window));
-            app->is_fullscreen = true;
-            g_print("[INFO] Modo pantalla completa activado\n");
-        }
-        return TRUE;
-    }
-
-    if (app->layout_locked)
-        return TRUE;
-
-    // Control de cantidad de slots (1–6)
-    if (keyval >= GDK_KEY_1 && keyval <= GDK_KEY_6) {
-        int slots = keyval - GDK_KEY_0;
-        app->active_slots = slots;
-        g_print("[INFO] Cambiando a %d espacios activos\n", slots);
-        update_layout(app);
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
-// ---------- SETUP PRINCIPAL ----------
-
-static void on_activate(GtkApplication *gtk_app, gpointer user_data) {
-    AppData *app = new AppData();
-
-    app->window = gtk_application_window_new(gtk_app);
-    gtk_window_set_title(GTK_WINDOW(app->window), "Mosaico de Streams");
-    gtk_window_set_default_size(GTK_WINDOW(app->window), 800, 600);
-    apply_black_background(app->window);
-
-    app->grid = gtk_grid_new();
-    gtk_widget_set_hexpand(app->grid, TRUE);
-    gtk_widget_set_vexpand(app->grid, TRUE);
-    gtk_container_add(GTK_CONTAINER(app->window), app->grid);
-
-    // Posiciones para 6 slots
-    const std::vector<std::pair<int, int>> posiciones = {
-        {0, 0}, {0, 1},
-        {1, 0}, {1, 1},
-        {2, 0}, {2, 1}
-    };
-
-    // Crear los slots iniciales
-    for (int i = 0; i < 6; i++) {
-        auto slot = std::make_shared<StreamSlot>();
-        app->slots.push_back(slot);
-
-        GtkWidget* w = slot->get_widget();
-        if (!w) {
-            g_printerr("[ERROR] El widget del slot %d es nulo\n", i + 1);
-            continue;
-        }
-
-        gtk_grid_attach(GTK_GRID(app->grid), w, posiciones[i].first, posiciones[i].second, 1, 1);
-    }
-
-
-    // Inicializar en modo mosaico SRT por defecto
-    rebuild_pipelines(app);
-
-    g_signal_connect(app->window, "key-press-event", G_CALLBACK(on_key_press), app);
-    gtk_widget_show_all(app->window);
-}
-
-// ---------- MAIN ----------
-
-int main(int argc, char **argv) {
-    gst_init(&argc, &argv);
-
-    GtkApplication *app = gtk_application_new("com.mosaic.streamviewer", G_APPLICATION_DEFAULT_FLAGS);
-    g_signal_connect(app, "activate", G_CALLBACK(on_activate), NULL);
-
-    int status = g_application_run(G_APPLICATION(app), argc, argv);
-    g_object_unref(app);
-    return status;
-}
+#include <gtk/gtk.h>
+#include "StreamSlot.h"
+#include "MosaicCompositor.h"
+#include "MosaicRenderer.h"
+#include "MetricsReporter.h"
+#include "Bench.h"
+#include "PipelineDesc.h"
+#include "ProcStats.h"
+#include "DecoderScheduler.h"
+#include "LayoutConfig.h"
+#include "RtpDemux.h"
+#include "ControlServer.h"
+#include "MosaicOutput.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include <memory>
+
+struct AppData {
+    GtkWidget *window;
+    GtkWidget *stack;   // "grid" (un gtksink por slot), "mosaic" (compositor) o "renderer"
+    GtkWidget *grid;
+
+    bool layout_locked = false;
+    bool is_fullscreen = false;
+    bool compositor_mode = false;
+    bool renderer_mode = true;    // sink propio: conversión+escala SIMD en un widget
+    bool standby = false;   // fuentes alternativas precargadas en cada slot
+    unsigned long standby_budget_bytes = 6 * 1024 * 1024;  // por slot
+
+    StreamMode mode = StreamMode::SRT_MOSAIC;
+    // Modo propio de algunos slots (canal de control), por id; el resto usa mode
+    std::map<int, StreamMode> slot_modes;
+    LayoutConfig config;
+    int layout_index = 0;
+
+    // Slots del layout actual, en el orden de sus celdas
+    std::vector<std::shared_ptr<StreamSlot>> slots;
+    std::vector<LayoutTile> slot_tiles;
+    // Slots que salieron del layout: ocultos, solo keyframes, listos para volver
+    std::vector<std::shared_ptr<StreamSlot>> parked;
+    std::vector<std::string> parked_sources;
+    std::vector<bool> used_ids;   // id de slot = tile del renderer y reparto de núcleos
+    std::unique_ptr<MosaicCompositor> compositor;
+    std::unique_ptr<MosaicRenderer> renderer;
+    std::unique_ptr<MetricsReporter> metrics;
+    std::unique_ptr<ControlServer> control;
+    std::unique_ptr<MosaicOutput> output;
+
+    // Muestra anterior para el log periódico de CPU
+    gint64 last_cpu_us = 0;
+    gint64 last_wall_us = 0;
+    guint64 last_repaints = 0;
+
+    // Medición "cambio de modo -> todos los tiles en vivo"
+    gint64 switch_start_us = 0;
+    int switch_remaining = 0;
+    std::vector<bool> switch_pending;
+};
+
+// Slots simultáneos como máximo (tiles del MosaicRenderer)
+static const int kMaxSlots = 64;
+
+static void on_slot_live(AppData* app, int index);
+
+// ---------- FUNCIONES AUXILIARES ----------
+
+static const Layout& current_layout(AppData* app) {
+    return app->config.layouts[app->layout_index];
+}
+
+// Fuente de cada celda del layout actual (para el compositor)
+static std::vector<SourceDesc> layout_sources(AppData* app) {
+    std::vector<SourceDesc> sources;
+    for (const LayoutTile &tile : current_layout(app).tiles)
+        sources.push_back(*app->config.find_source(tile.source));
+    return sources;
+}
+
+// Modo del slot: el global, salvo que el canal de control le haya fijado otro
+static StreamMode slot_mode(AppData* app, const StreamSlot &slot) {
+    auto it = app->slot_modes.find(slot.get_index());
+    return it != app->slot_modes.end() ? it->second : app->mode;
+}
+
+// Arranca el pipeline del slot en el modo actual
+static void start_slot(AppData* app, StreamSlot &slot, const SourceDesc &source) {
+    StreamMode mode = slot_mode(app, slot);
+    slot.set_variants(source.variants);
+    // Las fuentes grabadas no dependen del modo de red
+    if (!source.file.empty()) {
+        slot.init_with_file(source.file, PipelineDesc::file_realtime());
+        return;
+    }
+    if (app->standby) {
+        slot.init_standby(source.streamid, source.port, mode, app->standby_budget_bytes);
+        return;
+    }
+
+    switch (mode) {
+        case StreamMode::SRT_MOSAIC:
+            slot.init_with_streamid(source.streamid);
+            break;
+        case StreamMode::UDP_SAFE:
+            slot.init_with_udp_port_safe(source.port);
+            break;
+        case StreamMode::UDP_FAST:
+            slot.init_with_udp_port_fast(source.port);
+            break;
+    }
+}
+
+static std::shared_ptr<StreamSlot> create_slot(AppData* app, const std::string &source, bool start) {
+    auto free_id = std::find(app->used_ids.begin(), app->used_ids.end(), false);
+    if (free_id == app->used_ids.end()) {
+        g_printerr("[ERROR] No hay más de %d slots disponibles\n", kMaxSlots);
+        return nullptr;
+    }
+    int id = (int)(free_id - app->used_ids.begin());
+    *free_id = true;
+
+    auto slot = std::make_shared<StreamSlot>();
+    slot->init(id);
+    slot->set_live_callback([app, id]() { on_slot_live(app, id); });
+    if (app->renderer_mode) slot->set_renderer(app->renderer.get());
+    if (start && !app->compositor_mode) start_slot(app, *slot, *app->config.find_source(source));
+    return slot;
+}
+
+// El destructor del slot apaga su pipeline y quita su widget del grid
+static void release_slot(AppData* app, std::shared_ptr<StreamSlot> &slot) {
+    app->used_ids[slot->get_index()] = false;
+    app->slot_modes.erase(slot->get_index());
+    slot.reset();
+}
+
+static void drop_parked(AppData* app) {
+    for (auto &slot : app->parked) release_slot(app, slot);
+    app->parked.clear();
+    app->parked_sources.clear();
+}
+
+// Pasa al layout actual tocando solo lo que cambia: los slots cuya fuente
+// sigue en pantalla se reubican sin reiniciar, se crean los que faltan y
+// los que salen quedan estacionados (hasta parked_slots, los más viejos se destruyen).
+// Los ids se devuelven antes de pedir nuevos; si aun así no alcanzan, no se
+// toca nada y devuelve false.
+static bool sync_slots(AppData* app, bool start_new) {
+    const Layout &layout = current_layout(app);
+
+    // Candidatos: primero los estacionados (más viejos), después los del layout anterior
+    std::vector<std::shared_ptr<StreamSlot>> pool = app->parked;
+    std::vector<std::string> pool_sources = app->parked_sources;
+    for (size_t i = 0; i < app->slots.size(); ++i) {
+        pool.push_back(app->slots[i]);
+        pool_sources.push_back(app->slot_tiles[i].source);
+    }
+
+    // Celdas que reutilizan un slot; las demás (nullptr) necesitan uno nuevo
+    std::vector<std::shared_ptr<StreamSlot>> next;
+    int reused = 0, created = 0;
+    for (const LayoutTile &tile : layout.tiles) {
+        std::shared_ptr<StreamSlot> slot;
+        auto it = std::find(pool_sources.rbegin(), pool_sources.rend(), tile.source);
+        if (it != pool_sources.rend()) {
+            size_t i = pool_sources.size() - 1 - (it - pool_sources.rbegin());
+            slot = pool[i];
+            pool.erase(pool.begin() + i);
+            pool_sources.erase(pool_sources.begin() + i);
+            reused++;
+        }
+        next.push_back(slot);
+    }
+
+    int needed = (int)layout.tiles.size() - reused;
+    int free_ids = (int)std::count(app->used_ids.begin(), app->used_ids.end(), false);
+    if (needed > free_ids + (int)pool.size()) {
+        g_printerr("[ERROR] Layout %s: faltan slots (%d nuevos, %d libres, máximo %d); se mantiene el anterior\n",
+                   layout.name.c_str(), needed, free_ids + (int)pool.size(), kMaxSlots);
+        return false;
+    }
+
+    // Los que salen quedan estacionados hasta parked_slots, y menos si hacen
+    // falta sus ids
+    int keep = std::max(0, std::min(app->config.parked_slots, free_ids + (int)pool.size() - needed));
+    int destroyed = 0;
+    while ((int)pool.size() > keep) {
+        release_slot(app, pool.front());
+        pool.erase(pool.begin());
+        pool_sources.erase(pool_sources.begin());
+        destroyed++;
+    }
+
+    for (size_t i = 0; i < next.size(); ++i) {
+        if (next[i]) continue;
+        next[i] = create_slot(app, layout.tiles[i].source, start_new);
+        created++;
+    }
+
+    app->slots = std::move(next);
+    app->slot_tiles = layout.tiles;
+    app->parked = std::move(pool);
+    app->parked_sources = std::move(pool_sources);
+
+    g_print("[INFO] Layout %s: %zu celdas (%d reutilizadas, %d nuevas), %zu estacionados, %d destruidos\n",
+            layout.name.c_str(), app->slots.size(), reused, created, app->parked.size(), destroyed);
+    return true;
+}
+
+// Ubica cada slot en su celda y oculta los estacionados
+void update_layout(AppData* app) {
+    DecoderScheduler::instance().set_active_slots((int)app->slots.size());
+
+    if (app->compositor_mode) {
+        app->compositor->set_layout(app->mode, current_layout(app), layout_sources(app));
+        return;
+    }
+
+    Layout shown = current_layout(app);
+    shown.tiles = app->slot_tiles;
+    std::vector<int> ids;
+    for (auto &slot : app->slots) ids.push_back(slot->get_index());
+    app->renderer->set_layout(shown, ids);
+
+    for (size_t i = 0; i < app->slots.size(); ++i) {
+        GtkWidget* w = app->slots[i]->get_widget();
+        if (!GTK_IS_WIDGET(w)) {
+            g_print("[ERROR] Slot %zu get_widget() NO es válido\n", i + 1);
+            continue;
+        }
+
+        const LayoutTile &t = app->slot_tiles[i];
+        if (gtk_widget_get_parent(w) == app->grid) {
+            gtk_container_child_set(GTK_CONTAINER(app->grid), w,
+                                    "left-attach", t.col, "top-attach", t.row,
+                                    "width", t.width, "height", t.height, NULL);
+        } else {
+            gtk_grid_attach(GTK_GRID(app->grid), w, t.col, t.row, t.width, t.height);
+        }
+        gtk_widget_show(w);
+        app->slots[i]->set_visible(true);
+    }
+
+    // Los slots estacionados pasan a decodificar solo keyframes
+    for (auto &slot : app->parked) {
+        gtk_widget_hide(slot->get_widget());
+        slot->set_visible(false);
+    }
+}
+
+static bool select_layout(AppData* app, int index) {
+    if (index < 0 || index >= (int)app->config.layouts.size()) return false;
+    int previous = app->layout_index;
+    app->layout_index = index;
+    if (!sync_slots(app, true)) {
+        app->layout_index = previous;
+        return false;
+    }
+    update_layout(app);
+    return true;
+}
+
+static void show_active_page(AppData* app) {
+    const char *page = app->compositor_mode ? "mosaic" : app->renderer_mode ? "renderer" : "grid";
+    gtk_stack_set_visible_child_name(GTK_STACK(app->stack), page);
+}
+
+// Log periódico del CPU del proceso y de lo que se ahorran los slots ocultos
+static gboolean log_cpu_usage(gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+
+    gint64 cpu = ProcStats::cpu_time_us();
+    gint64 wall = g_get_monotonic_time();
+
+    int hidden = (int)app->parked.size();
+    guint64 dropped = 0;
+    for (auto &slot : app->slots) dropped += slot->take_hidden_drops();
+    for (auto &slot : app->parked) dropped += slot->take_hidden_drops();
+
+    if (app->last_wall_us > 0 && wall > app->last_wall_us) {
+        double cpu_pct = 100.0 * (cpu - app->last_cpu_us) / (double)(wall - app->last_wall_us);
+        g_print("[INFO] CPU proceso: %.1f%% de %d núcleos | slots ocultos: %d, frames sin decodificar: %" G_GUINT64_FORMAT "\n",
+                cpu_pct, ProcStats::cpu_count(), hidden, dropped);
+        if (app->renderer_mode && !app->compositor_mode)
+            g_print("[INFO] Renderer: %.1f redibujados/s del mosaico\n",
+                    (app->renderer->repaints() - app->last_repaints) * 1e6 / (double)(wall - app->last_wall_us));
+    }
+
+    app->last_repaints = app->renderer->repaints();
+    app->last_cpu_us = cpu;
+    app->last_wall_us = wall;
+    return G_SOURCE_CONTINUE;
+}
+
+// Salida codificada con el renderer: copia del lienzo al ritmo de la salida.
+// Con el compositor los frames salen del propio pipeline; con un gtksink por
+// slot no hay mosaico compuesto que enviar.
+static gboolean feed_output(gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+    if (app->renderer_mode && !app->compositor_mode && app->output->is_running()) {
+        GstSample *sample = app->renderer->snapshot();
+        if (sample) app->output->push(sample);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static void apply_black_background(GtkWidget *widget) {
+    GtkCssProvider *provider = gtk_css_provider_new();
+    gtk_css_provider_load_from_data(provider,
+        R"css(
+            * {
+                background-color: black;
+                color: white;
+            }
+            window, grid, frame {
+                background-color: black;
+                border: none;
+            }
+        )css",
+        -1, nullptr);
+
+    GdkScreen *screen = gtk_window_get_screen(GTK_WINDOW(widget));
+    gtk_style_context_add_provider_for_screen(screen, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    g_object_unref(provider);
+}
+
+// Un slot recibió su primer frame tras el último rebuild
+static void on_slot_live(AppData* app, int index) {
+    if (index >= (int)app->switch_pending.size() || !app->switch_pending[index]) return;
+    app->switch_pending[index] = false;
+
+    double elapsed_ms = (g_get_monotonic_time() - app->switch_start_us) / 1000.0;
+    g_print("[INFO] Slot %d en vivo a los %.1f ms\n", index, elapsed_ms);
+
+    if (--app->switch_remaining == 0) {
+        g_print("[INFO] Cambio de modo -> todos los tiles en vivo: %.1f ms\n", elapsed_ms);
+    }
+}
+
+static void start_switch_timer(AppData* app) {
+    app->switch_start_us = g_get_monotonic_time();
+    app->switch_pending.assign(kMaxSlots, false);
+    for (auto &slot : app->slots) app->switch_pending[slot->get_index()] = true;
+    app->switch_remaining = (int)app->slots.size();
+}
+
+// Reconstruye los pipelines dependiendo del modo.
+// No bloquea: cada slot apaga/arranca su pipeline en segundo plano.
+void rebuild_pipelines(AppData* app) {
+    g_print("[INFO] Reconstruyendo pipelines en modo: %s%s\n",
+            PipelineDesc::mode_name(app->mode),
+            app->compositor_mode ? " (compositor)" : "");
+
+    if (app->compositor_mode) {
+        // Un único pipeline: los slots individuales quedan detenidos
+        drop_parked(app);
+        sync_slots(app, false);
+        for (auto &slot : app->slots) slot->stop();
+        app->compositor->build(app->mode, current_layout(app), layout_sources(app));
+        update_layout(app);
+        return;
+    }
+
+    // Liberar puertos/conexiones que tuviera el compositor
+    app->compositor->stop();
+
+    // Los estacionados quedaron en el modo anterior
+    drop_parked(app);
+    sync_slots(app, false);
+    start_switch_timer(app);
+
+    for (size_t i = 0; i < app->slots.size(); i++) {
+        start_slot(app, *app->slots[i], *app->config.find_source(app->slot_tiles[i].source));
+        gtk_widget_show(app->slots[i]->get_widget());
+    }
+
+    update_layout(app);
+}
+
+// Cambia de modo: con standby solo se cambia la rama activa de cada slot
+static void switch_mode(AppData* app, StreamMode mode) {
+    app->mode = mode;
+    // El cambio global pisa los modos fijados por slot
+    app->slot_modes.clear();
+    drop_parked(app);
+
+    if (app->standby && !app->compositor_mode) {
+        start_switch_timer(app);
+        bool all_switched = true;
+        for (auto &slot : app->slots)
+            all_switched = slot->select_mode(mode) && all_switched;
+
+        if (all_switched) {
+            g_print("[INFO] Modo %s (standby, sin reconstruir)\n", PipelineDesc::mode_name(mode));
+            update_layout(app);
+            return;
+        }
+    }
+
+    rebuild_pipelines(app);
+}
+
+
+// Slot del tile bajo el puntero (grid de gtksinks o renderer), nullptr si ninguno
+static StreamSlot* slot_under_pointer(AppData* app) {
+    GdkWindow *window = gtk_widget_get_window(app->window);
+    if (!window || app->compositor_mode) return nullptr;
+    GdkDevice *pointer = gdk_seat_get_pointer(gdk_display_get_default_seat(gtk_widget_get_display(app->window)));
+    int x = 0, y = 0;
+    gdk_window_get_device_position(window, pointer, &x, &y, NULL);
+
+    if (app->renderer_mode) {
+        int rx, ry;
+        if (!gtk_widget_translate_coordinates(app->window, app->renderer->get_widget(), x, y, &rx, &ry))
+            return nullptr;
+        int id = app->renderer->slot_at(rx, ry);
+        for (auto &slot : app->slots)
+            if (slot->get_index() == id) return slot.get();
+        return nullptr;
+    }
+
+    for (auto &slot : app->slots) {
+        GtkWidget *w = slot->get_widget();
+        int wx, wy;
+        if (!gtk_widget_get_mapped(w) || !gtk_widget_translate_coordinates(app->window, w, x, y, &wx, &wy))
+            continue;
+        if (wx >= 0 && wy >= 0 && wx < gtk_widget_get_allocated_width(w) && wy < gtk_widget_get_allocated_height(w))
+            return slot.get();
+    }
+    return nullptr;
+}
+
+// ---------- EVENTOS ----------
+
+static gboolean on_key_press(GtkWidget *widget, GdkEventKey *event, gpointer user_data) {
+    AppData *app = static_cast<AppData *>(user_data);
+    guint keyval = event->keyval;
+
+    // Bloquear layout con 'L'
+    if (keyval == GDK_KEY_l || keyval == GDK_KEY_L) {
+        app->layout_locked = !app->layout_locked;
+        g_print("[INFO] Layout bloqueado: %s\n", app->layout_locked ? "sí" : "no");
+        return TRUE;
+    }
+
+    // --- Modo UDP seguro (latencia normal) ---
+    if (keyval == GDK_KEY_v || keyval == GDK_KEY_V) {
+        app->layout_index = app->config.largest_layout();
+        switch_mode(app, StreamMode::UDP_SAFE);
+        select_layout(app, app->layout_index);
+        return TRUE;
+    }
+
+    // --- Modo UDP rápido (ultra low latency) ---
+    if (keyval == GDK_KEY_u || keyval == GDK_KEY_U) {
+        app->layout_index = app->config.largest_layout();
+        switch_mode(app, StreamMode::UDP_FAST);
+        select_layout(app, app->layout_index);
+        return TRUE;
+    }
+
+    if (keyval == GDK_KEY_m || keyval == GDK_KEY_M) {
+        switch_mode(app, StreamMode::SRT_MOSAIC);
+        update_layout(app);
+        return TRUE;
+    }
+
+    // --- Standby: precargar SRT/UDP_SAFE/UDP_FAST en cada slot ---
+    if (keyval == GDK_KEY_w || keyval == GDK_KEY_W) {
+        app->standby = !app->standby;
+        g_print("[INFO] Standby: %s\n", app->standby ? "sí" : "no");
+        rebuild_pipelines(app);
+        return TRUE;
+    }
+
+    // --- Ingesta UDP propia (lotes por syscall, buffer de kernel grande) ---
+    if (keyval == GDK_KEY_i || keyval == GDK_KEY_I) {
+        PipelineDesc::set_udp_ingest(!PipelineDesc::udp_ingest());
+        g_print("[INFO] Ingesta UDP: %s\n", PipelineDesc::udp_ingest() ? "sí" : "no");
+        rebuild_pipelines(app);
+        return TRUE;
+    }
+
+    // --- Demux RTP: todas las fuentes UDP en un solo puerto, por SSRC ---
+    if (keyval == GDK_KEY_d || keyval == GDK_KEY_D) {
+        PipelineDesc::set_rtp_demux(!PipelineDesc::rtp_demux());
+        g_print("[INFO] Demux RTP en el puerto %d: %s\n", PipelineDesc::rtp_demux_port(),
+                PipelineDesc::rtp_demux() ? "sí" : "no");
+        rebuild_pipelines(app);
+        // Los slots ya soltaron sus appsrc: se libera el puerto compartido
+        if (!PipelineDesc::rtp_demux()) RtpDemux::instance().shutdown();
+        return TRUE;
+    }
+
+    // --- Mosaico en un único pipeline (compositor) ---
+    if (keyval == GDK_KEY_c || keyval == GDK_KEY_C) {
+        app->compositor_mode = !app->compositor_mode;
+        g_print("[INFO] Modo compositor: %s\n", app->compositor_mode ? "sí" : "no");
+        show_active_page(app);
+        rebuild_pipelines(app);
+        return TRUE;
+    }
+
+    // --- Renderer propio (conversión+escala SIMD, un redibujado por frame) ---
+    if (keyval == GDK_KEY_r || keyval == GDK_KEY_R) {
+        app->renderer_mode = !app->renderer_mode;
+        g_print("[INFO] Renderer de mosaico: %s\n", app->renderer_mode ? "sí" : "no");
+        for (auto &slot : app->slots)
+            slot->set_renderer(app->renderer_mode ? app->renderer.get() : nullptr);
+        for (auto &slot : app->parked)
+            slot->set_renderer(app->renderer_mode ? app->renderer.get() : nullptr);
+        show_active_page(app);
+        rebuild_pipelines(app);
+        return TRUE;
+    }
+
+    // --- Repetición del tile bajo el puntero: 'p' 10 s, Shift+P 30 s, otra vez para volver al vivo ---
+    if (keyval == GDK_KEY_p || keyval == GDK_KEY_P) {
+        StreamSlot *slot = slot_under_pointer(app);
+        if (!slot) {
+            g_print("[INFO] Repetición: no hay un tile bajo el puntero\n");
+        } else if (slot->is_replaying()) {
+            slot->stop_replay();
+        } else {
+            slot->start_replay(keyval == GDK_KEY_P ? 30 : 10);
+        }
+        return TRUE;
+    }
+
+    // --- HUD de métricas por slot ---
+    if (keyval == GDK_KEY_h || keyval == GDK_KEY_H) {
+        app->metrics->set_hud_visible(!app->metrics->hud_visible());
+        return TRUE;
+    }
+
+    if (keyval == GDK_KEY_F11) {
+        if (app->is_fullscreen) {
+            gtk_window_unfullscreen(GTK_WINDOW(app->window));
+            app->is_fullscreen = false;
+            g_print("[INFO] Saliendo de pantalla completa\n");
+        } else {
+            gtk_window_fullscreen(GTK_WINDOW(app->window));
+            app->is_fullscreen = true;
+            g_print("[INFO] Modo pantalla completa activado\n");
+        }
+        return TRUE;
+    }
+
+    if (app->layout_locked)
+        return TRUE;
+
+    // Layouts 1–9 del archivo de configuración (por defecto: 1 a 6 slots)
+    if (keyval >= GDK_KEY_1 && keyval <= GDK_KEY_9) {
+        int index = keyval - GDK_KEY_1;
+        if (index < (int)app->config.layouts.size()) {
+            g_print("[INFO] Cambiando al layout %s\n", app->config.layouts[index].name.c_str());
+            select_layout(app, index);
+        }
+        return TRUE;
+    }
+
+    // Re Pág / Av Pág: recorrer todos los layouts
+    if (keyval == GDK_KEY_Page_Down || keyval == GDK_KEY_Page_Up) {
+        int count = (int)app->config.layouts.size();
+        int step = (keyval == GDK_KEY_Page_Down) ? 1 : count - 1;
+        select_layout(app, (app->layout_index + step) % count);
+        g_print("[INFO] Layout %s\n", current_layout(app).name.c_str());
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+// ---------- CANAL DE CONTROL ----------
+// Cada comando toca solo las celdas que nombra: los demás slots siguen en vivo.
+
+static bool parse_cell(AppData* app, const std::string &arg, int *cell) {
+    char *end = nullptr;
+    long value = strtol(arg.c_str(), &end, 10);
+    if (arg.empty() || *end || value < 0 || value >= (long)app->slots.size()) return false;
+    *cell = (int)value;
+    return true;
+}
+
+static bool parse_mode(const std::string &arg, StreamMode *mode) {
+    if (arg == "srt") *mode = StreamMode::SRT_MOSAIC;
+    else if (arg == "safe") *mode = StreamMode::UDP_SAFE;
+    else if (arg == "fast") *mode = StreamMode::UDP_FAST;
+    else return false;
+    return true;
+}
+
+static std::string control_status(AppData* app) {
+    // Nombres de fuente y layout vienen del usuario: escapados y sin buffer fijo
+    GString *json = g_string_new(NULL);
+    g_string_append_printf(json,
+             "{\"mode\": \"%s\", \"layout\": \"%s\", \"compositor\": %s, \"renderer\": %s, \"standby\": %s, \"cells\": [",
+             PipelineDesc::mode_name(app->mode), MetricsReporter::json_escape(current_layout(app).name).c_str(),
+             app->compositor_mode ? "true" : "false", app->renderer_mode ? "true" : "false",
+             app->standby ? "true" : "false");
+
+    for (size_t i = 0; i < app->slots.size(); ++i) {
+        StreamSlot &slot = *app->slots[i];
+        const LayoutTile &t = app->slot_tiles[i];
+        g_string_append_printf(json,
+                 "%s{\"cell\": %zu, \"slot\": %d, \"source\": \"%s\", \"mode\": \"%s\", "
+                 "\"col\": %d, \"row\": %d, \"width\": %d, \"height\": %d, \"variant\": %d, \"replaying\": %s}",
+                 i ? ", " : "", i, slot.get_index(), MetricsReporter::json_escape(t.source).c_str(), slot.mode_label(),
+                 t.col, t.row, t.width, t.height, slot.variant_height(), slot.is_replaying() ? "true" : "false");
+    }
+    g_string_append(json, "], \"parked\": [");
+    for (size_t i = 0; i < app->parked.size(); ++i) {
+        g_string_append_printf(json, "%s{\"slot\": %d, \"source\": \"%s\"}",
+                 i ? ", " : "", app->parked[i]->get_index(),
+                 MetricsReporter::json_escape(app->parked_sources[i]).c_str());
+    }
+    g_string_append(json, "]}");
+
+    std::string text(json->str, json->len);
+    g_string_free(json, TRUE);
+    return text;
+}
+
+// source <celda> <fuente> [streamid] [puerto]: con streamid/puerto define o
+// actualiza la fuente; los slots que ya la mostraban se reinician
+static std::string control_source(AppData* app, int cell, const std::vector<std::string> &args) {
+    const std::string &name = args[2];
+    if (args.size() > 3) {
+        SourceDesc desc{name, args[3], args.size() > 4 ? args[4] : "", ""};
+        take_file_source(desc);
+        SourceDesc *existing = nullptr;
+        for (SourceDesc &s : app->config.sources)
+            if (s.name == name) existing = &s;
+
+        if (!existing) {
+            app->config.sources.push_back(desc);
+        } else if (existing->streamid != desc.streamid || existing->port != desc.port || existing->file != desc.file) {
+            existing->streamid = desc.streamid;
+            existing->port = desc.port;
+            existing->file = desc.file;
+            // Los estacionados con la fuente vieja ya no sirven
+            for (size_t i = app->parked.size(); i-- > 0;) {
+                if (app->parked_sources[i] != name) continue;
+                release_slot(app, app->parked[i]);
+                app->parked.erase(app->parked.begin() + i);
+                app->parked_sources.erase(app->parked_sources.begin() + i);
+            }
+            if (!app->compositor_mode) {
+                for (size_t i = 0; i < app->slots.size(); ++i)
+                    if (app->slot_tiles[i].source == name) start_slot(app, *app->slots[i], *existing);
+            }
+        }
+        RtpDemux::instance().set_rules(app->config.sources);
+    } else if (!app->config.find_source(name)) {
+        return "error fuente desconocida: " + name;
+    }
+
+    Layout &layout = app->config.layouts[app->layout_index];
+    if (cell >= (int)layout.tiles.size()) return "error celda fuera del layout";
+    if (layout.tiles[cell].source != name) {
+        std::string previous = layout.tiles[cell].source;
+        layout.tiles[cell].source = name;
+        if (app->compositor_mode) {
+            rebuild_pipelines(app);
+        } else {
+            // La celda toma un slot estacionado con esa fuente o uno nuevo; el
+            // anterior queda estacionado
+            if (!sync_slots(app, true)) {
+                layout.tiles[cell].source = previous;
+                return "error no hay slots libres";
+            }
+            update_layout(app);
+        }
+    } else if (app->compositor_mode && args.size() > 3) {
+        rebuild_pipelines(app);
+    }
+    return "ok";
+}
+
+// tile <celda> col,fila[,ancho,alto]: mueve o redimensiona la celda sin tocar su pipeline
+static std::string control_tile(AppData* app, int cell, const std::string &spec) {
+    int c, r, w = 1, h = 1;
+    int n = sscanf(spec.c_str(), " %d , %d , %d , %d", &c, &r, &w, &h);
+    if ((n != 2 && n != 4) || c < 0 || r < 0 || w < 1 || h < 1) return "error celda inválida: " + spec;
+
+    Layout &layout = app->config.layouts[app->layout_index];
+    if (cell >= (int)layout.tiles.size()) return "error celda fuera del layout";
+    for (LayoutTile *t : {&layout.tiles[cell], &app->slot_tiles[cell]}) {
+        t->col = c;
+        t->row = r;
+        t->width = w;
+        t->height = h;
+    }
+    layout.cols = std::max(layout.cols, c + w);
+    layout.rows = std::max(layout.rows, r + h);
+    update_layout(app);
+    return "ok";
+}
+
+// swap <celda> <celda>: los slots cambian de lugar, la geometría queda en la celda
+static std::string control_swap(AppData* app, int a, int b) {
+    Layout &layout = app->config.layouts[app->layout_index];
+    if (a >= (int)layout.tiles.size() || b >= (int)layout.tiles.size()) return "error celda fuera del layout";
+    std::swap(app->slots[a], app->slots[b]);
+    std::swap(app->slot_tiles[a].source, app->slot_tiles[b].source);
+    std::swap(layout.tiles[a].source, layout.tiles[b].source);
+    if (app->compositor_mode) rebuild_pipelines(app);
+    else update_layout(app);
+    return "ok";
+}
+
+static std::string control_command(AppData* app, const std::vector<std::string> &args) {
+    const std::string &cmd = args[0];
+    g_print("[Control] %s\n", cmd.c_str());
+
+    if (cmd == "status") return "ok " + control_status(app);
+
+    if (cmd == "layout" && args.size() == 2) {
+        int index = app->config.find_layout(args[1]);
+        if (index < 0) return "error layout desconocido: " + args[1];
+        if (!select_layout(app, index)) return "error no hay slots para el layout " + args[1];
+        return "ok";
+    }
+
+    int cell = 0;
+    if (args.size() < 2 || !parse_cell(app, args[1], &cell)) {
+        if (cmd == "source" || cmd == "mode" || cmd == "tile" || cmd == "swap" ||
+            cmd == "restart" || cmd == "replay")
+            return "error celda inválida";
+        return "error comando desconocido: " + cmd;
+    }
+    StreamSlot &slot = *app->slots[cell];
+    const SourceDesc *source = app->config.find_source(app->slot_tiles[cell].source);
+
+    if (cmd == "source" && args.size() >= 3 && args.size() <= 5)
+        return control_source(app, cell, args);
+
+    if (cmd == "tile" && args.size() == 3)
+        return control_tile(app, cell, args[2]);
+
+    if (cmd == "swap" && args.size() == 3) {
+        int other = 0;
+        if (!parse_cell(app, args[2], &other)) return "error celda inválida";
+        return control_swap(app, cell, other);
+    }
+
+    if (cmd == "mode" && args.size() == 3) {
+        StreamMode mode;
+        if (!parse_mode(args[2], &mode)) return "error modo inválido (srt, safe, fast): " + args[2];
+        if (app->compositor_mode) return "error en modo compositor el modo es de todo el mosaico";
+        if (mode == app->mode) app->slot_modes.erase(slot.get_index());
+        else app->slot_modes[slot.get_index()] = mode;
+        // Standby: solo cambia la rama activa
+        if (!slot.select_mode(mode) && source) start_slot(app, slot, *source);
+        return "ok";
+    }
+
+    if (cmd == "restart" && args.size() == 2) {
+        if (app->compositor_mode) return "error en modo compositor no hay slots individuales";
+        if (source) start_slot(app, slot, *source);
+        return "ok";
+    }
+
+    if (cmd == "replay" && args.size() <= 3) {
+        if (app->compositor_mode) return "error en modo compositor no hay slots individuales";
+        if (args.size() == 3 && args[2] == "stop") {
+            slot.stop_replay();
+            return "ok";
+        }
+        int seconds = args.size() == 3 ? atoi(args[2].c_str()) : 10;
+        if (seconds <= 0) return "error segundos inválidos: " + args[2];
+        return slot.start_replay(seconds) ? "ok" : "error no hay video para repetir";
+    }
+
+    return "error uso: " + cmd + " con argumentos inválidos";
+}
+
+// ---------- SETUP PRINCIPAL ----------
+
+static void on_activate(GtkApplication *gtk_app, gpointer user_data) {
+    AppData *app = new AppData();
+
+    // El hilo de GTK conserva su propio núcleo (si MOSAIC_PIN_THREADS=1)
+    DecoderScheduler::instance().pin_ui_thread();
+
+    app->window = gtk_application_window_new(gtk_app);
+    gtk_window_set_title(GTK_WINDOW(app->window), "Mosaico de Streams");
+    gtk_window_set_default_size(GTK_WINDOW(app->window), 800, 600);
+    apply_black_background(app->window);
+
+    // Overlay: el HUD de métricas queda encima de cualquier página del stack
+    GtkWidget *overlay = gtk_overlay_new();
+    gtk_container_add(GTK_CONTAINER(app->window), overlay);
+
+    app->stack = gtk_stack_new();
+    gtk_container_add(GTK_CONTAINER(overlay), app->stack);
+
+    app->grid = gtk_grid_new();
+    gtk_widget_set_hexpand(app->grid, TRUE);
+    gtk_widget_set_vexpand(app->grid, TRUE);
+    // Celdas del mismo tamaño: una celda que abarca 2x2 ocupa cuatro
+    gtk_grid_set_row_homogeneous(GTK_GRID(app->grid), TRUE);
+    gtk_grid_set_column_homogeneous(GTK_GRID(app->grid), TRUE);
+    gtk_stack_add_named(GTK_STACK(app->stack), app->grid, "grid");
+
+    // Fuentes y layouts (MOSAIC_LAYOUT_FILE o mosaic_layouts.ini, si existen)
+    app->config = LayoutConfig::load_default();
+    app->layout_index = app->config.default_layout;
+    app->used_ids.assign(kMaxSlots, false);
+    RtpDemux::instance().set_rules(app->config.sources);
+
+    // Mosaico compuesto: mismas celdas que el grid
+    app->compositor = std::make_unique<MosaicCompositor>();
+    gtk_stack_add_named(GTK_STACK(app->stack), app->compositor->get_widget(), "mosaic");
+
+    // Renderer propio: un solo widget para todos los slots, redibujado al ritmo
+    // del frame clock. MOSAIC_RENDERER=0 vuelve a un gtksink por slot.
+    app->renderer = std::make_unique<MosaicRenderer>();
+    const char *renderer_env = g_getenv("MOSAIC_RENDERER");
+    if (renderer_env) app->renderer_mode = atoi(renderer_env) != 0;
+    gtk_stack_add_named(GTK_STACK(app->stack), app->renderer->get_widget(), "renderer");
+    // Con el renderer, el tamaño de cada tile (para elegir variante) lo da su celda
+    app->renderer->set_cell_size_callback([app](int id, int width, int height) {
+        if (!app->renderer_mode || app->compositor_mode) return;
+        for (auto &slot : app->slots)
+            if (slot->get_index() == id) slot->set_tile_size(width, height);
+    });
+
+    // Salida codificada del mosaico (MOSAIC_OUTPUT): un encode para todos los consumidores
+    app->output = std::make_unique<MosaicOutput>();
+    if (app->output->start()) {
+        app->compositor->set_output(app->output.get());
+        g_timeout_add(app->output->interval_ms(), feed_output, app);
+    }
+
+    // Métricas: HUD (tecla H) y archivo JSON para el monitoreo
+    app->metrics = std::make_unique<MetricsReporter>([app]() {
+        std::vector<MetricsReporter::SlotSample> samples;
+        for (size_t i = 0; i < app->slots.size(); ++i) {
+            StreamSlot &slot = *app->slots[i];
+            samples.push_back({slot.get_index(), app->slot_tiles[i].source,
+                               slot.mode_label(), true, slot.sample_metrics()});
+        }
+        for (size_t i = 0; i < app->parked.size(); ++i) {
+            StreamSlot &slot = *app->parked[i];
+            samples.push_back({slot.get_index(), app->parked_sources[i],
+                               slot.mode_label(), false, slot.sample_metrics()});
+        }
+        return samples;
+    });
+    gtk_overlay_add_overlay(GTK_OVERLAY(overlay), app->metrics->get_hud_widget());
+    app->metrics->start();
+
+    // Canal de control local: cambios por celda sin reconstruir el resto
+    app->control = std::make_unique<ControlServer>([app](const std::vector<std::string> &args) {
+        return control_command(app, args);
+    });
+    app->control->start();
+
+    // Crear los slots del layout inicial, en modo mosaico SRT por defecto
+    rebuild_pipelines(app);
+
+    g_timeout_add_seconds(10, log_cpu_usage, app);
+
+    g_signal_connect(app->window, "key-press-event", G_CALLBACK(on_key_press), app);
+    gtk_widget_show_all(app->window);
+    show_active_page(app);
+
+    // show_all muestra todos los slots: volver a ocultar los estacionados
+    update_layout(app);
+}
+
+// ---------- MAIN ----------
+
+int main(int argc, char **argv) {
+    // Soak: el tracer "leaks" lleva la cuenta de elementos y pads vivos
+    if (argc > 2 && g_strcmp0(argv[1], "--bench") == 0 && g_strcmp0(argv[2], "soak") == 0)
+        g_setenv("GST_TRACERS", "leaks(filter=\"GstElement,GstPad\",stack-traces-flags=none)", FALSE);
+
+    gst_init(&argc, &argv);
+
+    // Benchmarks sin interfaz: multistream_mosaic --bench <nombre>
+    if (argc > 1 && g_strcmp0(argv[1], "--bench") == 0)
+        return Bench::run(argc - 2, argv + 2);
+
+    GtkApplication *app = gtk_application_new("com.mosaic.streamviewer", G_APPLICATION_DEFAULT_FLAGS);
+    g_signal_connect(app, "activate", G_CALLBACK(on_activate), NULL);
+
+    int status = g_application_run(G_APPLICATION(app), argc, argv);
+    g_object_unref(app);
+    return status;
+}